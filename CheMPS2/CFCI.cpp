@@ -34,8 +34,9 @@ using std::endl;
 #include "Lapack.h"
 #include "Davidson.h"
 #include "ConjugateGradient.h"
+#include "MPIchemps2.h"
 
-CheMPS2::CFCI::CFCI(Hamiltonian * Ham, const unsigned int theNel_up, const unsigned int theNel_down, const int TargetIrrep_in, const double maxMemWorkMB_in, const int FCIverbose_in, const hid_t HDF5FILEIDIN ){
+CheMPS2::CFCI::CFCI(Hamiltonian * Ham, const unsigned int theNel_up, const unsigned int theNel_down, const int TargetIrrep_in, const double maxMemWorkMB_in, const int FCIverbose_in, const hid_t HDF5FILEIDIN, const bool lookupOnTheFly_in ){
 
    std::cout << std::fixed << std::setprecision( 15 );
 
@@ -59,6 +60,7 @@ CheMPS2::CFCI::CFCI(Hamiltonian * Ham, const unsigned int theNel_up, const unsig
    FCIverbose   = FCIverbose_in;
    maxMemWorkMB = maxMemWorkMB_in;
    HDF5FILEID = HDF5FILEIDIN;
+   lookupOnTheFly = lookupOnTheFly_in;
    L = Ham->getL();
    assert( theNel_up    <= L );
    assert( theNel_down  <= L );
@@ -162,22 +164,24 @@ CheMPS2::CFCI::~CFCI(){
    delete [] numPerIrrep_down;
 
    // FCI::StartupLookupTables
-   for ( unsigned int irrep = 0; irrep < num_irreps; irrep++ ){
-      for ( unsigned int ij = 0; ij < L * L; ij++ ){
-         delete [] lookup_cnt_alpha[irrep][ij];
-         delete [] lookup_cnt_beta[irrep][ij];
-         delete [] lookup_sign_alpha[irrep][ij];
-         delete [] lookup_sign_beta[irrep][ij];
+   if ( !lookupOnTheFly ){
+      for ( unsigned int irrep = 0; irrep < num_irreps; irrep++ ){
+         for ( unsigned int ij = 0; ij < L * L; ij++ ){
+            delete [] lookup_cnt_alpha[irrep][ij];
+            delete [] lookup_cnt_beta[irrep][ij];
+            delete [] lookup_sign_alpha[irrep][ij];
+            delete [] lookup_sign_beta[irrep][ij];
+         }
+         delete [] lookup_cnt_alpha[irrep];
+         delete [] lookup_cnt_beta[irrep];
+         delete [] lookup_sign_alpha[irrep];
+         delete [] lookup_sign_beta[irrep];
       }
-      delete [] lookup_cnt_alpha[irrep];
-      delete [] lookup_cnt_beta[irrep];
-      delete [] lookup_sign_alpha[irrep];
-      delete [] lookup_sign_beta[irrep];
+      delete [] lookup_cnt_alpha;
+      delete [] lookup_cnt_beta;
+      delete [] lookup_sign_alpha;
+      delete [] lookup_sign_beta;
    }
-   delete [] lookup_cnt_alpha;
-   delete [] lookup_cnt_beta;
-   delete [] lookup_sign_alpha;
-   delete [] lookup_sign_beta;
 
    // FCI::StartupIrrepCenter
    for ( unsigned int irrep=0; irrep<num_irreps; irrep++ ){
@@ -292,6 +296,29 @@ void CheMPS2::CFCI::StartupCountersVsBitstrings(){
 
 void CheMPS2::CFCI::StartupLookupTables(){
 
+   lookup_work_size = 0;
+   unsigned long long num_entries = 0;
+   for ( unsigned int irrep = 0; irrep < num_irreps; irrep++ ){
+      lookup_work_size = std::max( lookup_work_size, std::max( numPerIrrep_up[ irrep ], numPerIrrep_down[ irrep ] ) );
+      num_entries += 2 * ((unsigned long long) L * L ) * ( numPerIrrep_up[ irrep ] + numPerIrrep_down[ irrep ] );
+   }
+   if ( FCIverbose > 0 ){
+      const double num_megabytes = ( 1.0 * sizeof(int) * num_entries ) / 1048576;
+      if ( lookupOnTheFly ){
+         std::cout << "FCI::Startup : The excitation lookup tables (" << num_megabytes << " MB) are replaced by on-the-fly bitstring addressing." << std::endl;
+      } else {
+         std::cout << "FCI::Startup : The excitation lookup tables require " << num_megabytes << " MB memory." << std::endl;
+      }
+   }
+
+   if ( lookupOnTheFly ){
+      lookup_cnt_alpha  = NULL;
+      lookup_cnt_beta   = NULL;
+      lookup_sign_alpha = NULL;
+      lookup_sign_beta  = NULL;
+      return;
+   }
+
    // Create a bunch of stuff
    lookup_cnt_alpha  = new int**[ num_irreps ];
    lookup_cnt_beta   = new int**[ num_irreps ];
@@ -402,6 +429,40 @@ void CheMPS2::CFCI::StartupLookupTables(){
 
 }
 
+void CheMPS2::CFCI::getLookup( const bool alpha, const int irrep, const unsigned int crea, const unsigned int anni, int * work, int ** signmap, int ** countmap ) const{
+
+   if ( !lookupOnTheFly ){
+      signmap [ 0 ] = ( alpha ) ? lookup_sign_alpha[ irrep ][ crea + L * anni ] : lookup_sign_beta[ irrep ][ crea + L * anni ];
+      countmap[ 0 ] = ( alpha ) ? lookup_cnt_alpha [ irrep ][ crea + L * anni ] : lookup_cnt_beta [ irrep ][ crea + L * anni ];
+      return;
+   }
+
+   signmap [ 0 ] = work;
+   countmap[ 0 ] = work + lookup_work_size;
+
+   const int irrep_old           = Irreps::directProd( irrep, Irreps::directProd( getOrb2Irrep( crea ), getOrb2Irrep( anni ) ) );
+   const unsigned int num_new    = ( alpha ) ? numPerIrrep_up[ irrep ] : numPerIrrep_down[ irrep ];
+   const unsigned int * cnt2str  = ( alpha ) ? cnt2str_up[ irrep ]     : cnt2str_down[ irrep ];
+   const int * str2cnt           = ( alpha ) ? str2cnt_up[ irrep_old ] : str2cnt_down[ irrep_old ];
+   const unsigned int mask_crea  = 1U << crea;
+   const unsigned int mask_anni  = 1U << anni;
+
+   // | new > = sign * E_{crea,anni} | old > : remove crea from | new >, add anni, and count the occupied orbitals which are passed
+   for ( unsigned int cnt_new = 0; cnt_new < num_new; cnt_new++ ){
+      const unsigned int str_new = cnt2str[ cnt_new ];
+      const unsigned int str_rem = str_new ^ mask_crea;
+      if (( str_new & mask_crea ) && ( !( str_rem & mask_anni ) )){
+         const int num_passed = __builtin_popcount( str_new & ( mask_crea - 1 ) ) + __builtin_popcount( str_rem & ( mask_anni - 1 ) );
+         work[ cnt_new ]                    = ( num_passed & 1 ) ? -1 : 1;
+         work[ cnt_new + lookup_work_size ] = str2cnt[ str_rem | mask_anni ];
+      } else {
+         work[ cnt_new ]                    = 0;
+         work[ cnt_new + lookup_work_size ] = 0;
+      }
+   }
+
+}
+
 void CheMPS2::CFCI::StartupIrrepCenter(){
 
    // Find the orbital combinations which can form a center irrep
@@ -461,7 +522,7 @@ void CheMPS2::CFCI::StartupIrrepCenter(){
          std::cout << "               For practical purposes, the workspace is constrained to " << num_megabytes << " MB memory." << std::endl;
       }
    }
-   HXVworksmall = new dcomplex[ L * L * L * L ];
+   HXVworksmall = new double[ L * L * L * L ];
    HXVworkbig1  = new dcomplex[ HXVsizeWorkspace ];
    HXVworkbig2  = new dcomplex[ HXVsizeWorkspace ];
 
@@ -643,7 +704,7 @@ void CheMPS2::CFCI::excite_alpha_omp( const unsigned int dim_new_up, const unsig
       if ( sign_up != 0 ){
          const int cnt_old_up = countmap[ cnt_new_up ];
          for ( unsigned int cnt_down = 0; cnt_down < dim_down; cnt_down++ ){
-            result[ cnt_new_up + dim_new_up * cnt_down ] += dcomplex( sign_up, 0 ) * origin[ cnt_old_up + dim_old_up * cnt_down ];
+            result[ cnt_new_up + dim_new_up * cnt_down ] += ( double )( sign_up ) * origin[ cnt_old_up + dim_old_up * cnt_down ];
          }
       }
    }
@@ -658,7 +719,7 @@ void CheMPS2::CFCI::excite_beta_omp( const unsigned int dim_up, const unsigned i
       if ( sign_down != 0 ){
          const int cnt_old_down = countmap[ cnt_new_down ];
          for ( unsigned int cnt_up = 0; cnt_up < dim_up; cnt_up++ ){
-            result[ cnt_up + dim_up * cnt_new_down ] += dcomplex( sign_down, 0 ) * origin[ cnt_up + dim_up * cnt_old_down ];
+            result[ cnt_up + dim_up * cnt_new_down ] += ( double )( sign_down ) * origin[ cnt_up + dim_up * cnt_old_down ];
          }
       }
    }
@@ -672,7 +733,7 @@ void CheMPS2::CFCI::excite_alpha_first( const unsigned int dim_new_up, const uns
       if ( sign_up != 0 ){
          const int cnt_old_up = countmap[ cnt_new_up ];
          for ( unsigned int cnt_down = start_down; cnt_down < stop_down; cnt_down++ ){
-            result[ cnt_new_up + dim_new_up * ( cnt_down - start_down ) ] += dcomplex( sign_up, 0 ) * origin[ cnt_old_up + dim_old_up * cnt_down ];
+            result[ cnt_new_up + dim_new_up * ( cnt_down - start_down ) ] += ( double )( sign_up ) * origin[ cnt_old_up + dim_old_up * cnt_down ];
          }
       }
    }
@@ -686,7 +747,7 @@ void CheMPS2::CFCI::excite_beta_first( const unsigned int dim_up, const unsigned
       if ( sign_down != 0 ){
          const int cnt_old_down = countmap[ cnt_new_down ];
          for ( unsigned int cnt_up = 0; cnt_up < dim_up; cnt_up++ ){
-            result[ cnt_up + dim_up * ( cnt_new_down - start_down ) ] += dcomplex( sign_down, 0 ) * origin[ cnt_up + dim_up * cnt_old_down ];
+            result[ cnt_up + dim_up * ( cnt_new_down - start_down ) ] += ( double )( sign_down ) * origin[ cnt_up + dim_up * cnt_old_down ];
          }
       }
    }
@@ -701,7 +762,7 @@ void CheMPS2::CFCI::excite_alpha_second_omp( const unsigned int dim_new_up, cons
       if ( sign_up != 0 ){ // Required for thread safety
          const int cnt_new_up = countmap[ cnt_old_up ];
          for ( unsigned int cnt_down = start_down; cnt_down < stop_down; cnt_down++ ){
-            result[ cnt_new_up + dim_new_up * cnt_down ] += dcomplex( sign_up, 0 ) * origin[ cnt_old_up + dim_old_up * ( cnt_down - start_down ) ];
+            result[ cnt_new_up + dim_new_up * cnt_down ] += ( double )( sign_up ) * origin[ cnt_old_up + dim_old_up * ( cnt_down - start_down ) ];
          }
       }
    }
@@ -716,7 +777,7 @@ void CheMPS2::CFCI::excite_beta_second_omp( const unsigned int dim_up, const uns
       if ( sign_down != 0 ){ // Required for thread safety
          const int cnt_new_down = countmap[ cnt_old_down ];
          for ( unsigned int cnt_up = 0; cnt_up < dim_up; cnt_up++ ){
-            result[ cnt_up + dim_up * cnt_new_down ] += dcomplex( sign_down, 0 ) * origin[ cnt_up + dim_up * ( cnt_old_down - start_down ) ];
+            result[ cnt_up + dim_up * cnt_new_down ] += ( double )( sign_down ) * origin[ cnt_up + dim_up * ( cnt_old_down - start_down ) ];
          }
       }
    }
@@ -725,11 +786,52 @@ void CheMPS2::CFCI::excite_beta_second_omp( const unsigned int dim_up, const uns
 
 void CheMPS2::CFCI::matvec( dcomplex * input, dcomplex * output ) const{
 
+   matvec_partial( input, output );
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+      MPIchemps2::allreduce_array_double_inplace( reinterpret_cast<double *>( output ), 2 * ( long long ) getVecLength( 0 ) );
+   #endif
+
+}
+
+unsigned int CheMPS2::CFCI::getSliceStart( const int rank, const int size ) const{
+
+   const unsigned int veclength = getVecLength( 0 );
+   if ( rank >= size ){ return veclength; }
+
+   // The first column of the irrep blocks which starts at or after an equal share of the variables
+   const unsigned int target = ( unsigned int )(( ( unsigned long long ) veclength * rank ) / size );
+   const unsigned int * zero_jumps = irrep_center_jumps[ 0 ];
+   for ( unsigned int irrep_up = 0; irrep_up < num_irreps; irrep_up++ ){
+      if ( target < zero_jumps[ irrep_up + 1 ] ){
+         const unsigned int dim_up  = numPerIrrep_up[ irrep_up ];
+         const unsigned int columns = ( target - zero_jumps[ irrep_up ] + dim_up - 1 ) / dim_up;
+         return std::min( zero_jumps[ irrep_up ] + dim_up * columns, zero_jumps[ irrep_up + 1 ] );
+      }
+   }
+   return veclength;
+
+}
+
+void CheMPS2::CFCI::matvec_partial( dcomplex * input, dcomplex * output ) const{
+
    struct timeval start, end;
    gettimeofday( &start, NULL );
 
    ClearVector( getVecLength( 0 ), output );
 
+   // Workspace for the signmap and countmap of the second excitation step in on-the-fly mode
+   int * lookup_work = ( lookupOnTheFly ) ? new int[ 2 * lookup_work_size ] : NULL;
+
+   /* With MPI, the ( irrep_center, irrep_center_up, block ) jobs are distributed round-robin over the processes. A job reads
+      and writes the irrep blocks irrep_center_up and irrep_center x irrep_center_up of the vectors, so that every process
+      needs the whole input. Each process accumulates its part in output, which is summed by the caller. */
+   #ifdef CHEMPS2_MPI_COMPILATION
+      const int MPIRANK = MPIchemps2::mpi_rank();
+      const int MPISIZE = MPIchemps2::mpi_size();
+      int job = 0;
+   #endif
+
    // P.J. Knowles and N.C. Handy, A new determinant-based full configuration interaction method, Chemical Physics Letters 111 (4-5), 315-321 (1984)
 
    // irrep_center is the center irrep of the ERI : (ij|kl) --> irrep_center = I_i x I_j = I_k x I_l
@@ -754,46 +856,52 @@ void CheMPS2::CFCI::matvec( dcomplex * input, dcomplex * output ) const{
                const unsigned int start_center_down = block * blocksize_beta;
                const unsigned int  stop_center_down = std::min( ( block + 1 ) * blocksize_beta, dim_center_down );
                const unsigned int size_center = dim_center_up * ( stop_center_down - start_center_down );
-               if ( size_center > 0 ){
+               #ifdef CHEMPS2_MPI_COMPILATION
+                  const bool do_job = ( ( job++ ) % MPISIZE == MPIRANK );
+               #else
+                  const bool do_job = true;
+               #endif
+               if (( size_center > 0 ) && ( do_job )){
 
                   // First build workbig1[ veccounter + size_center * pair ] = E_{i<=j} + ( 1 - delta_i==j ) E_{j>i} (irrep_center) | input >  */
-                  #pragma omp parallel for schedule(static)
-                  for ( unsigned int pair = 0; pair < num_pairs; pair++ ){
-                     dcomplex * target_space   = HXVworkbig1 + size_center * pair;
-                     const unsigned int crea = center_crea_orb[ pair ];
-                     const unsigned int anni = center_anni_orb[ pair ];
-                     const int irrep_excited = Irreps::directProd( getOrb2Irrep( crea ), getOrb2Irrep( anni ) );
-                     const int irrep_zero_up = Irreps::directProd( irrep_excited, irrep_center_up );
-                     const unsigned int dim_zero_up = numPerIrrep_up[ irrep_zero_up ];
-                     for ( unsigned int count = 0; count < size_center; count++ ){ target_space[ count ] = 0.0; }
+                  #pragma omp parallel
+                  {
+                     int * lookup_work = ( lookupOnTheFly ) ? new int[ 2 * lookup_work_size ] : NULL;
+                     int * signmap;
+                     int * countmap;
 
-                     excite_alpha_first( dim_center_up, dim_zero_up, start_center_down, stop_center_down,
-                                         input + zero_jumps[ irrep_zero_up ],
-                                         target_space,
-                                         lookup_sign_alpha[ irrep_center_up ][ crea + L * anni ],
-                                         lookup_cnt_alpha [ irrep_center_up ][ crea + L * anni ] );
+                     #pragma omp for schedule(static)
+                     for ( unsigned int pair = 0; pair < num_pairs; pair++ ){
+                        dcomplex * target_space   = HXVworkbig1 + size_center * pair;
+                        const unsigned int crea = center_crea_orb[ pair ];
+                        const unsigned int anni = center_anni_orb[ pair ];
+                        const int irrep_excited = Irreps::directProd( getOrb2Irrep( crea ), getOrb2Irrep( anni ) );
+                        const int irrep_zero_up = Irreps::directProd( irrep_excited, irrep_center_up );
+                        const unsigned int dim_zero_up = numPerIrrep_up[ irrep_zero_up ];
+                        for ( unsigned int count = 0; count < size_center; count++ ){ target_space[ count ] = 0.0; }
+
+                        getLookup( true, irrep_center_up, crea, anni, lookup_work, &signmap, &countmap );
+                        excite_alpha_first( dim_center_up, dim_zero_up, start_center_down, stop_center_down,
+                                            input + zero_jumps[ irrep_zero_up ], target_space, signmap, countmap );
 
-                     excite_beta_first( dim_center_up, start_center_down, stop_center_down,
-                                        input + zero_jumps[ irrep_center_up ],
-                                        target_space,
-                                        lookup_sign_beta[ irrep_center_down ][ crea + L * anni ],
-                                        lookup_cnt_beta [ irrep_center_down ][ crea + L * anni ] );
+                        getLookup( false, irrep_center_down, crea, anni, lookup_work, &signmap, &countmap );
+                        excite_beta_first( dim_center_up, start_center_down, stop_center_down,
+                                           input + zero_jumps[ irrep_center_up ], target_space, signmap, countmap );
 
-                     if ( anni > crea ){
+                        if ( anni > crea ){
 
-                        excite_alpha_first( dim_center_up, dim_zero_up, start_center_down, stop_center_down,
-                                            input + zero_jumps[ irrep_zero_up ],
-                                            target_space,
-                                            lookup_sign_alpha[ irrep_center_up ][ anni + L * crea ],
-                                            lookup_cnt_alpha [ irrep_center_up ][ anni + L * crea ] );
+                           getLookup( true, irrep_center_up, anni, crea, lookup_work, &signmap, &countmap );
+                           excite_alpha_first( dim_center_up, dim_zero_up, start_center_down, stop_center_down,
+                                               input + zero_jumps[ irrep_zero_up ], target_space, signmap, countmap );
 
-                        excite_beta_first( dim_center_up, start_center_down, stop_center_down,
-                                           input + zero_jumps[ irrep_center_up ],
-                                           target_space,
-                                           lookup_sign_beta[ irrep_center_down ][ anni + L * crea ],
-                                           lookup_cnt_beta [ irrep_center_down ][ anni + L * crea ] );
+                           getLookup( false, irrep_center_down, anni, crea, lookup_work, &signmap, &countmap );
+                           excite_beta_first( dim_center_up, start_center_down, stop_center_down,
+                                              input + zero_jumps[ irrep_center_up ], target_space, signmap, countmap );
 
+                        }
                      }
+
+                     if ( lookup_work != NULL ){ delete [] lookup_work; }
                   }
 
                   // If irrep_center == 0, do the one-body terms
@@ -801,13 +909,14 @@ void CheMPS2::CFCI::matvec( dcomplex * input, dcomplex * output ) const{
                      for ( unsigned int pair = 0; pair < num_pairs; pair++ ){
                         HXVworksmall[ pair ] = getGmat( center_crea_orb[ pair ], center_anni_orb[ pair ] );
                      }
+                     // The integrals are real: multiply the interleaved real and imaginary parts with one dgemm
                      char notrans = 'N';
-                     dcomplex one = 1.0;
-                     int mdim = size_center;
+                     double one = 1.0;
+                     int mdim = 2 * size_center;
                      int kdim = num_pairs;
                      int ndim = 1;
                      dcomplex * target = output + zero_jumps[ irrep_center_up ] + dim_center_up * start_center_down;
-                     zgemm_( &notrans, &notrans, &mdim, &ndim, &kdim, &one, HXVworkbig1, &mdim, HXVworksmall, &kdim, &one, target, &mdim );
+                     dgemm_( &notrans, &notrans, &mdim, &ndim, &kdim, &one, reinterpret_cast<double *>( HXVworkbig1 ), &mdim, HXVworksmall, &kdim, &one, reinterpret_cast<double *>( target ), &mdim );
                   }
 
                   // Now build workbig2[ veccounter + size_center * new_pair ] = 0.5 * ( new_pair | old_pair ) * workbig1[ veccounter + size_center * old_pair ]
@@ -820,12 +929,12 @@ void CheMPS2::CFCI::matvec( dcomplex * input, dcomplex * output ) const{
                         }
                      }
                      char notrans = 'N';
-                     dcomplex one = 1.0;
-                     dcomplex set = 0.0;
-                     int mdim = size_center;
+                     double one = 1.0;
+                     double set = 0.0;
+                     int mdim = 2 * size_center; // Interleaved real and imaginary parts
                      int kdim = num_pairs;
                      int ndim = num_pairs;
-                     zgemm_( &notrans, &notrans, &mdim, &ndim, &kdim, &one, HXVworkbig1, &mdim, HXVworksmall, &kdim, &set, HXVworkbig2, &mdim );
+                     dgemm_( &notrans, &notrans, &mdim, &ndim, &kdim, &one, reinterpret_cast<double *>( HXVworkbig1 ), &mdim, HXVworksmall, &kdim, &set, reinterpret_cast<double *>( HXVworkbig2 ), &mdim );
                   }
 
                   // Finally do output <-- E_{i<=j} + (1 - delta_{i==j}) E_{j>i} workbig2[ veccounter + size_center * pair ]
@@ -836,32 +945,26 @@ void CheMPS2::CFCI::matvec( dcomplex * input, dcomplex * output ) const{
                      const int irrep_excited = Irreps::directProd( getOrb2Irrep( crea ), getOrb2Irrep( anni ) );
                      const int irrep_zero_up = Irreps::directProd( irrep_excited, irrep_center_up );
                      const unsigned int dim_zero_up = numPerIrrep_up[ irrep_zero_up ];
+                     int * signmap;
+                     int * countmap;
 
+                     getLookup( true, irrep_center_up, anni, crea, lookup_work, &signmap, &countmap );
                      excite_alpha_second_omp( dim_zero_up, dim_center_up, start_center_down, stop_center_down,
-                                              origin_space,
-                                              output + zero_jumps[ irrep_zero_up ],
-                                              lookup_sign_alpha[ irrep_center_up ][ anni + L * crea ],
-                                              lookup_cnt_alpha [ irrep_center_up ][ anni + L * crea ] );
+                                              origin_space, output + zero_jumps[ irrep_zero_up ], signmap, countmap );
 
+                     getLookup( false, irrep_center_down, anni, crea, lookup_work, &signmap, &countmap );
                      excite_beta_second_omp( dim_center_up, start_center_down, stop_center_down,
-                                             origin_space,
-                                             output + zero_jumps[ irrep_center_up ],
-                                             lookup_sign_beta[ irrep_center_down ][ anni + L * crea ],
-                                             lookup_cnt_beta [ irrep_center_down ][ anni + L * crea ] );
+                                             origin_space, output + zero_jumps[ irrep_center_up ], signmap, countmap );
 
                      if ( anni > crea ){
 
+                        getLookup( true, irrep_center_up, crea, anni, lookup_work, &signmap, &countmap );
                         excite_alpha_second_omp( dim_zero_up, dim_center_up, start_center_down, stop_center_down,
-                                                 origin_space,
-                                                 output + zero_jumps[ irrep_zero_up ],
-                                                 lookup_sign_alpha[ irrep_center_up ][ crea + L * anni ],
-                                                 lookup_cnt_alpha [ irrep_center_up ][ crea + L * anni ] );
+                                                 origin_space, output + zero_jumps[ irrep_zero_up ], signmap, countmap );
 
+                        getLookup( false, irrep_center_down, crea, anni, lookup_work, &signmap, &countmap );
                         excite_beta_second_omp( dim_center_up, start_center_down, stop_center_down,
-                                                origin_space,
-                                                output + zero_jumps[ irrep_center_up ],
-                                                lookup_sign_beta[ irrep_center_down ][ crea + L * anni ],
-                                                lookup_cnt_beta [ irrep_center_down ][ crea + L * anni ] );
+                                                origin_space, output + zero_jumps[ irrep_center_up ], signmap, countmap );
 
                      }
                   }
@@ -871,6 +974,8 @@ void CheMPS2::CFCI::matvec( dcomplex * input, dcomplex * output ) const{
       }
    }
 
+   if ( lookup_work != NULL ){ delete [] lookup_work; }
+
    gettimeofday( &end, NULL );
    const double elapsed = ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
    if ( FCIverbose >= 1 ){ std::cout << "FCI::matvec : Wall time = " << elapsed << " seconds" << std::endl; }
@@ -886,28 +991,34 @@ void CheMPS2::CFCI::apply_excitation( dcomplex * orig_vector, dcomplex * result_
 
    ClearVector( getVecLength( result_irrep_center ) , result_vector );
 
+   int * lookup_work = ( lookupOnTheFly ) ? new int[ 2 * lookup_work_size ] : NULL;
+   int * signmap;
+   int * countmap;
+
    for ( unsigned int result_irrep_up = 0; result_irrep_up < num_irreps; result_irrep_up++ ){
 
       const int result_irrep_down = Irreps::directProd( result_irrep_up, result_target_irrep );
       const int orig_irrep_up     = Irreps::directProd( excitation_irrep, result_irrep_up );
 
+      getLookup( true, result_irrep_up, crea, anni, lookup_work, &signmap, &countmap );
       excite_alpha_omp( numPerIrrep_up  [ result_irrep_up   ], // dim_new_up
                         numPerIrrep_up  [   orig_irrep_up   ], // dim_old_up
                         numPerIrrep_down[ result_irrep_down ], // dim_down
                         orig_vector   + irrep_center_jumps[   orig_irrep_center ][   orig_irrep_up ], // origin
                         result_vector + irrep_center_jumps[ result_irrep_center ][ result_irrep_up ], // result
-                        lookup_sign_alpha[ result_irrep_up ][ crea + L * anni ],   // signmap
-                        lookup_cnt_alpha [ result_irrep_up ][ crea + L * anni ] ); // countmap
+                        signmap, countmap );
 
+      getLookup( false, result_irrep_down, crea, anni, lookup_work, &signmap, &countmap );
       excite_beta_omp( numPerIrrep_up  [ result_irrep_up   ], // dim_up
                        numPerIrrep_down[ result_irrep_down ], // dim_new_down
                        orig_vector   + irrep_center_jumps[   orig_irrep_center ][ result_irrep_up ], // origin
                        result_vector + irrep_center_jumps[ result_irrep_center ][ result_irrep_up ], // result
-                       lookup_sign_beta[ result_irrep_down ][ crea + L * anni ],   // signmap
-                       lookup_cnt_beta [ result_irrep_down ][ crea + L * anni ] ); // countmap
+                       signmap, countmap );
 
    }
 
+   if ( lookup_work != NULL ){ delete [] lookup_work; }
+
 }
 
 dcomplex CheMPS2::CFCI::Fill2RDM(dcomplex * vector, dcomplex * two_rdm) const{
@@ -1997,15 +2108,13 @@ dcomplex CheMPS2::CFCI::FCIddot(const unsigned int vecLength, dcomplex * vec1, d
 
 }
 
-dcomplex CheMPS2::CFCI::FCIaHb(const unsigned int vecLength, dcomplex * vec1, dcomplex * vec2){
+dcomplex CheMPS2::CFCI::FCIaHb(const unsigned int vecLength, dcomplex * vec1, dcomplex * vec2, dcomplex * workspace){
 
    int length = vecLength; // Checked "assert( max_integer >= maxVecLength );" at FCI::StartupIrrepCenter()
 
    dcomplex over = FCIddot( length, vec1, vec2 );
-   dcomplex * applied = new dcomplex[ length ];
-   matvec( vec2, applied );
-   dcomplex result = FCIddot( length, vec1, applied ) + over * getEconst();
-   delete[] applied;
+   matvec( vec2, workspace );
+   dcomplex result = FCIddot( length, vec1, workspace ) + over * getEconst();
    return result;
 
 }
@@ -2117,68 +2226,70 @@ double CheMPS2::CFCI::calc1h0p( dcomplex * state, const int * hf_state ){
    return result;
 }
 
-double CheMPS2::CFCI::calcWieght( int nHoles, int nParticles, dcomplex * state, const int * hf_state ){
-
-   double result = 0;
+void CheMPS2::CFCI::calcWeights( dcomplex * state, const int * hf_state, double * weights ) const{
 
-   int* myoccus = new int[ 2 * L ];
-   for( int idx = 0; idx < 2 * L; idx++ ){
-      if( idx < ( Nel_up + Nel_down ) ){
-         myoccus[ idx ] = 1;
-      } else {
-         myoccus[ idx ] = 0;
-      }
+   /* With n the occupation of an orbital and n_HF its occupation in hf_state, the number of particles is sum max( 0, n - n_HF ).
+      With the bitstrings D = up & down ( n = 2 ) and S = up ^ down ( n = 1 ), and the masks H0 and H1 of the orbitals with
+      n_HF = 0 and n_HF = 1, this is popcount( S & H0 ) + 2 * popcount( D & H0 ) + popcount( D & H1 ). The number of holes
+      is the number of particles plus the difference in particle number between hf_state and the FCI vector. */
+   unsigned int mask_hf0 = 0;
+   unsigned int mask_hf1 = 0;
+   for ( unsigned int orb = 0; orb < L; orb++ ){
+      assert( ( hf_state[ orb ] >= 0 ) && ( hf_state[ orb ] <= 2 ) );
+      if ( hf_state[ orb ] == 0 ){ mask_hf0 |= ( 1U << orb ); }
+      if ( hf_state[ orb ] == 1 ){ mask_hf1 |= ( 1U << orb ); }
    }
 
-   std::sort( myoccus, myoccus + 2 * L );
-   do {
-      int* alphas = &myoccus[ 0 ];
-      int* betas = &myoccus[ L ];
-
-      int iHoles = 0;
-      int iParticles = 0;
-
-      for( int idx = 0; idx < L; idx++ ) { 
-         if ( alphas[ idx ] + betas[ idx ] < hf_state[ idx ] ){
-            iHoles += hf_state[ idx ] - ( alphas[ idx ] + betas[ idx ] );
+   for ( unsigned int particles = 0; particles <= 2 * L; particles++ ){ weights[ particles ] = 0.0; }
+
+   for ( unsigned int irrep_up = 0; irrep_up < num_irreps; irrep_up++ ){
+      const int irrep_down            = Irreps::directProd( irrep_up, TargetIrrep );
+      const unsigned int dim_up       = numPerIrrep_up  [ irrep_up   ];
+      const unsigned int dim_down     = numPerIrrep_down[ irrep_down ];
+      const unsigned int * strs_up    = cnt2str_up  [ irrep_up   ];
+      const unsigned int * strs_down  = cnt2str_down[ irrep_down ];
+      dcomplex * block                = state + irrep_center_jumps[ 0 ][ irrep_up ];
+      for ( unsigned int cnt_down = 0; cnt_down < dim_down; cnt_down++ ){
+         const unsigned int str_down = strs_down[ cnt_down ];
+         for ( unsigned int cnt_up = 0; cnt_up < dim_up; cnt_up++ ){
+            const unsigned int doubly = strs_up[ cnt_up ] & str_down;
+            const unsigned int singly = strs_up[ cnt_up ] ^ str_down;
+            const int particles = __builtin_popcount( singly & mask_hf0 ) + 2 * __builtin_popcount( doubly & mask_hf0 ) + __builtin_popcount( doubly & mask_hf1 );
+            weights[ particles ] += std::norm( block[ cnt_up + dim_up * cnt_down ] );
          }
       }
+   }
 
-      for( int idx = 0; idx < L; idx++ ) { 
-         if ( alphas[ idx ] + betas[ idx ] > hf_state[ idx ] ){
-            iParticles += ( alphas[ idx ] + betas[ idx ] ) - hf_state[ idx ];
-         }
-      }
+}
 
-      if( ( iHoles == nHoles ) && ( iParticles == nParticles ) ){
-         double test = std::pow( std::abs( getFCIcoeff( alphas, betas, state ) ), 2.0 );
-         if( nHoles == 1 && nParticles == 1 && test > 0 ){
-            for( int idx = 0; idx < L; idx++ ) { 
-               std::cout << alphas[ idx ] << " ";
-            }
-            std::cout << std::endl;
-            for( int idx = 0; idx < L; idx++ ) { 
-               std::cout << betas[ idx ] << " ";
-            }
-            std::cout << std::endl;
-            std::cout << test << std::endl;
-         }
-         result += test;
-      }
+double CheMPS2::CFCI::calcWieght( int nHoles, int nParticles, dcomplex * state, const int * hf_state ){
 
-   } while ( std::next_permutation( myoccus, myoccus + 2 * L ) );
+   int deltaN = - ( Nel_up + Nel_down );
+   for ( unsigned int orb = 0; orb < L; orb++ ){ deltaN += hf_state[ orb ]; }
+   if (( nHoles - nParticles != deltaN ) || ( nParticles < 0 ) || ( nParticles > ( int )( 2 * L ) )){ return 0.0; }
 
-   delete[] myoccus;
+   double * weights = new double[ 2 * L + 1 ];
+   calcWeights( state, hf_state, weights );
+   const double result = weights[ nParticles ];
+   delete [] weights;
 
    return result;
 }
 
 
-void CheMPS2::CFCI::TimeEvolution( const char time_type, const double time_step_major, const double time_step_minor, double finalTime, const bool dobackwards, dcomplex * inital, unsigned int krylovSize, const bool doDumpFCI, const bool doDump2RDM, const int nWeights, const int * hfState){
+void CheMPS2::CFCI::TimeEvolution( const char time_type, const double time_step_major, const double time_step_minor, double finalTime, const bool dobackwards, dcomplex * inital, unsigned int krylovSize, const bool doDumpFCI, const bool doDump2RDM, const int nWeights, const int * hfState, const double krylovTolerance){
 
-   std::cout << "\n";
-   std::cout << "   Starting to propagate FCI wave function\n";
-   std::cout << "\n";
+   #ifdef CHEMPS2_MPI_COMPILATION
+      const bool am_i_master = ( MPIchemps2::mpi_rank() == MPI_CHEMPS2_MASTER );
+   #else
+      const bool am_i_master = true;
+   #endif
+
+   if ( am_i_master ){
+      std::cout << "\n";
+      std::cout << "   Starting to propagate FCI wave function\n";
+      std::cout << "\n";
+   }
 
    const hid_t outputID    = H5Gcreate( HDF5FILEID, "/Output", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT );
    const hsize_t dimScalar = 1;
@@ -2195,6 +2306,10 @@ void CheMPS2::CFCI::TimeEvolution( const char time_type, const double time_step_
 
    dcomplex * next = new dcomplex [ veclength ];
 
+   // Pool of Lanczos vectors, filled on demand by ArnoldiTimeStep and reused by all time steps
+   dcomplex ** krylovPool = new dcomplex * [ krylovSize ];
+   for ( unsigned int kry = 0; kry < krylovSize; kry++ ){ krylovPool[ kry ] = NULL; }
+
    for ( double t = 0.0; t < finalTime; t += time_step_major ) {
       dcomplex * terdm   = new dcomplex[ L * L * L * L];
       const double energy      = std::real( Fill2RDM( act, terdm ) );
@@ -2231,27 +2346,29 @@ void CheMPS2::CFCI::TimeEvolution( const char time_type, const double time_step_
       //    Econstant += -1.0 *  energy;
       // }
 
-      std::cout << hashline;
-      std::cout                                                  << "\n";
-      std::cout << "   FCI time step"                            << "\n";
-      std::cout                                                  << "\n";
-      std::cout << "   Duration since start " << elapsed << " seconds\n";
-      std::cout                                                  << "\n";
-      std::cout << "   t        = " << t                         << "\n";
-      std::cout << "   Tmax     = " << finalTime                 << "\n";
-      std::cout << "   dt major = " << time_step_major           << "\n";
-      std::cout << "   dt minor = " << time_step_minor           << "\n";
-      std::cout << "   KryS      = " << krylovSize               << "\n";
-      std::cout                                                  << "\n";
-      std::cout << "   Norm      = " << normOfState              << "\n";
-      std::cout << "   Energy    = " << energy                   << "\n";
-      std::cout << "   Re(OInit) = " << reOinit                  << "\n";
-      std::cout << "   Im(OInit) = " << imOinit                  << "\n";
-      std::cout                                                  << "\n";
-      std::cout << "  occupation numbers of molecular orbitals:      \n";
-      std::cout << "   "; for ( int i = 0; i < L; i++ ) { std::cout << std::setw( 20 ) << oedmre[ i + L * i ];  }
-      std::cout                                                  << "\n";
-      std::cout                                                  << "\n";
+      if ( am_i_master ){
+         std::cout << hashline;
+         std::cout                                                  << "\n";
+         std::cout << "   FCI time step"                            << "\n";
+         std::cout                                                  << "\n";
+         std::cout << "   Duration since start " << elapsed << " seconds\n";
+         std::cout                                                  << "\n";
+         std::cout << "   t        = " << t                         << "\n";
+         std::cout << "   Tmax     = " << finalTime                 << "\n";
+         std::cout << "   dt major = " << time_step_major           << "\n";
+         std::cout << "   dt minor = " << time_step_minor           << "\n";
+         std::cout << "   KryS      = " << krylovSize               << "\n";
+         std::cout                                                  << "\n";
+         std::cout << "   Norm      = " << normOfState              << "\n";
+         std::cout << "   Energy    = " << energy                   << "\n";
+         std::cout << "   Re(OInit) = " << reOinit                  << "\n";
+         std::cout << "   Im(OInit) = " << imOinit                  << "\n";
+         std::cout                                                  << "\n";
+         std::cout << "  occupation numbers of molecular orbitals:      \n";
+         std::cout << "   "; for ( int i = 0; i < L; i++ ) { std::cout << std::setw( 20 ) << oedmre[ i + L * i ];  }
+         std::cout                                                  << "\n";
+         std::cout                                                  << "\n";
+      }
 
       char dataPointname[ 1024 ];
       sprintf( dataPointname, "/Output/DataPoint%.5f", t );
@@ -2280,17 +2397,23 @@ void CheMPS2::CFCI::TimeEvolution( const char time_type, const double time_step_
          int* nParticles =    new int[ nWeights ];
          double* weights = new double[ nWeights ];
 
+         // One sweep over the FCI vector gives the weights of all excitation levels
+         double * histogram = new double[ 2 * L + 1 ];
+         calcWeights( act, hfState, histogram );
          for( int iWeight = 0; iWeight < nWeights; iWeight++ ){
             nHoles[ iWeight ]     = iWeight + deltaN;
             nParticles[ iWeight ] = iWeight;
-            weights[ iWeight ]    =  calcWieght( iWeight + deltaN, iWeight, act, hfState );
+            weights[ iWeight ]    = ( iWeight <= ( int )( 2 * L ) ) ? histogram[ iWeight ] : 0.0;
          }
+         delete [] histogram;
 
-         std::cout << "  The lowest " << nWeights << " CI weights are:\n";
-         for( int iWeight = 0; iWeight < nWeights; iWeight++ ){
-            std::cout << "  " << nHoles[ iWeight ] <<  "h" << nParticles[ iWeight] << "p-weight  = " << weights[ iWeight ] << "\n";
+         if ( am_i_master ){
+            std::cout << "  The lowest " << nWeights << " CI weights are:\n";
+            for( int iWeight = 0; iWeight < nWeights; iWeight++ ){
+               std::cout << "  " << nHoles[ iWeight ] <<  "h" << nParticles[ iWeight] << "p-weight  = " << weights[ iWeight ] << "\n";
+            }
+            std::cout                                                 << "\n";
          }
-         std::cout                                                 << "\n";
 
          HDF5_MAKE_DATASET( dataPointID, "nHoles",     1, &weightSze, H5T_STD_I32LE,      nHoles     );
          HDF5_MAKE_DATASET( dataPointID, "nParticles", 1, &weightSze, H5T_STD_I32LE,      nParticles );
@@ -2313,9 +2436,9 @@ void CheMPS2::CFCI::TimeEvolution( const char time_type, const double time_step_
          sprintf( dataFCIName, "%s/FCICOEF", dataPointname );
          const hid_t FCIID = HDF5FILEID != H5_CHEMPS2_TIME_NO_H5OUT ? H5Gcreate( HDF5FILEID, dataFCIName, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT ) : H5_CHEMPS2_TIME_NO_H5OUT;
 
-         for ( int l = 0; l < alphasOut.size(); l++ ) {
+         for ( unsigned int l = 0; l < alphasOut.size(); l++ ) {
             char dataFCINameN[ 1024 ];
-            sprintf( dataFCINameN, "%s/FCICOEF/%i", dataPointname, l );
+            sprintf( dataFCINameN, "%s/FCICOEF/%u", dataPointname, l );
             const hid_t FCIID = HDF5FILEID != H5_CHEMPS2_TIME_NO_H5OUT ? H5Gcreate( HDF5FILEID, dataFCINameN, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT ) : H5_CHEMPS2_TIME_NO_H5OUT;
             HDF5_MAKE_DATASET( FCIID, "FCI_ALPHAS", 1, &Lsize,     H5T_NATIVE_INT,    &betasOut[ l ][ 0 ]  );
             HDF5_MAKE_DATASET( FCIID, "FCI_BETAS",  1, &Lsize,     H5T_NATIVE_INT,    &alphasOut[ l ][ 0 ] );
@@ -2342,12 +2465,12 @@ void CheMPS2::CFCI::TimeEvolution( const char time_type, const double time_step_
       delete[] oedmre;
       delete[] oedmim;
 
-      std::cout << "\n";
+      if ( am_i_master ){ std::cout << "\n"; }
 
       if ( t + time_step_major < finalTime ) {
          for( double t_minor = 0.0; (time_step_major - t_minor) > 1e-6; t_minor+=time_step_minor ) {
             if(time_type == 'K'){
-               ArnoldiTimeStep( time_step_minor, dobackwards, krylovSize, act, next );
+               ArnoldiTimeStep( time_step_minor, dobackwards, krylovSize, krylovTolerance, act, next, krylovPool );
             } else {
                std::cerr << "Not implemented yet\n";
             }
@@ -2355,215 +2478,182 @@ void CheMPS2::CFCI::TimeEvolution( const char time_type, const double time_step_
          }
       }
 
-      std::cout << hashline;
+      if ( am_i_master ){ std::cout << hashline; }
    }
 
+   for ( unsigned int kry = 0; kry < krylovSize; kry++ ){
+      if ( krylovPool[ kry ] != NULL ){ delete[] krylovPool[ kry ]; }
+   }
+   delete[] krylovPool;
    delete[] next;
    delete[] act;
 
 }
 
-void CheMPS2::CFCI::ArnoldiTimeStep( double timeStep, const bool dobackwards, unsigned int krylovSize, dcomplex * input, dcomplex * output){
-
-   dcomplex step = dobackwards ? dcomplex( 0.0, 1.0 * timeStep ) : dcomplex( 0.0, -1.0 * timeStep );
-
-   int veclength = getVecLength( 0 ); // Checked "assert( max_integer >= maxVecLength );" at FCI::StartupIrrepCenter()
-   ClearVector( veclength, output );
-
-   int krylovSpaceDimension = krylovSize;
-
-   //////////////////////////////////////////////////////////////////////////////////////
-   //
-   // Generating Krylov Space vectors
-   //
-   //////////////////////////////////////////////////////////////////////////////////////
-
-   dcomplex ** krylovBasisVectors = new dcomplex * [ krylovSpaceDimension ];
-   dcomplex *  krylovHamiltonian  = new dcomplex   [ krylovSpaceDimension * krylovSpaceDimension ];
-   dcomplex *  overlaps           = new dcomplex   [ krylovSpaceDimension * krylovSpaceDimension ];
-
-   // Step 1
-   krylovBasisVectors[ 0 ]                           = input;
-   krylovHamiltonian[ 0 + 0 * krylovSpaceDimension ] = FCIaHb(  veclength, krylovBasisVectors[ 0 ], krylovBasisVectors[ 0 ] );
-   overlaps[ 0 + 0 * krylovSpaceDimension ]          = FCIddot( veclength, krylovBasisVectors[ 0 ], krylovBasisVectors[ 0 ] );
-   
-   for ( int kry = 1; kry < krylovSpaceDimension; kry++ ) {
-
-      dcomplex * newKrylov = new dcomplex [ veclength ];
-      ClearVector( veclength, newKrylov );
-      matvec( krylovBasisVectors[ kry - 1 ], newKrylov );
-      FCIdaxpy( veclength, getEconst(), krylovBasisVectors[ kry - 1 ], newKrylov );
-
-      for ( int i = 0; i < kry; i++ ) {
-         dcomplex coef = -krylovHamiltonian[ i + ( kry - 1 ) * krylovSpaceDimension ] / overlaps[ i + i * krylovSpaceDimension ];
-         FCIdaxpy( veclength, coef, krylovBasisVectors[ i ], newKrylov );
-      }
-
-      dcomplex norm_inv = std::pow( std::real( FCIddot( veclength, newKrylov, newKrylov ) ), -0.5 );
-      FCIdscal( veclength, norm_inv, newKrylov );
-      krylovBasisVectors[ kry ] = newKrylov;
-
-      for ( int i = 0; i <= kry; i++ ) {
-         overlaps[ i + kry * krylovSpaceDimension ]          = FCIddot( veclength, krylovBasisVectors[ i ], krylovBasisVectors[ kry ] );
-         overlaps[ kry + i * krylovSpaceDimension ]          = std::conj( overlaps[ i + kry * krylovSpaceDimension ] );
-         krylovHamiltonian[ i + kry * krylovSpaceDimension ] = FCIaHb( veclength, krylovBasisVectors[ i ], krylovBasisVectors[ kry ] );
-         krylovHamiltonian[ kry + i * krylovSpaceDimension ] = std::conj( krylovHamiltonian[ i + kry * krylovSpaceDimension ] );
+int CheMPS2::CFCI::ArnoldiTimeStep( double timeStep, const bool dobackwards, unsigned int krylovSize, const double tolerance, dcomplex * input, dcomplex * output, dcomplex ** pool ){
+
+   /* Lanczos exponential integrator: output = exp( step * H ) input, with step = -/+ i * timeStep.
+      The Lanczos vectors v_1, v_2, ... live in pool[ 0 ], pool[ 1 ], ... which are allocated on first use and reused
+      by the following steps, so only the vectors that are really needed are ever allocated. v_0 = input / beta_0 is
+      never copied, and output holds the residual of the last Lanczos vector until it is overwritten with the result.
+      The Krylov dimension is increased until the a posteriori error estimate beta_0 * beta_m * | [ exp( step * T ) ]_{m-1,0} |
+      drops below tolerance, or until krylovSize is reached.
+      With MPI, every process only keeps its slice [ first, first + size ) of the Lanczos vectors. Before each matvec, the
+      slices of v_j are gathered into one full vector. The partial products of the processes are summed with a reduce-scatter,
+      so that every process only receives its own slice of H v_j. The inner products are summed over the processes.
+      input and output are full vectors on all processes. */
+
+   const dcomplex step = dobackwards ? dcomplex( 0.0, 1.0 * timeStep ) : dcomplex( 0.0, -1.0 * timeStep );
+
+   const unsigned int veclength = getVecLength( 0 ); // Checked "assert( max_integer >= maxVecLength );" at FCI::StartupIrrepCenter()
+   const int maxdim             = std::max( 1, ( int )( krylovSize ) );
+
+   #ifdef CHEMPS2_MPI_COMPILATION
+      const int MPIRANK = MPIchemps2::mpi_rank();
+      const int MPISIZE = MPIchemps2::mpi_size();
+      int * counts      = new int[ MPISIZE ];
+      int * starts      = new int[ MPISIZE ];
+      for ( int rank = 0; rank < MPISIZE; rank++ ){
+         starts[ rank ] = getSliceStart( rank, MPISIZE );
+         counts[ rank ] = getSliceStart( rank + 1, MPISIZE ) - starts[ rank ];
       }
+      dcomplex * gathered = new dcomplex[ veclength ];
+      dcomplex * partial  = new dcomplex[ veclength ];
+   #else
+      const int MPIRANK = 0;
+      const int MPISIZE = 1;
+   #endif
+   const unsigned int first = getSliceStart( MPIRANK, MPISIZE );
+   const unsigned int size  = getSliceStart( MPIRANK + 1, MPISIZE ) - first;
+
+   const double beta0 = sqrt( std::real( sliceddot( size, input + first, input + first ) ) );
+   if ( beta0 == 0.0 ){
+      ClearVector( veclength, output );
+      #ifdef CHEMPS2_MPI_COMPILATION
+         delete [] counts;
+         delete [] starts;
+         delete [] gathered;
+         delete [] partial;
+      #endif
+      return 0;
    }
 
-   ////////////////////////////////////////////////////////////////////////////////////////
-   ////
-   //// Output H and O
-   ////
-   ////////////////////////////////////////////////////////////////////////////////////////
-
-   for ( int irow = 0; irow < krylovSpaceDimension; irow++ ){
-      for ( int icol = 0; icol < krylovSpaceDimension; icol++ ){
-         std::cout << krylovHamiltonian[ irow +  icol * krylovSpaceDimension ] << " ";
+   double * alpha = new double[ maxdim ];
+   double * beta  = new double[ maxdim + 1 ]; // beta[ j ] couples v_{j-1} and v_j
+   double * T     = new double[ maxdim * maxdim ];
+   double * evals = new double[ maxdim ];
+   int lwork      = 3 * maxdim;
+   double * work  = new double[ lwork ];
+   dcomplex * coef = new dcomplex[ maxdim ];
+   beta[ 0 ] = beta0;
+
+   double error = 0.0;
+   int dim      = 0;
+   while ( dim < maxdim ){
+
+      const int j          = dim;
+      dcomplex * vj        = ( j == 0 ) ? input + first : pool[ j - 1 ];
+      const double scalej  = ( j == 0 ) ? 1.0 / beta0 : 1.0;
+      dcomplex * residual  = ( j + 1 < maxdim ) ? pool[ j ] : output + first;
+      if ( residual == NULL ){
+         pool[ j ] = new dcomplex[ size ];
+         residual  = pool[ j ];
       }
-      std::cout << std::endl;
-   }
 
-   for ( int irow = 0; irow < krylovSpaceDimension; irow++ ){
-      for ( int icol = 0; icol < krylovSpaceDimension; icol++ ){
-         std::cout << overlaps[ irow +  icol * krylovSpaceDimension ] << " ";
+      // residual = H v_j - alpha_j v_j - beta_j v_{j-1}
+      #ifdef CHEMPS2_MPI_COMPILATION
+         if ( j > 0 ){
+            FCIdcopy( size, vj, gathered + first );
+            MPIchemps2::allgather_array_complex_inplace( reinterpret_cast<double *>( gathered ), counts, starts );
+         }
+         matvec_partial( ( j == 0 ) ? input : gathered, partial );
+         MPIchemps2::reduce_scatter_array_complex( reinterpret_cast<double *>( partial ), reinterpret_cast<double *>( residual ), counts );
+      #else
+         matvec( vj, residual );
+      #endif
+      FCIdaxpy( size, getEconst(), vj, residual );
+      FCIdscal( size, scalej, residual );
+      alpha[ j ] = scalej * std::real( sliceddot( size, vj, residual ) );
+      FCIdaxpy( size, -alpha[ j ] * scalej, vj, residual );
+      if ( j > 0 ){
+         dcomplex * vprev = ( j == 1 ) ? input + first : pool[ j - 2 ];
+         FCIdaxpy( size, -beta[ j ] * ( ( j == 1 ) ? 1.0 / beta0 : 1.0 ), vprev, residual );
       }
-      std::cout << std::endl;
-   }
-
-   ////////////////////////////////////////////////////////////////////////////////////////
-   ////
-   //// Calculating the inverse
-   ////
-   ////////////////////////////////////////////////////////////////////////////////////////
-
-   int one                 = 1;
-   int sqr                 = krylovSpaceDimension * krylovSpaceDimension;
-   dcomplex * overlaps_inv = new dcomplex[ krylovSpaceDimension * krylovSpaceDimension ];
-   zcopy_( &sqr, overlaps, &one, overlaps_inv, &one );
-
-   int info_lu;
-   int * piv = new int[ krylovSpaceDimension ];
-   zgetrf_( &krylovSpaceDimension, &krylovSpaceDimension, overlaps_inv, &krylovSpaceDimension, piv, &info_lu );
-
-   dcomplex * work = new dcomplex[ krylovSpaceDimension ];
-
-   int info_inve;
-   zgetri_( &krylovSpaceDimension, overlaps_inv, &krylovSpaceDimension, piv, work, &krylovSpaceDimension, &info_inve );
 
-   ////////////////////////////////////////////////////////////////////////////////////////
-   ////
-   //// Multiplying N^-1 and H
-   ////
-   ////////////////////////////////////////////////////////////////////////////////////////
-
-   dcomplex * toExp = new dcomplex[ krylovSpaceDimension * krylovSpaceDimension ];
-   char notrans     = 'N';
-   dcomplex zeroC   = 0.0;
-   dcomplex oneC    = 1.0;
-   zgemm_( &notrans, &notrans, &krylovSpaceDimension, &krylovSpaceDimension, &krylovSpaceDimension,
-           &step, overlaps_inv, &krylovSpaceDimension, krylovHamiltonian, &krylovSpaceDimension, &zeroC, toExp, &krylovSpaceDimension );
-
-
-   //////////////////////////////////////////////////////////////////////////////////////
-   //
-   // Print out the eigen values of the matrix in the exponential
-   //
-   //////////////////////////////////////////////////////////////////////////////////////
-
-   char jobz = 'V';
-   char uplo = 'U';
-   int inc = 1;
-   int N = krylovSpaceDimension * krylovSpaceDimension;
-   int lwork = 2 * N - 1;
-   int infoE;
-
-   dcomplex * U = new dcomplex[ krylovSpaceDimension * krylovSpaceDimension ];
-   dcomplex* workE = new dcomplex[ lwork ];
-   double* evals = new double[ krylovSpaceDimension ];
-   double* rwork = new double[ 3 * N - 2 ];
-
-   zcopy_( &N, toExp, &inc, U, &inc );
-   zheev_( &jobz, &uplo, &krylovSpaceDimension, U, &krylovSpaceDimension, evals, workE, &lwork, rwork, &infoE );
-   assert( infoE == 0 );
-
-   for( int i = 0; i < krylovSpaceDimension; i++ ){
-      std::cout << evals[ i ] << std::endl;
-   }
-   delete[] workE;
-   delete[] evals;
-   delete[] rwork; 
-   delete[] U;
-
-   ////////////////////////////////////////////////////////////////////////////////////////
-   ////
-   //// Calculate the matrix exponential
-   ////
-   ////////////////////////////////////////////////////////////////////////////////////////
-
-   int deg        = 20;
-   double bla     = 1.0;
-   int lwsp       = 4 * krylovSpaceDimension * krylovSpaceDimension + deg + 1;
-   dcomplex * wsp = new dcomplex[ lwsp ];
-   int * ipiv     = new int[ krylovSpaceDimension ];
-   int iexph      = 0;
-   int ns         = 0;
-   int info;
-
-   zgpadm_( &deg, &krylovSpaceDimension, &bla, toExp, &krylovSpaceDimension,
-            wsp, &lwsp, ipiv, &iexph, &ns, &info );
-   assert( info == 0 );
-
-   dcomplex * theExp = &wsp[ iexph - 1 ];
-
-   ////////////////////////////////////////////////////////////////////////////////////////
-   ////
-   //// Test new coefficients and sum states
-   ////
-   ////////////////////////////////////////////////////////////////////////////////////////
-
-   dcomplex * result = new dcomplex[ krylovSpaceDimension ];
-   for ( int i = 0; i < krylovSpaceDimension; i++ ) {
-      result[ i ] = theExp[ i + krylovSpaceDimension * 0 ];
-   }
+      // One pass of full reorthogonalization; all Lanczos vectors are kept anyway
+      for ( int i = 0; i <= j; i++ ){
+         dcomplex * vi       = ( i == 0 ) ? input + first : pool[ i - 1 ];
+         const double scalei = ( i == 0 ) ? 1.0 / beta0 : 1.0;
+         const dcomplex ovlp = scalei * sliceddot( size, vi, residual );
+         FCIdaxpy( size, -ovlp * scalei, vi, residual );
+      }
+      beta[ j + 1 ] = sqrt( std::real( sliceddot( size, residual, residual ) ) );
+      dim++;
+
+      // coef = exp( step * T ) e_0 for the current tridiagonal T
+      for ( int cnt = 0; cnt < dim * dim; cnt++ ){ T[ cnt ] = 0.0; }
+      for ( int cnt = 0; cnt < dim; cnt++ ){
+         T[ cnt + dim * cnt ] = alpha[ cnt ];
+         if ( cnt > 0 ){
+            T[ cnt + dim * ( cnt - 1 ) ] = beta[ cnt ];
+            T[ cnt - 1 + dim * cnt ]     = beta[ cnt ];
+         }
+      }
+      char jobz = 'V';
+      char uplo = 'U';
+      int info;
+      dsyev_( &jobz, &uplo, &dim, T, &dim, evals, work, &lwork, &info );
+      assert( info == 0 );
+      for ( int row = 0; row < dim; row++ ){
+         coef[ row ] = 0.0;
+         for ( int eig = 0; eig < dim; eig++ ){
+            coef[ row ] += T[ row + dim * eig ] * std::exp( step * evals[ eig ] ) * T[ 0 + dim * eig ];
+         }
+      }
 
-   dcomplex tobeone = 0.0;
-   for( int i = 0; i < krylovSpaceDimension; i++ ){
-      for( int j = 0; j < krylovSpaceDimension; j++ ){
-         tobeone += std::conj( result[ i ] ) * result[ j ] * overlaps[ i + krylovSpaceDimension * j ];
-      }   
+      error = beta0 * beta[ dim ] * std::abs( coef[ dim - 1 ] );
+      if ( ( error < tolerance ) || ( beta[ dim ] < 1e-14 * beta0 ) ){ break; }
+      if ( dim < maxdim ){ FCIdscal( size, 1.0 / beta[ dim ], residual ); }
    }
 
-   if ( ( std::abs( tobeone - overlaps[ 0 ] ) > 1e-9 ) ) {
-      std::cout << "CHEMPS2::TIME WARNING: "
-                << " Numerical Problem with non-orthonormal Krylov basis. Is your state close to an energy eigenstate?\n";
+   if ( ( FCIverbose > 1 ) && ( error >= tolerance ) && ( beta[ dim ] >= 1e-14 * beta0 ) ){
       std::cout << "CHEMPS2::TIME WARNING: "
-                << " Norm will be off by " << std::abs( tobeone - overlaps[ 0 ] ) << " due to Krylov evolution. Should be 0.0\n";
+                << " Lanczos error estimate " << error << " exceeds the tolerance " << tolerance
+                << " with the maximum Krylov dimension " << maxdim << ".\n";
    }
 
-   for ( int i = 0; i < krylovSpaceDimension; i++ ) {
-      FCIdaxpy( veclength, theExp[ i + krylovSpaceDimension * 0 ], krylovBasisVectors[ i ], output );
+   // output = beta_0 * sum_k coef[ k ] v_k ; for k = 0 this is coef[ 0 ] * input
+   FCIdcopy( size, input + first, output + first );
+   FCIdscal( size, coef[ 0 ], output + first );
+   for ( int k = 1; k < dim; k++ ){
+      FCIdaxpy( size, beta0 * coef[ k ], pool[ k - 1 ], output + first );
    }
+   #ifdef CHEMPS2_MPI_COMPILATION
+      MPIchemps2::allgather_array_complex_inplace( reinterpret_cast<double *>( output ), counts, starts );
+      delete [] counts;
+      delete [] starts;
+      delete [] gathered;
+      delete [] partial;
+   #endif
 
-   ////////////////////////////////////////////////////////////////////////////////////////
-   ////
-   //// Delete all the allocated stuff
-   ////
-   ////////////////////////////////////////////////////////////////////////////////////////
-
-   delete[] wsp;
-   delete[] ipiv;
-   delete[] overlaps_inv;
-   delete[] toExp;
-   delete[] piv;
+   delete[] alpha;
+   delete[] beta;
+   delete[] T;
+   delete[] evals;
    delete[] work;
+   delete[] coef;
 
-   for ( int cnt = 1; cnt < krylovSpaceDimension; cnt++ ) {
-      delete[] krylovBasisVectors[ cnt ];
-   }
-   delete[] overlaps;
-   delete[] krylovHamiltonian;
-   delete[] krylovBasisVectors;
+   return dim;
+
+}
+
+dcomplex CheMPS2::CFCI::sliceddot( const unsigned int size, dcomplex * vec1, dcomplex * vec2 ){
+
+   dcomplex result = FCIddot( size, vec1, vec2 );
+   #ifdef CHEMPS2_MPI_COMPILATION
+      MPIchemps2::allreduce_array_double_inplace( reinterpret_cast<double *>( &result ), 2 );
+   #endif
+   return result;
 
 }
 
@@ -2590,53 +2680,43 @@ void CheMPS2::CFCI::getFCITensor( dcomplex * state,
                                   std::vector< std::vector< int > >& betasOut,
                                   std::vector< double >& coefsRealOut,
                                   std::vector< double >& coefsImagOut){
-   std::vector< int > alphas;
-   std::vector< int > betas;
-
-   recusion( state, L, alphas, betas, alphasOut, betasOut, coefsRealOut, coefsImagOut );
-}
 
-void CheMPS2::CFCI::recusion( dcomplex * state, int L,
-                              std::vector< int > alphas, std::vector< int > betas,
-                              std::vector< std::vector< int > > & alphasOut,
-                              std::vector< std::vector< int > > & betasOut,
-                              std::vector< double > & coefsRealOut,
-                              std::vector< double > & coefsImagOut ) {
-
-   int sumAlpha = 0;
-   int sumBeta  = 0;
-   for ( int i = 0; i < alphas.size(); i++ ) {
-      sumAlpha += alphas[ i ];
-   }
-   for ( int i = 0; i < betas.size(); i++ ) {
-      sumBeta += betas[ i ];
-   }
-   if ( sumAlpha + sumBeta > (Nel_up + Nel_down) ) {
-      return;
+   /* Stream over the FCI vector and sort the determinants in lexicographic order of the ( alpha, beta ) occupations,
+      as CheMPS2::getFCITensor does for an MPS. With orbital 0 as the most significant bit, this is the numeric order
+      of the bit-reversed strings. */
+   std::vector< std::pair< std::pair< unsigned int, unsigned int >, unsigned int > > order;
+   order.reserve( getVecLength( 0 ) );
+   for ( unsigned int irrep_up = 0; irrep_up < num_irreps; irrep_up++ ){
+      const int irrep_down        = Irreps::directProd( irrep_up, TargetIrrep );
+      const unsigned int dim_up   = numPerIrrep_up  [ irrep_up   ];
+      const unsigned int dim_down = numPerIrrep_down[ irrep_down ];
+      for ( unsigned int cnt_down = 0; cnt_down < dim_down; cnt_down++ ){
+         for ( unsigned int cnt_up = 0; cnt_up < dim_up; cnt_up++ ){
+            unsigned int key_up   = 0;
+            unsigned int key_down = 0;
+            for ( unsigned int orb = 0; orb < L; orb++ ){
+               key_up   |= ( ( cnt2str_up  [ irrep_up   ][ cnt_up   ] >> orb ) & 1U ) << ( L - 1 - orb );
+               key_down |= ( ( cnt2str_down[ irrep_down ][ cnt_down ] >> orb ) & 1U ) << ( L - 1 - orb );
+            }
+            order.push_back( std::make_pair( std::make_pair( key_up, key_down ), irrep_center_jumps[ 0 ][ irrep_up ] + cnt_up + dim_up * cnt_down ) );
+         }
+      }
    }
-
-   if ( alphas.size() == L && betas.size() == L ) {
-      if ( sumAlpha + sumBeta == Nel_up + Nel_down ) {
-         alphasOut.push_back( alphas );
-         betasOut.push_back( betas );
-         coefsRealOut.push_back( std::real( getFCIcoeff( &alphas[ 0 ], &betas[ 0 ], state ) ) );
-         coefsImagOut.push_back( std::imag( getFCIcoeff( &alphas[ 0 ], &betas[ 0 ], state ) ) );
+   std::sort( order.begin(), order.end() );
+
+   std::vector< int > alphas( L );
+   std::vector< int > betas( L );
+   for ( unsigned int det = 0; det < order.size(); det++ ){
+      for ( unsigned int orb = 0; orb < L; orb++ ){
+         alphas[ orb ] = ( order[ det ].first.first  >> ( L - 1 - orb ) ) & 1U;
+         betas [ orb ] = ( order[ det ].first.second >> ( L - 1 - orb ) ) & 1U;
       }
-   } else if ( alphas.size() == L ) {
-      std::vector< int > caseA = betas;
-      caseA.push_back( 0 );
-      recusion( state, L, alphas, caseA, alphasOut, betasOut, coefsRealOut, coefsImagOut );
-      std::vector< int > caseB = betas;
-      caseB.push_back( 1 );
-      recusion( state, L, alphas, caseB, alphasOut, betasOut, coefsRealOut, coefsImagOut );
-   } else {
-      std::vector< int > caseA = alphas;
-      caseA.push_back( 0 );
-      recusion( state, L, caseA, betas, alphasOut, betasOut, coefsRealOut, coefsImagOut );
-      std::vector< int > caseB = alphas;
-      caseB.push_back( 1 );
-      recusion( state, L, caseB, betas, alphasOut, betasOut, coefsRealOut, coefsImagOut );
+      alphasOut.push_back( alphas );
+      betasOut.push_back( betas );
+      coefsRealOut.push_back( std::real( state[ order[ det ].second ] ) );
+      coefsImagOut.push_back( std::imag( state[ order[ det ].second ] ) );
    }
+
 }
 
 // /*********************************************************************************
@@ -4,14 +4,16 @@
 #include <iostream>
 #include <math.h>
 #include <stdlib.h>
+#include <sys/time.h>
 
 #include "CHeffNS.h"
 #include "Davidson.h"
+#include "HamiltonianOperator.h"
 #include "Lapack.h"
 #include "MPIchemps2.h"
 
-CheMPS2::CHeffNS::CHeffNS( const SyBookkeeper * bk_upIn, const SyBookkeeper * bk_downIn, const Problem * ProbIn, const dcomplex offsetEnergyIn )
-    : bk_up( bk_upIn ), bk_down( bk_downIn ), Prob( ProbIn ), offsetEnergy( offsetEnergyIn ) {}
+CheMPS2::CHeffNS::CHeffNS( const SyBookkeeper * bk_upIn, const SyBookkeeper * bk_downIn, const Problem * ProbIn, const dcomplex offsetEnergyIn, double * timingsIn )
+    : bk_up( bk_upIn ), bk_down( bk_downIn ), Prob( ProbIn ), offsetEnergy( offsetEnergyIn ), timings( timingsIn ) {}
 
 CheMPS2::CHeffNS::~CHeffNS() {}
 
@@ -41,9 +43,21 @@ void CheMPS2::CHeffNS::makeHeff( CSobject * denS, CSobject * denP,
       dcomplex * temp  = new dcomplex[ DIM_up * DIM_down ];
       dcomplex * temp2 = new dcomplex[ DIM_up * DIM_down ];
 
+      // Block workspaces, allocated once per thread instead of once per ikappa
+      dcomplex * memLUxRU = new dcomplex[ DIM_up * DIM_up ];
+      dcomplex * memLUxRD = new dcomplex[ DIM_up * DIM_down ];
+      dcomplex * memLDxRU = new dcomplex[ DIM_down * DIM_up ];
+      dcomplex * memLDxRD = new dcomplex[ DIM_down * DIM_down ];
+      dcomplex * temp3    = new dcomplex[ DIM_down * DIM_up ];
+
+      // Thread times of the local, left, right, both-sided and overlap diagram classes
+      double classTimes[ 5 ] = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+      struct timeval start;
+
 #pragma omp for schedule( dynamic )
       for ( int ikappaBIS = 0; ikappaBIS < denP->gNKappa(); ikappaBIS++ ) {
 
+         gettimeofday( &start, NULL );
          const int ikappa = denP->gReorder( ikappaBIS );
 
          const int NL    = denP->gNL( ikappa );
@@ -66,11 +80,6 @@ void CheMPS2::CHeffNS::makeHeff( CSobject * denS, CSobject * denP,
          int dimLD = bk_down->gCurrentDim( theindex, NL, TwoSL, IL );
          int dimRD = bk_down->gCurrentDim( theindex + 2, NR, TwoSR, IR );
 
-         dcomplex * memLUxRU = new dcomplex[ dimLU * dimRU ];
-         dcomplex * memLUxRD = new dcomplex[ dimLU * dimRD ];
-         dcomplex * memLDxRU = new dcomplex[ dimLD * dimRU ];
-         dcomplex * memLDxRD = new dcomplex[ dimLD * dimRD ];
-
          for ( int cnt = 0; cnt < dimLD * dimRD; cnt++ ) {
             memLDxRD[ cnt ] = 0.0;
          }
@@ -80,6 +89,7 @@ void CheMPS2::CHeffNS::makeHeff( CSobject * denS, CSobject * denP,
 
          addDiagram2dall( ikappa, memLDxRD, denS, denP );
          addDiagram3Eand3H( ikappa, memLDxRD, denS, denP );
+         lap( start, classTimes[ 0 ] );
 
          if ( !atLeft ) {
             for ( int cnt = 0; cnt < dimLU * dimRD; cnt++ ) {
@@ -116,6 +126,7 @@ void CheMPS2::CHeffNS::makeHeff( CSobject * denS, CSobject * denP,
             addDiagram4D( ikappa, memLUxRD, denS, denP, Ltensors[ indexS - 1 ], LtensorsT[ indexS - 1 ], temp );
             addDiagram4I( ikappa, memLUxRD, denS, denP, Ltensors[ indexS - 1 ], LtensorsT[ indexS - 1 ], temp );
          }
+         lap( start, classTimes[ 1 ] );
 
          if ( !atRight && dimLD > 0 ) {
             for ( int cnt = 0; cnt < dimLD * dimRU; cnt++ ) {
@@ -153,6 +164,8 @@ void CheMPS2::CHeffNS::makeHeff( CSobject * denS, CSobject * denP,
             addDiagram4F( ikappa, memLDxRU, denS, denP, Ltensors[ indexS + 1 ], LtensorsT[ indexS + 1 ], temp );
             addDiagram4G( ikappa, memLDxRU, denS, denP, Ltensors[ indexS + 1 ], LtensorsT[ indexS + 1 ], temp );
          }
+         lap( start, classTimes[ 2 ] );
+
          if ( ( !atLeft ) && ( !atRight ) ) {
             for ( int cnt = 0; cnt < dimLU * dimRU; cnt++ ) {
                memLUxRU[ cnt ] = 0.0;
@@ -194,6 +207,7 @@ void CheMPS2::CHeffNS::makeHeff( CSobject * denS, CSobject * denP,
             addDiagram5E( ikappa, memLUxRU, denS, denP, Ltensors[ indexS - 1 ], LtensorsT[ indexS - 1 ], Ltensors[ indexS + 1 ], LtensorsT[ indexS + 1 ], temp, temp2 );
             addDiagram5F( ikappa, memLUxRU, denS, denP, Ltensors[ indexS - 1 ], LtensorsT[ indexS - 1 ], Ltensors[ indexS + 1 ], LtensorsT[ indexS + 1 ], temp, temp2 );
          }
+         lap( start, classTimes[ 3 ] );
 
          int dimLUxRU = dimLU * dimRU;
          int dimLDxRD = dimLD * dimRD;
@@ -238,22 +252,32 @@ void CheMPS2::CHeffNS::makeHeff( CSobject * denS, CSobject * denP,
             dcomplex * BlockOT = OtensorsR->gStorage( NR, TwoSR, IR, NR, TwoSR, IR );
             dcomplex * BlockO  = OtensorsL->gStorage( NL, TwoSL, IL, NL, TwoSL, IL );
 
-            dcomplex * temp3 = new dcomplex[ dimLD * dimRU ];
-            dcomplex zero    = 0.0;
+            dcomplex zero = 0.0;
             zgemm_( &notrans, &cotrans, &dimLD, &dimRU, &dimRD, &one, memLDxRD, &dimLD, BlockOT, &dimRU, &zero, temp3, &dimLD );
 
             zgemm_( &notrans, &notrans, &dimLU, &dimRU, &dimLD, &one, BlockO, &dimLU, temp3, &dimLD, &one, BlockP, &dimLU );
+         }
+         lap( start, classTimes[ 4 ] );
+      }
 
-            delete[] temp3;
+      if ( timings != NULL ) {
+#pragma omp critical
+         {
+            timings[ CHEMPS2_CTIME_HEFF_LOCAL ]   += classTimes[ 0 ];
+            timings[ CHEMPS2_CTIME_HEFF_LEFT ]    += classTimes[ 1 ];
+            timings[ CHEMPS2_CTIME_HEFF_RIGHT ]   += classTimes[ 2 ];
+            timings[ CHEMPS2_CTIME_HEFF_BOTH ]    += classTimes[ 3 ];
+            timings[ CHEMPS2_CTIME_HEFF_OVERLAP ] += classTimes[ 4 ];
          }
-         delete[] memLUxRU;
-         delete[] memLUxRD;
-         delete[] memLDxRU;
-         delete[] memLDxRD;
       }
 
       delete[] temp;
       delete[] temp2;
+      delete[] memLUxRU;
+      delete[] memLUxRD;
+      delete[] memLDxRU;
+      delete[] memLDxRD;
+      delete[] temp3;
    }
 }
 
@@ -270,6 +294,9 @@ void CheMPS2::CHeffNS::Apply( CSobject * denS, CSobject * denP, CTensorL *** Lte
 
    int inc1 = 1;
 
+   // Every matrix element of the effective Hamiltonian has an index on one of both sites
+   Prob->set_mxelem_window( denP->gIndex(), denP->gIndex() + 1 );
+
    // Copy content of Sobject
    denS->prog2symm(); // Convert mem of Sobject to symmetric conventions
    denP->prog2symm(); // Convert mem of Pobject to symmetric conventions
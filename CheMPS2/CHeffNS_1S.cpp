@@ -34,20 +34,59 @@ void CheMPS2::CHeffNS_1S::Apply( CTensorT * in, CTensorT * out,
    const bool atLeft  = ( index == 0 ) ? true : false;
    const bool atRight = ( index == Prob->gL() - 1 ) ? true : false;
 
+   // Every matrix element of the effective Hamiltonian has an index on the site
+   Prob->set_mxelem_window( index, index );
+
    const int DIM_up   = std::max( bk_up->gMaxDimAtBound( index ), bk_up->gMaxDimAtBound( index + 1 ) );
    const int DIM_down = std::max( bk_down->gMaxDimAtBound( index ), bk_down->gMaxDimAtBound( index + 1 ) );
 
    char cotrans = 'C';
    char notrans = 'N';
 
+   // Handle the blocks largest first, and blocks of equal shape one after the other, so that the dynamic schedule
+   // balances the threads and consecutive zgemm calls of a thread see the same operand shapes
+   const int nKappa = out->gNKappa();
+   int * reorder    = new int[ nKappa ];
+   int * sizeLU     = new int[ nKappa ];
+   int * sizeRU     = new int[ nKappa ];
+   for ( int ikappa = 0; ikappa < nKappa; ikappa++ ) {
+      reorder[ ikappa ] = ikappa;
+      sizeLU[ ikappa ]  = bk_up->gCurrentDim( index, out->gNL( ikappa ), out->gTwoSL( ikappa ), out->gIL( ikappa ) );
+      sizeRU[ ikappa ]  = bk_up->gCurrentDim( index + 1, out->gNR( ikappa ), out->gTwoSR( ikappa ), out->gIR( ikappa ) );
+   }
+   for ( int cnt = 1; cnt < nKappa; cnt++ ) { // Insertion sort on ( dimLU * dimRU, dimLU ), descending
+      const int current = reorder[ cnt ];
+      int pos           = cnt;
+      while ( pos > 0 ) {
+         const int previous = reorder[ pos - 1 ];
+         const int size1    = sizeLU[ previous ] * sizeRU[ previous ];
+         const int size2    = sizeLU[ current ] * sizeRU[ current ];
+         if ( ( size1 > size2 ) || ( ( size1 == size2 ) && ( sizeLU[ previous ] >= sizeLU[ current ] ) ) ) { break; }
+         reorder[ pos ] = previous;
+         pos--;
+      }
+      reorder[ pos ] = current;
+   }
+   delete[] sizeLU;
+   delete[] sizeRU;
+
 // PARALLEL
 #pragma omp parallel
    {
       dcomplex * temp  = new dcomplex[ DIM_up * DIM_down ];
       dcomplex * temp2 = new dcomplex[ DIM_up * DIM_down ];
 
+      // Block workspaces, allocated once per thread instead of once per ikappa
+      dcomplex * memLUxRU = new dcomplex[ DIM_up * DIM_up ];
+      dcomplex * memLUxRD = new dcomplex[ DIM_up * DIM_down ];
+      dcomplex * memLDxRU = new dcomplex[ DIM_down * DIM_up ];
+      dcomplex * memLDxRD = new dcomplex[ DIM_down * DIM_down ];
+      dcomplex * temp3    = new dcomplex[ DIM_down * DIM_up ];
+
 #pragma omp for schedule( dynamic )
-      for ( int ikappa = 0; ikappa < out->gNKappa(); ikappa++ ) {
+      for ( int ikappaBIS = 0; ikappaBIS < nKappa; ikappaBIS++ ) {
+
+         const int ikappa = reorder[ ikappaBIS ];
 
          const int NL    = out->gNL( ikappa );
          const int TwoSL = out->gTwoSL( ikappa );
@@ -67,11 +106,6 @@ void CheMPS2::CHeffNS_1S::Apply( CTensorT * in, CTensorT * out,
          int dimLD = bk_down->gCurrentDim( index, NL, TwoSL, IL );
          int dimRD = bk_down->gCurrentDim( index + 1, NR, TwoSR, IR );
 
-         dcomplex * memLUxRU = new dcomplex[ dimLU * dimRU ];
-         dcomplex * memLUxRD = new dcomplex[ dimLU * dimRD ];
-         dcomplex * memLDxRU = new dcomplex[ dimLD * dimRU ];
-         dcomplex * memLDxRD = new dcomplex[ dimLD * dimRD ];
-
          for ( int cnt = 0; cnt < dimLD * dimRD; cnt++ ) {
             memLDxRD[ cnt ] = 0.0;
          }
@@ -195,21 +229,21 @@ void CheMPS2::CHeffNS_1S::Apply( CTensorT * in, CTensorT * out,
             dcomplex * BlockOT = Otensors[ index ]->gStorage( NR, TwoSR, IR, NR, TwoSR, IR );
             dcomplex * BlockO  = Otensors[ index - 1 ]->gStorage( NL, TwoSL, IL, NL, TwoSL, IL );
 
-            dcomplex * temp3 = new dcomplex[ dimLD * dimRU ];
-            dcomplex zero    = 0.0;
+            dcomplex zero = 0.0;
             zgemm_( &notrans, &cotrans, &dimLD, &dimRU, &dimRD, &one, memLDxRD, &dimLD, BlockOT, &dimRU, &zero, temp3, &dimLD );
 
             zgemm_( &notrans, &notrans, &dimLU, &dimRU, &dimLD, &one, BlockO, &dimLU, temp3, &dimLD, &one, BlockOut, &dimLU );
-
-            delete[] temp3;
          }
-         delete[] memLUxRU;
-         delete[] memLUxRD;
-         delete[] memLDxRU;
-         delete[] memLDxRD;
       }
 
       delete[] temp;
       delete[] temp2;
+      delete[] memLUxRU;
+      delete[] memLUxRD;
+      delete[] memLDxRU;
+      delete[] memLDxRD;
+      delete[] temp3;
    }
+
+   delete[] reorder;
 }
\ No newline at end of file
@@ -0,0 +1,275 @@
+/*
+   CheMPS2: a spin-adapted implementation of DMRG for ab initio quantum chemistry
+   Copyright (C) 2013-2017 Sebastian Wouters
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+
+#include "CIonization.h"
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+#include <vector>
+
+#include "Irreps.h"
+#include "Special.h"
+#include "Wigner.h"
+
+namespace {
+
+   /* The ionized state is written down exactly. Between the leftmost and the rightmost ionized orbital, the virtual space at a boundary
+      is the direct sum of the untouched space of mpsIn and the annihilated space. The annihilated sector ( N, S, I ) contains the sectors
+      ( N + 1, S -/+ 1, I x Ip ) of mpsIn, coupled with the spin-1/2 annihilator to S, in that order. Left of the leftmost ionized orbital
+      only the untouched space remains, right of the rightmost one only the annihilated space. */
+   int untouchedDim( CheMPS2::SyBookkeeper * bkIn, const int bound, const int N, const int TwoS, const int I, const int pmax ){
+
+      return ( bound <= pmax ) ? bkIn->gCurrentDim( bound, N, TwoS, I ) : 0;
+
+   }
+
+   int annihilatedDim( CheMPS2::SyBookkeeper * bkIn, const int bound, const int N, const int I, const int Ip, const int TwoJ, const int pmin ){
+
+      if (( bound <= pmin ) || ( TwoJ < 0 )){ return 0; }
+      return bkIn->gCurrentDim( bound, N + 1, TwoJ, CheMPS2::Irreps::directProd( I, Ip ) );
+
+   }
+
+   int annihilatedOffset( CheMPS2::SyBookkeeper * bkIn, const int bound, const int N, const int TwoS, const int I, const int Ip, const int TwoJ, const int pmin, const int pmax ){
+
+      int offset = untouchedDim( bkIn, bound, N, TwoS, I, pmax );
+      if ( TwoJ == TwoS + 1 ){ offset += annihilatedDim( bkIn, bound, N, I, Ip, TwoS - 1, pmin ); }
+      return offset;
+
+   }
+
+   void addBlock( dcomplex * out, const int dimLout, const int offL, const int offR, dcomplex * in, const int dimL, const int dimR, const dcomplex factor ){
+
+      for ( int r = 0; r < dimR; r++ ){
+         for ( int l = 0; l < dimL; l++ ){
+            out[ offL + l + dimLout * ( offR + r ) ] += factor * in[ l + dimL * r ];
+         }
+      }
+
+   }
+
+   /* Sweep from left to right with QR decompositions, and truncate the virtual dimension to D with SVDs back to the left */
+   void recompress( const int D, CheMPS2::CTensorT ** mps, CheMPS2::SyBookkeeper * bk ){
+
+      const int L = bk->gL();
+
+      for ( int site = 0; site < L - 1; site++ ){
+         CheMPS2::left_normalize( mps[ site ], mps[ site + 1 ] );
+      }
+
+      for ( int site = L - 1; site > 0; site-- ){
+         CheMPS2::SyBookkeeper * bkOld = new CheMPS2::SyBookkeeper( *bk );
+         CheMPS2::CTensorT * oldLeft   = new CheMPS2::CTensorT( site - 1, bkOld );
+         CheMPS2::CTensorT * oldRight  = new CheMPS2::CTensorT( site, bkOld );
+         oldLeft->Clear();
+         oldRight->Clear();
+         oldLeft->add( mps[ site - 1 ] );
+         oldRight->add( mps[ site ] );
+
+         CheMPS2::decomposeMovingLeft( true, D, 0.0, oldLeft, bkOld, oldRight, bkOld, mps[ site - 1 ], bk, mps[ site ], bk );
+
+         delete oldLeft;
+         delete oldRight;
+         delete bkOld;
+      }
+
+   }
+
+}
+
+/* Construct mpsOut = sum_k coefs[ k ] sum_sigma a^+_{L sigma} a_{positions[ k ] sigma} mpsIn exactly, where L is the continuum orbital
+   appended to mpsIn. The orbitals and coefficients are the hopping terms in the Hamiltonian of probOut. Each site tensor follows from the
+   one of mpsIn with a 6j recoupling of the annihilator, the sign ( -1 )^NL of the annihilator moving past the electrons to the left of the
+   ionized orbital, and the singlet coupling with the created electron at the continuum orbital. When D > 0, the exact state is recompressed
+   with SVDs to at most D. The ground state mpsIn and bkIn are only read, so that several ionizations can be constructed concurrently. */
+void CheMPS2::applyAnnihilator( CTensorT ** mpsIn, SyBookkeeper * bkIn, CTensorT ** mpsOut, SyBookkeeper * bkOut, Problem * probOut, const int D ){
+
+   const int L = bkIn->gL();
+   assert( ( L + 1 ) == bkOut->gL() );
+
+   const CheMPS2::Hamiltonian * hamION = probOut->gHamil();
+   const int Ip = hamION->getOrbitalIrrep( L );
+
+   double * coefs = new double[ L ];
+   int pmin = L;
+   int pmax = -1;
+   for ( int site = 0; site < L; site++ ){
+      coefs[ site ] = ( hamION->getOrbitalIrrep( site ) == Ip ) ? hamION->getTmat( site, L ) : 0.0;
+      if ( coefs[ site ] != 0.0 ){
+         pmin = std::min( pmin, site );
+         pmax = std::max( pmax, site );
+      }
+   }
+   assert( pmax >= 0 );
+
+   // The virtual dimensions of the exact ionized state; sectors which cannot reach the ionized target are dropped by the bookkeeper
+   for ( int bound = 0; bound <= L; bound++ ){
+      for ( int N = bkOut->gNmin( bound ); N <= bkOut->gNmax( bound ); N++ ){
+         for ( int TwoS = bkOut->gTwoSmin( bound, N ); TwoS <= bkOut->gTwoSmax( bound, N ); TwoS += 2 ){
+            for ( int I = 0; I < bkOut->getNumberOfIrreps(); I++ ){
+               const int dim = untouchedDim( bkIn, bound, N, TwoS, I, pmax )
+                             + annihilatedDim( bkIn, bound, N, I, Ip, TwoS - 1, pmin )
+                             + annihilatedDim( bkIn, bound, N, I, Ip, TwoS + 1, pmin );
+               bkOut->SetDim( bound, N, TwoS, I, dim );
+            }
+         }
+      }
+   }
+
+   for ( int site = 0; site <= L; site++ ){
+      mpsOut[ site ]->Reset();
+      mpsOut[ site ]->Clear();
+   }
+
+   for ( int site = 0; site < L; site++ ){
+      for ( int ikappa = 0; ikappa < mpsOut[ site ]->gNKappa(); ikappa++ ){
+         const int NL    = mpsOut[ site ]->gNL( ikappa );
+         const int TwoSL = mpsOut[ site ]->gTwoSL( ikappa );
+         const int IL    = mpsOut[ site ]->gIL( ikappa );
+         const int NR    = mpsOut[ site ]->gNR( ikappa );
+         const int TwoSR = mpsOut[ site ]->gTwoSR( ikappa );
+         const int IR    = mpsOut[ site ]->gIR( ikappa );
+         const int TwoS  = ( ( NR == NL + 1 ) ? 1 : 0 );
+
+         const int dimLout = bkOut->gCurrentDim( site, NL, TwoSL, IL );
+         dcomplex * out    = mpsOut[ site ]->gStorage() + mpsOut[ site ]->gKappa2index( ikappa );
+
+         // Untouched --> untouched
+         if ( site + 1 <= pmax ){
+            dcomplex * in = mpsIn[ site ]->gStorage( NL, TwoSL, IL, NR, TwoSR, IR );
+            if ( in != NULL ){
+               addBlock( out, dimLout, 0, 0, in, bkIn->gCurrentDim( site, NL, TwoSL, IL ), bkIn->gCurrentDim( site + 1, NR, TwoSR, IR ), 1.0 );
+            }
+         }
+
+         // Annihilated --> annihilated: recouple the annihilator past the site
+         if ( site > pmin ){
+            for ( int TwoJL = TwoSL - 1; TwoJL <= TwoSL + 1; TwoJL += 2 ){
+               for ( int TwoJR = TwoSR - 1; TwoJR <= TwoSR + 1; TwoJR += 2 ){
+                  if (( TwoJL >= 0 ) && ( TwoJR >= 0 )){
+                     const int ILin = CheMPS2::Irreps::directProd( IL, Ip );
+                     const int IRin = CheMPS2::Irreps::directProd( IR, Ip );
+                     dcomplex * in  = mpsIn[ site ]->gStorage( NL + 1, TwoJL, ILin, NR + 1, TwoJR, IRin );
+                     if ( in != NULL ){
+                        const double factor = CheMPS2::Special::phase( TwoS + 1 + TwoJR + TwoSL )
+                                            * sqrt( ( TwoJR + 1.0 ) * ( TwoSL + 1 ) )
+                                            * CheMPS2::Wigner::wigner6j( TwoJL, TwoS, TwoJR, TwoSR, 1, TwoSL );
+                        addBlock( out, dimLout,
+                                  annihilatedOffset( bkIn, site,     NL, TwoSL, IL, Ip, TwoJL, pmin, pmax ),
+                                  annihilatedOffset( bkIn, site + 1, NR, TwoSR, IR, Ip, TwoJR, pmin, pmax ),
+                                  in, bkIn->gCurrentDim( site, NL + 1, TwoJL, ILin ), bkIn->gCurrentDim( site + 1, NR + 1, TwoJR, IRin ), factor );
+                     }
+                  }
+               }
+            }
+         }
+
+         // Untouched --> annihilated: the annihilator acts on the site
+         if (( coefs[ site ] != 0.0 ) && ( NR < NL + 2 )){
+            const int TwoSin = ( ( NR == NL ) ? 1 : 0 );
+            const double red = ( ( NR == NL ) ? -sqrt( 2.0 ) : -1.0 ); // < s - 1/2 || a || s >
+            for ( int TwoJR = TwoSR - 1; TwoJR <= TwoSR + 1; TwoJR += 2 ){
+               if ( TwoJR >= 0 ){
+                  const int IRin = CheMPS2::Irreps::directProd( IR, Ip );
+                  dcomplex * in  = mpsIn[ site ]->gStorage( NL, TwoSL, IL, NR + 1, TwoJR, IRin );
+                  if ( in != NULL ){
+                     const double factor = coefs[ site ] * red
+                                         * CheMPS2::Special::phase( 2 * NL + TwoSL + TwoSin + 1 + TwoSR )
+                                         * sqrt( ( TwoJR + 1.0 ) * ( TwoS + 1 ) )
+                                         * CheMPS2::Wigner::wigner6j( TwoSL, TwoSin, TwoJR, 1, TwoSR, TwoS );
+                     addBlock( out, dimLout, 0,
+                               annihilatedOffset( bkIn, site + 1, NR, TwoSR, IR, Ip, TwoJR, pmin, pmax ),
+                               in, bkIn->gCurrentDim( site, NL, TwoSL, IL ), bkIn->gCurrentDim( site + 1, NR + 1, TwoJR, IRin ), factor );
+                  }
+               }
+            }
+         }
+      }
+   }
+
+   // The continuum orbital: couple the created electron with the annihilated sector to the spin of mpsIn
+   for ( int ikappa = 0; ikappa < mpsOut[ L ]->gNKappa(); ikappa++ ){
+      const int NL    = mpsOut[ L ]->gNL( ikappa );
+      const int TwoSL = mpsOut[ L ]->gTwoSL( ikappa );
+      const int IL    = mpsOut[ L ]->gIL( ikappa );
+      const int TwoSR = mpsOut[ L ]->gTwoSR( ikappa );
+      assert( mpsOut[ L ]->gNR( ikappa ) == NL + 1 );
+
+      const int ILin = CheMPS2::Irreps::directProd( IL, Ip );
+      if ( bkIn->gCurrentDim( L, NL + 1, TwoSR, ILin ) > 0 ){
+         dcomplex * out = mpsOut[ L ]->gStorage() + mpsOut[ L ]->gKappa2index( ikappa );
+         out[ annihilatedOffset( bkIn, L, NL, TwoSL, IL, Ip, TwoSR, pmin, pmax ) ] = CheMPS2::Special::phase( 2 * ( NL + 1 ) + TwoSL + 1 - TwoSR )
+                                                                                  * sqrt( ( TwoSL + 1.0 ) / ( TwoSR + 1 ) );
+      }
+   }
+
+   delete[] coefs;
+
+   if ( D > 0 ){ recompress( D, mpsOut, bkOut ); }
+
+}
+
+
+/* The Hamiltonian for the annihilator sum_k coefs[ k ] a_{ positions[ k ] }: an extra continuum orbital with the irrep of the
+   ionized orbitals, and only the hopping terms coefs[ k ] between the ionized orbitals and the continuum orbital */
+CheMPS2::Hamiltonian * CheMPS2::ionizationHamiltonian( const Hamiltonian * ham, const int group, const int numPositions, const int * positions, const double * coefs ){
+
+   const int L = ham->getL();
+
+   std::vector<int> irrepsparsed;
+   for( int i = 0; i < L; i++ ) { irrepsparsed.push_back( ham->getOrbitalIrrep( i ) ); }
+   irrepsparsed.push_back( irrepsparsed[ positions[ 0 ] ] );
+
+   CheMPS2::Hamiltonian * hamION = new CheMPS2::Hamiltonian( L + 1, group, &irrepsparsed[ 0 ] );
+   for ( int k = 0; k < numPositions; k++ ){ hamION->setTmat( positions[ k ], L, coefs[ k ] ); }
+
+   return hamION;
+
+}
+
+// The ionized problem, in which the continuum orbital is occupied by exactly one electron. The electron hops between orbitals of the same
+// irrep, so the ionized state keeps the irrep of the ground state.
+CheMPS2::Problem * CheMPS2::ionizationProblem( const Hamiltonian * hamION, const int two_s, const int nelec, const int irrep ){
+
+   const int L = hamION->getL() - 1;
+
+   CheMPS2::Problem * probION = new CheMPS2::Problem( hamION, two_s, nelec, irrep );
+   probION->construct_mxelem();
+
+   int* nmax = new int [ L + 1 ];
+   int* nmin = new int [ L + 1 ];
+
+   for(int i = 0; i < L; i++)
+   {
+      nmax[ i ] = 2;
+      nmin[ i ] = 0;
+   }
+   nmax[ L ] = 1;
+   nmin[ L ] = 1;
+
+   probION->setup_occu_max( nmax );
+   probION->setup_occu_min( nmin );
+
+   delete[] nmax;
+   delete[] nmin;
+
+   return probION;
+
+}
@@ -0,0 +1,207 @@
+/*
+   CheMPS2: a spin-adapted implementation of DMRG for ab initio quantum chemistry
+   Copyright (C) 2013-2017 Sebastian Wouters
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "CMPSio.h"
+#include <algorithm>
+#include <assert.h>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "hdf5_hl.h"
+
+namespace {
+
+   int numberOfSectors( CheMPS2::SyBookkeeper * bk ) {
+      int num = 0;
+      for ( int bound = 0; bound <= bk->gL(); bound++ ) {
+         for ( int N = bk->gNmin( bound ); N <= bk->gNmax( bound ); N++ ) {
+            for ( int TwoS = bk->gTwoSmin( bound, N ); TwoS <= bk->gTwoSmax( bound, N ); TwoS += 2 ) {
+               num += bk->getNumberOfIrreps();
+            }
+         }
+      }
+      return num;
+   }
+
+   void loadDIMold( const hid_t file_id, CheMPS2::SyBookkeeper * bk ) {
+      for ( int bound = 0; bound <= bk->gL(); bound++ ) {
+         for ( int N = bk->gNmin( bound ); N <= bk->gNmax( bound ); N++ ) {
+            for ( int TwoS = bk->gTwoSmin( bound, N ); TwoS <= bk->gTwoSmax( bound, N ); TwoS += 2 ) {
+               for ( int Irrep = 0; Irrep < bk->getNumberOfIrreps(); Irrep++ ) {
+                  std::stringstream sstream;
+                  sstream << "/VirtDim_" << bound << "_" << N << "_" << TwoS << "_" << Irrep;
+                  const hid_t group_id   = H5Gopen( file_id, sstream.str().c_str(), H5P_DEFAULT );
+                  const hid_t dataset_id = H5Dopen( group_id, "Value", H5P_DEFAULT );
+                  int toRead;
+                  H5Dread( dataset_id, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, &toRead );
+                  bk->SetDim( bound, N, TwoS, Irrep, toRead );
+                  H5Dclose( dataset_id );
+                  H5Gclose( group_id );
+               }
+            }
+         }
+      }
+   }
+
+   void loadMPSold( const hid_t file_id, const int L, CheMPS2::CTensorT ** mps ) {
+      for ( int site = 0; site < L; site++ ) {
+         std::stringstream sstream;
+         sstream << "/MPS_" << site;
+         const hid_t group_id   = H5Gopen( file_id, sstream.str().c_str(), H5P_DEFAULT );
+         const hid_t dataset_id = H5Dopen( group_id, "Values", H5P_DEFAULT );
+         H5Dread( dataset_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, mps[ site ]->gStorage() );
+         H5Dclose( dataset_id );
+         H5Gclose( group_id );
+      }
+   }
+
+}
+
+void CheMPS2::writePackedMPS( const hid_t groupID, CTensorT ** mps, SyBookkeeper * bk, const int deflate ) {
+
+   const int L = bk->gL();
+
+   std::vector< int > dims;
+   dims.reserve( numberOfSectors( bk ) );
+   for ( int bound = 0; bound <= L; bound++ ) {
+      for ( int N = bk->gNmin( bound ); N <= bk->gNmax( bound ); N++ ) {
+         for ( int TwoS = bk->gTwoSmin( bound, N ); TwoS <= bk->gTwoSmax( bound, N ); TwoS += 2 ) {
+            for ( int Irrep = 0; Irrep < bk->getNumberOfIrreps(); Irrep++ ) {
+               dims.push_back( bk->gCurrentDim( bound, N, TwoS, Irrep ) );
+            }
+         }
+      }
+   }
+   const hsize_t numDims = dims.size();
+   H5LTmake_dataset( groupID, "VirtDims", 1, &numDims, H5T_STD_I32LE, &dims[ 0 ] );
+
+   std::vector< long long > offsets( L + 1, 0 );
+   for ( int site = 0; site < L; site++ ) {
+      offsets[ site + 1 ] = offsets[ site ] + 2 * ( long long ) mps[ site ]->gKappa2index( mps[ site ]->gNKappa() );
+   }
+   const hsize_t numOffsets = L + 1;
+   H5LTmake_dataset( groupID, "Offsets", 1, &numOffsets, H5T_STD_I64LE, &offsets[ 0 ] );
+
+   // The site tensors are written one by one into a single dataset, so no copy of the whole MPS is made
+   const hsize_t total = std::max( offsets[ L ], ( long long ) 1 );
+   const hid_t spaceID = H5Screate_simple( 1, &total, NULL );
+   const hid_t propID  = H5Pcreate( H5P_DATASET_CREATE );
+   if ( ( deflate > 0 ) && ( H5Zfilter_avail( H5Z_FILTER_DEFLATE ) > 0 ) ) {
+      const hsize_t chunk = std::min( total, ( hsize_t ) 32768 );
+      H5Pset_chunk( propID, 1, &chunk );
+      H5Pset_shuffle( propID );
+      H5Pset_deflate( propID, deflate );
+   }
+   const hid_t datasetID = H5Dcreate( groupID, "Storage", H5T_IEEE_F64LE, spaceID, H5P_DEFAULT, propID, H5P_DEFAULT );
+   for ( int site = 0; site < L; site++ ) {
+      const hsize_t start = offsets[ site ];
+      const hsize_t size  = offsets[ site + 1 ] - offsets[ site ];
+      if ( size > 0 ) {
+         const hid_t memSpaceID = H5Screate_simple( 1, &size, NULL );
+         H5Sselect_hyperslab( spaceID, H5S_SELECT_SET, &start, NULL, &size, NULL );
+         H5Dwrite( datasetID, H5T_NATIVE_DOUBLE, memSpaceID, spaceID, H5P_DEFAULT, mps[ site ]->gStorage() );
+         H5Sclose( memSpaceID );
+      }
+   }
+   H5Dclose( datasetID );
+   H5Pclose( propID );
+   H5Sclose( spaceID );
+}
+
+bool CheMPS2::readPackedDIM( const hid_t groupID, SyBookkeeper * bk ) {
+
+   if ( H5Lexists( groupID, "VirtDims", H5P_DEFAULT ) <= 0 ) { return false; }
+
+   hsize_t numDims = 0;
+   H5LTget_dataset_info( groupID, "VirtDims", &numDims, NULL, NULL );
+   if ( numDims != ( hsize_t ) numberOfSectors( bk ) ) { return false; }
+
+   std::vector< int > dims( numDims );
+   H5LTread_dataset_int( groupID, "VirtDims", &dims[ 0 ] );
+
+   int count = 0;
+   for ( int bound = 0; bound <= bk->gL(); bound++ ) {
+      for ( int N = bk->gNmin( bound ); N <= bk->gNmax( bound ); N++ ) {
+         for ( int TwoS = bk->gTwoSmin( bound, N ); TwoS <= bk->gTwoSmax( bound, N ); TwoS += 2 ) {
+            for ( int Irrep = 0; Irrep < bk->getNumberOfIrreps(); Irrep++ ) {
+               bk->SetDim( bound, N, TwoS, Irrep, dims[ count ] );
+               count++;
+            }
+         }
+      }
+   }
+   return true;
+}
+
+void CheMPS2::readPackedMPS( const hid_t groupID, const int L, CTensorT ** mps ) {
+
+   std::vector< long long > offsets( L + 1 );
+   hsize_t numOffsets = 0;
+   H5LTget_dataset_info( groupID, "Offsets", &numOffsets, NULL, NULL );
+   assert( numOffsets == ( hsize_t ) ( L + 1 ) );
+   H5LTread_dataset( groupID, "Offsets", H5T_NATIVE_LLONG, &offsets[ 0 ] );
+
+   const hid_t datasetID = H5Dopen( groupID, "Storage", H5P_DEFAULT );
+   const hid_t spaceID   = H5Dget_space( datasetID );
+   for ( int site = 0; site < L; site++ ) {
+      const hsize_t start = offsets[ site ];
+      const hsize_t size  = offsets[ site + 1 ] - offsets[ site ];
+      assert( size == 2 * ( hsize_t ) mps[ site ]->gKappa2index( mps[ site ]->gNKappa() ) );
+      if ( size > 0 ) {
+         const hid_t memSpaceID = H5Screate_simple( 1, &size, NULL );
+         H5Sselect_hyperslab( spaceID, H5S_SELECT_SET, &start, NULL, &size, NULL );
+         H5Dread( datasetID, H5T_NATIVE_DOUBLE, memSpaceID, spaceID, H5P_DEFAULT, mps[ site ]->gStorage() );
+         H5Sclose( memSpaceID );
+      }
+   }
+   H5Sclose( spaceID );
+   H5Dclose( datasetID );
+}
+
+void CheMPS2::saveMPS( const std::string name, CTensorT ** mps, SyBookkeeper * bk, const int deflate ) {
+
+   const hid_t file_id = H5Fcreate( name.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT );
+   writePackedMPS( file_id, mps, bk, deflate );
+   H5Fclose( file_id );
+}
+
+void CheMPS2::loadDIM( const std::string name, SyBookkeeper * bk ) {
+
+   const hid_t file_id = H5Fopen( name.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT );
+   if ( H5Lexists( file_id, "VirtDims", H5P_DEFAULT ) > 0 ) {
+      const bool success = readPackedDIM( file_id, bk );
+      if ( success == false ) { std::cerr << "The MPS in " << name << " does not match the symmetry sectors of the problem!" << std::endl; }
+      assert( success );
+   } else {
+      loadDIMold( file_id, bk );
+   }
+   H5Fclose( file_id );
+}
+
+void CheMPS2::loadMPS( const std::string name, const int L, CTensorT ** mps ) {
+
+   const hid_t file_id = H5Fopen( name.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT );
+   if ( H5Lexists( file_id, "Storage", H5P_DEFAULT ) > 0 ) {
+      readPackedMPS( file_id, L, mps );
+   } else {
+      loadMPSold( file_id, L, mps );
+   }
+   H5Fclose( file_id );
+}
@@ -110,6 +110,7 @@ CheMPS2::CSobject::CSobject( const int index, CheMPS2::SyBookkeeper * denBK )
       reorder[ cnt ] = cnt;
    }
    bool sorted = false;
+   // Blocks of equal size are ordered by their left dimension, so that equally shaped blocks are consecutive
    while ( sorted == false ) { // Bubble sort so that blocksize(reorder[i]) >= blocksize(reorder[i+1]), with blocksize(k) = kappa2index[k+1]-kappa2index[k]
       sorted = true;
       for ( int cnt = 0; cnt < nKappa - 1; cnt++ ) {
@@ -117,7 +118,9 @@ CheMPS2::CSobject::CSobject( const int index, CheMPS2::SyBookkeeper * denBK )
          const int index2 = reorder[ cnt + 1 ];
          const int size1  = kappa2index[ index1 + 1 ] - kappa2index[ index1 ];
          const int size2  = kappa2index[ index2 + 1 ] - kappa2index[ index2 ];
-         if ( size1 < size2 ) {
+         const int dimL1  = denBK->gCurrentDim( index, sectorNL[ index1 ], sectorTwoSL[ index1 ], sectorIL[ index1 ] );
+         const int dimL2  = denBK->gCurrentDim( index, sectorNL[ index2 ], sectorTwoSL[ index2 ], sectorIL[ index2 ] );
+         if ( ( size1 < size2 ) || ( ( size1 == size2 ) && ( dimL1 < dimL2 ) ) ) {
             sorted             = false;
             reorder[ cnt ]     = index2;
             reorder[ cnt + 1 ] = index1;
@@ -64,19 +64,26 @@ void CheMPS2::CSubSpaceExpander::ApplyRight( CTensorT * in, CTensorT * out,
    const bool atLeft  = ( index == 0 ) ? true : false;
    const bool atRight = ( index == prob->gL() - 1 ) ? true : false;
 
+   // Every matrix element of the effective Hamiltonian has an index on the site
+   prob->set_mxelem_window( index, index );
+
    const int DIM_up   = std::max( initBKUp->gMaxDimAtBound( index ), initBKUp->gMaxDimAtBound( index + 1 ) );
    const int DIM_down = std::max( std::max( initBKDown->gMaxDimAtBound( index ), initBKDown->gMaxDimAtBound( index + 1 ) ), std::max( sseBKDown->gMaxDimAtBound( index ), sseBKDown->gMaxDimAtBound( index + 1 ) ) );
 
    char cotrans = 'C';
    char notrans = 'N';
 
-   // // PARALLEL
-   // #pragma omp parallel
+// PARALLEL
+#pragma omp parallel
    {
       dcomplex * temp  = new dcomplex[ DIM_up * DIM_down ];
       dcomplex * temp2 = new dcomplex[ DIM_up * DIM_down ];
 
-      // #pragma omp for schedule( dynamic )
+      // Block workspaces, allocated once per thread instead of once per ikappa
+      dcomplex * memLUxRD = new dcomplex[ DIM_up * DIM_down ];
+      dcomplex * memLDxRD = new dcomplex[ DIM_down * DIM_down ];
+
+#pragma omp for schedule( dynamic )
       for ( int ikappa = 0; ikappa < out->gNKappa(); ikappa++ ) {
 
          const int NL    = out->gNL( ikappa );
@@ -87,16 +94,10 @@ void CheMPS2::CSubSpaceExpander::ApplyRight( CTensorT * in, CTensorT * out,
          const int TwoSR = out->gTwoSR( ikappa );
          const int IR    = out->gIR( ikappa );
 
-         const int N    = NR - NL;
-         const int TwoS = ( N == 1 ) ? 1 : 0;
-         const int I    = initBKUp->gIrrep( index );
-
          int dimLU = initBKUp->gCurrentDim( index, NL, TwoSL, IL );
          int dimLD = initBKDown->gCurrentDim( index, NL, TwoSL, IL );
          int dimRD = sseBKDown->gCurrentDim( index + 1, NR, TwoSR, IR );
 
-         dcomplex * memLUxRD = new dcomplex[ dimLU * dimRD ];
-         dcomplex * memLDxRD = new dcomplex[ dimLD * dimRD ];
          for ( int cnt = 0; cnt < dimLD * dimRD; cnt++ ) {
             memLDxRD[ cnt ] = 0.0;
          }
@@ -194,16 +195,13 @@ void CheMPS2::CSubSpaceExpander::ApplyRight( CTensorT * in, CTensorT * out,
             int dimLDxRU = dimLD * dimRD;
             zaxpy_( &dimLDxRU, &one, memLDxRD, &inc, BlockOut, &inc );
          }
-
-         delete[] memLUxRD;
-         delete[] memLDxRD;
       }
 
       delete[] temp;
       delete[] temp2;
+      delete[] memLUxRD;
+      delete[] memLDxRD;
    }
-   // std::cout << "out" << std::endl;
-   // std::cout << *out << std::endl;
 }
 
 void CheMPS2::CSubSpaceExpander::ApplyLeft( CTensorT * in, CTensorT * out,
@@ -223,19 +221,26 @@ void CheMPS2::CSubSpaceExpander::ApplyLeft( CTensorT * in, CTensorT * out,
    const bool atLeft  = ( index == 0 ) ? true : false;
    const bool atRight = ( index == prob->gL() - 1 ) ? true : false;
 
+   // Every matrix element of the effective Hamiltonian has an index on the site
+   prob->set_mxelem_window( index, index );
+
    const int DIM_up   = std::max( initBKUp->gMaxDimAtBound( index ), initBKUp->gMaxDimAtBound( index + 1 ) );
    const int DIM_down = std::max( std::max( initBKDown->gMaxDimAtBound( index ), initBKDown->gMaxDimAtBound( index + 1 ) ), std::max( sseBKDown->gMaxDimAtBound( index ), sseBKDown->gMaxDimAtBound( index + 1 ) ) );
 
    char cotrans = 'C';
    char notrans = 'N';
 
-   // // PARALLEL
-   // #pragma omp parallel
+// PARALLEL
+#pragma omp parallel
    {
       dcomplex * temp  = new dcomplex[ DIM_up * DIM_down ];
       dcomplex * temp2 = new dcomplex[ DIM_up * DIM_down ];
 
-      // #pragma omp for schedule( dynamic )
+      // Block workspaces, allocated once per thread instead of once per ikappa
+      dcomplex * memLDxRU = new dcomplex[ DIM_down * DIM_up ];
+      dcomplex * memLDxRD = new dcomplex[ DIM_down * DIM_down ];
+
+#pragma omp for schedule( dynamic )
       for ( int ikappa = 0; ikappa < out->gNKappa(); ikappa++ ) {
 
          const int NL    = out->gNL( ikappa );
@@ -246,16 +251,10 @@ void CheMPS2::CSubSpaceExpander::ApplyLeft( CTensorT * in, CTensorT * out,
          const int TwoSR = out->gTwoSR( ikappa );
          const int IR    = out->gIR( ikappa );
 
-         const int N    = NR - NL;
-         const int TwoS = ( N == 1 ) ? 1 : 0;
-         const int I    = initBKUp->gIrrep( index );
-
          int dimRU = initBKUp->gCurrentDim( index + 1, NR, TwoSR, IR );
          int dimRD = initBKDown->gCurrentDim( index + 1, NR, TwoSR, IR );
          int dimLD = sseBKDown->gCurrentDim( index, NL, TwoSL, IL );
 
-         dcomplex * memLDxRU = new dcomplex[ dimLD * dimRU ];
-         dcomplex * memLDxRD = new dcomplex[ dimLD * dimRD ];
          for ( int cnt = 0; cnt < dimLD * dimRD; cnt++ ) {
             memLDxRD[ cnt ] = 0.0;
          }
@@ -353,13 +352,12 @@ void CheMPS2::CSubSpaceExpander::ApplyLeft( CTensorT * in, CTensorT * out,
             dcomplex * BlockOT = Otensors[ index ]->gStorage( NR, TwoSR, IR, NR, TwoSR, IR );
             zgemm_( &notrans, &cotrans, &dimLD, &dimRU, &dimRD, &one, memLDxRD, &dimLD, BlockOT, &dimRU, &one, BlockOut, &dimLD );
          }
-
-         delete[] memLDxRU;
-         delete[] memLDxRD;
       }
 
       delete[] temp;
       delete[] temp2;
+      delete[] memLDxRU;
+      delete[] memLDxRD;
    }
 }
 
@@ -407,11 +405,11 @@ void CheMPS2::CSubSpaceExpander::AddNonExpandedToExpanded( CTensorT * expanded,
    }
 }
 
-void CheMPS2::CSubSpaceExpander::decomposeMovingLeft( bool change, int virtualdimensionD, double cut_off,
-                                                      CTensorT * expandedLeft, SyBookkeeper * expandedLeftBK,
-                                                      CTensorT * expandedRight, SyBookkeeper * expandedRightBK,
-                                                      CTensorT * newLeft, SyBookkeeper * newLeftBK,
-                                                      CTensorT * newRight, SyBookkeeper * newRightBK ) {
+double CheMPS2::CSubSpaceExpander::decomposeMovingLeft( bool change, int virtualdimensionD, double cut_off,
+                                                        CTensorT * expandedLeft, SyBookkeeper * expandedLeftBK,
+                                                        CTensorT * expandedRight, SyBookkeeper * expandedRightBK,
+                                                        CTensorT * newLeft, SyBookkeeper * newLeftBK,
+                                                        CTensorT * newRight, SyBookkeeper * newRightBK ) {
    assert( expandedLeftBK == expandedRightBK );
    assert( newLeftBK == newRightBK );
    int index = site;
@@ -685,4 +683,6 @@ void CheMPS2::CSubSpaceExpander::decomposeMovingLeft( bool change, int virtualdi
          }
       }
    }
+
+   return discardedWeight;
 }
\ No newline at end of file
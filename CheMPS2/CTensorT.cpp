@@ -699,54 +699,100 @@ std::ostream & CheMPS2::operator<<( std::ostream & os, const CheMPS2::CTensorT &
    return os;
 }
 
-void recusion( CheMPS2::Problem * prob, CheMPS2::CTensorT ** mps,
-               std::vector< int > alphas, std::vector< int > betas, int L,
-               std::vector< std::vector< int > > & alphasOut,
-               std::vector< std::vector< int > > & betasOut,
-               std::vector< double > & coefsRealOut,
-               std::vector< double > & coefsImagOut ) {
-
-   int sumAlpha = 0;
-   int sumBeta  = 0;
-   for ( int i = 0; i < alphas.size(); i++ ) {
-      sumAlpha += alphas[ i ];
-   }
-   for ( int i = 0; i < betas.size(); i++ ) {
-      sumBeta += betas[ i ];
-   }
-   if ( sumAlpha + sumBeta > prob->gN() ) {
+/* Depth-first walk over the local occupations of the DMRG sites. The partial left product of a prefix of
+   occupations is stored at depth DMRGindex and shared by all its completions. arrays/twoSs/jumps[ d ] hold
+   the row vector, the spin sectors and their offsets at boundary d. Branches without right symmetry sectors
+   (particle number, irrep or spin) or with an unreachable spin projection are not entered. */
+static void fciDepthFirst( CheMPS2::Problem * prob, CheMPS2::CTensorT ** mps, const int DMRGindex,
+                           const int NL, const int IL, const int twoSLz, const int num_SL,
+                           dcomplex ** arrays, int ** twoSs, int ** jumps, int * alpha, int * beta,
+                           std::vector< std::vector< int > > & alphasOut,
+                           std::vector< std::vector< int > > & betasOut,
+                           std::vector< double > & coefsRealOut,
+                           std::vector< double > & coefsImagOut ) {
+
+   const int L = prob->gL();
+
+   if ( DMRGindex == L ) {
+      assert( num_SL == 1 );
+      assert( twoSs[ L ][ 0 ] == prob->gTwoS() );
+      alphasOut.push_back( std::vector< int >( alpha, alpha + L ) );
+      betasOut.push_back( std::vector< int >( beta, beta + L ) );
+      coefsRealOut.push_back( std::real( arrays[ L ][ 0 ] ) );
+      coefsImagOut.push_back( std::imag( arrays[ L ][ 0 ] ) );
       return;
    }
 
-   if ( alphas.size() == L && betas.size() == L ) {
-      if ( sumAlpha + sumBeta == prob->gN() ) {
-         // for ( int i = 0; i < L; i++ ) {
-         //    std::cout << alphas[ i ] << " ";
-         // }
-         // for ( int i = 0; i < L; i++ ) {
-         //    std::cout << betas[ i ] << " ";
-         // }
-         // dcomplex coef = getFCICoefficient( prob, mps, &alphas[ 0 ], &betas[ 0 ] );
-         alphasOut.push_back( alphas );
-         betasOut.push_back( betas );
-         coefsRealOut.push_back( std::real( getFCICoefficient( prob, mps, &alphas[ 0 ], &betas[ 0 ] ) ) );
-         coefsImagOut.push_back( std::imag( getFCICoefficient( prob, mps, &alphas[ 0 ], &betas[ 0 ] ) ) );
-         // std::cout << std::real( coef ) << " " << std::imag( coef ) << std::endl;
+   const CheMPS2::SyBookkeeper * denBK = mps[ 0 ]->gBK();
+   const int HamIndex                  = ( prob->gReorder() ) ? prob->gf2( DMRGindex ) : DMRGindex;
+   const int sitesLeft                 = L - DMRGindex - 1;
+
+   const dcomplex * arrayL = arrays[ DMRGindex ];
+   const int * twoSL       = twoSs[ DMRGindex ];
+   const int * jumpL       = jumps[ DMRGindex ];
+   dcomplex * arrayR       = arrays[ DMRGindex + 1 ];
+   int * twoSR             = twoSs[ DMRGindex + 1 ];
+   int * jumpR             = jumps[ DMRGindex + 1 ];
+
+   for ( int a = 0; a <= 1; a++ ) {
+      for ( int b = 0; b <= 1; b++ ) {
+         const int Nlocal   = a + b;
+         const int twoSzloc = a - b;
+         const int NR       = NL + Nlocal;
+         const int twoSRz   = twoSLz + twoSzloc;
+         const int IR       = ( ( Nlocal == 1 ) ? ( CheMPS2::Irreps::directProd( IL, denBK->gIrrep( DMRGindex ) ) ) : IL );
+
+         if ( ( NR > prob->gN() ) || ( NR + 2 * sitesLeft < prob->gN() ) ) { continue; }
+         if ( abs( twoSRz ) - sitesLeft > prob->gTwoS() ) { continue; }
+
+         // The right symmetry sectors: the Wigner 3j symbol vanishes unless | twoSRz | <= TwoSR
+         int num_SR = 0;
+         jumpR[ 0 ] = 0;
+         const int spread = ( ( Nlocal == 1 ) ? 1 : 0 );
+         for ( int cntSL = 0; cntSL < num_SL; cntSL++ ) {
+            for ( int TwoSRattempt = twoSL[ cntSL ] - spread; TwoSRattempt <= twoSL[ cntSL ] + spread; TwoSRattempt += 2 ) {
+               bool encountered = ( TwoSRattempt < abs( twoSRz ) );
+               for ( int cntSR = 0; cntSR < num_SR; cntSR++ ) {
+                  if ( twoSR[ cntSR ] == TwoSRattempt ) { encountered = true; }
+               }
+               if ( encountered == false ) {
+                  const int dimR = denBK->gCurrentDim( DMRGindex + 1, NR, TwoSRattempt, IR );
+                  if ( dimR > 0 ) {
+                     jumpR[ num_SR + 1 ] = jumpR[ num_SR ] + dimR;
+                     twoSR[ num_SR ]     = TwoSRattempt;
+                     num_SR++;
+                  }
+               }
+            }
+         }
+         if ( num_SR == 0 ) { continue; }
+
+         for ( int count = 0; count < jumpR[ num_SR ]; count++ ) { arrayR[ count ] = 0.0; }
+
+         for ( int cntSR = 0; cntSR < num_SR; cntSR++ ) {
+            const int TwoSRvalue = twoSR[ cntSR ];
+            int dimR             = jumpR[ cntSR + 1 ] - jumpR[ cntSR ];
+            for ( int cntSL = 0; cntSL < num_SL; cntSL++ ) {
+               const int TwoSLvalue = twoSL[ cntSL ];
+               if ( abs( TwoSLvalue - TwoSRvalue ) != spread ) { continue; }
+               int dimL           = jumpL[ cntSL + 1 ] - jumpL[ cntSL ];
+               int dimFirst       = 1;
+               dcomplex * Tblock  = mps[ DMRGindex ]->gStorage( NL, TwoSLvalue, IL, NR, TwoSRvalue, IR );
+               dcomplex prefactor = sqrt( TwoSRvalue + 1 )
+                                    * CheMPS2::Wigner::wigner3j( TwoSLvalue, spread, TwoSRvalue, twoSLz, twoSzloc, -twoSRz )
+                                    * CheMPS2::Special::phase( -TwoSLvalue + spread - twoSRz );
+               dcomplex add2array = 1.0;
+               char notrans       = 'N';
+               zgemm_( &notrans, &notrans, &dimFirst, &dimR, &dimL, &prefactor, const_cast< dcomplex * >( arrayL ) + jumpL[ cntSL ], &dimFirst,
+                       Tblock, &dimL, &add2array, arrayR + jumpR[ cntSR ], &dimFirst );
+            }
+         }
+
+         alpha[ HamIndex ] = a;
+         beta[ HamIndex ]  = b;
+         fciDepthFirst( prob, mps, DMRGindex + 1, NR, IR, twoSRz, num_SR, arrays, twoSs, jumps, alpha, beta,
+                        alphasOut, betasOut, coefsRealOut, coefsImagOut );
       }
-   } else if ( alphas.size() == L ) {
-      std::vector< int > caseA = betas;
-      caseA.push_back( 0 );
-      recusion( prob, mps, alphas, caseA, L, alphasOut, betasOut, coefsRealOut, coefsImagOut );
-      std::vector< int > caseB = betas;
-      caseB.push_back( 1 );
-      recusion( prob, mps, alphas, caseB, L, alphasOut, betasOut, coefsRealOut, coefsImagOut );
-   } else {
-      std::vector< int > caseA = alphas;
-      caseA.push_back( 0 );
-      recusion( prob, mps, caseA, betas, L, alphasOut, betasOut, coefsRealOut, coefsImagOut );
-      std::vector< int > caseB = alphas;
-      caseB.push_back( 1 );
-      recusion( prob, mps, caseB, betas, L, alphasOut, betasOut, coefsRealOut, coefsImagOut );
    }
 }
 
@@ -756,24 +802,73 @@ void CheMPS2::getFCITensor( Problem * prob, CTensorT ** mps,
                             std::vector< double > & coefsRealOut,
                             std::vector< double > & coefsImagOut ) {
 
-   std::vector< int > alphas;
-   std::vector< int > betas;
+   const SyBookkeeper * denBK = mps[ 0 ]->gBK();
+   const int L                = prob->gL();
+
+   int Dmax = 1;
+   for ( int DMRGindex = 1; DMRGindex < L; DMRGindex++ ) {
+      Dmax = std::max( Dmax, denBK->gTotDimAtBound( DMRGindex ) );
+   }
 
-   recusion( prob, mps, alphas, betas, prob->gL(), alphasOut, betasOut, coefsRealOut, coefsImagOut );
+   dcomplex ** arrays = new dcomplex *[ L + 1 ];
+   int ** twoSs       = new int *[ L + 1 ];
+   int ** jumps       = new int *[ L + 1 ];
+   for ( int bound = 0; bound <= L; bound++ ) {
+      arrays[ bound ] = new dcomplex[ Dmax ];
+      twoSs[ bound ]  = new int[ Dmax ];
+      jumps[ bound ]  = new int[ Dmax + 1 ];
+   }
+   int * alpha = new int[ L ];
+   int * beta  = new int[ L ];
+
+   arrays[ 0 ][ 0 ] = 1.0;
+   twoSs[ 0 ][ 0 ]  = 0;
+   jumps[ 0 ][ 0 ]  = 0;
+   jumps[ 0 ][ 1 ]  = 1;
+
+   std::vector< std::vector< int > > alphasFound;
+   std::vector< std::vector< int > > betasFound;
+   std::vector< double > realFound;
+   std::vector< double > imagFound;
+   fciDepthFirst( prob, mps, 0, 0, 0, 0, 1, arrays, twoSs, jumps, alpha, beta, alphasFound, betasFound, realFound, imagFound );
+
+   // Return the determinants in lexicographic order of the ( alpha, beta ) strings in the Hamiltonian orbital ordering
+   std::vector< std::pair< std::vector< int >, size_t > > order;
+   for ( size_t det = 0; det < realFound.size(); det++ ) {
+      std::vector< int > key = alphasFound[ det ];
+      key.insert( key.end(), betasFound[ det ].begin(), betasFound[ det ].end() );
+      order.push_back( std::make_pair( key, det ) );
+   }
+   std::sort( order.begin(), order.end() );
+   for ( size_t det = 0; det < order.size(); det++ ) {
+      alphasOut.push_back( alphasFound[ order[ det ].second ] );
+      betasOut.push_back( betasFound[ order[ det ].second ] );
+      coefsRealOut.push_back( realFound[ order[ det ].second ] );
+      coefsImagOut.push_back( imagFound[ order[ det ].second ] );
+   }
+
+   for ( int bound = 0; bound <= L; bound++ ) {
+      delete[] arrays[ bound ];
+      delete[] twoSs[ bound ];
+      delete[] jumps[ bound ];
+   }
+   delete[] arrays;
+   delete[] twoSs;
+   delete[] jumps;
+   delete[] alpha;
+   delete[] beta;
 }
 
 void CheMPS2::printFCITensor( Problem * prob, CTensorT ** mps ) {
 
-   std::vector< int > alphas;
-   std::vector< int > betas;
    std::vector< std::vector< int > > alphasOut;
    std::vector< std::vector< int > > betasOut;
    std::vector< double > coefsRealOut;
    std::vector< double > coefsImagOut;
 
-   recusion( prob, mps, alphas, betas, prob->gL(), alphasOut, betasOut, coefsRealOut, coefsImagOut );
+   getFCITensor( prob, mps, alphasOut, betasOut, coefsRealOut, coefsImagOut );
 
-   for ( int coef = 0; coef < coefsRealOut.size(); coef++ ) {
+   for ( size_t coef = 0; coef < coefsRealOut.size(); coef++ ) {
       for ( int i = 0; i < prob->gL(); i++ ) {
          std::cout << alphasOut[ coef ][ i ] << " ";
       }
@@ -1232,11 +1327,11 @@ void CheMPS2::right_normalize( CTensorT * left_mps, CTensorT * right_mps ) {
 #endif
 }
 
-void CheMPS2::decomposeMovingLeft( bool change, int virtualdimensionD, double cut_off,
-                                   CTensorT * oldLeft, SyBookkeeper * oldLeftBK,
-                                   CTensorT * oldRight, SyBookkeeper * oldRightBK,
-                                   CTensorT * newLeft, SyBookkeeper * newLeftBK,
-                                   CTensorT * newRight, SyBookkeeper * newRightBK ) {
+double CheMPS2::decomposeMovingLeft( bool change, int virtualdimensionD, double cut_off,
+                                     CTensorT * oldLeft, SyBookkeeper * oldLeftBK,
+                                     CTensorT * oldRight, SyBookkeeper * oldRightBK,
+                                     CTensorT * newLeft, SyBookkeeper * newLeftBK,
+                                     CTensorT * newRight, SyBookkeeper * newRightBK ) {
    assert( oldLeftBK == oldRightBK );
    assert( newLeftBK == newRightBK );
    assert( oldLeft->gIndex() == newLeft->gIndex() );
@@ -1544,13 +1639,14 @@ void CheMPS2::decomposeMovingLeft( bool change, int virtualdimensionD, double cu
    // std::cout << "oooo " << newRight->gIndex() << std::endl;
    assert( newRight->CheckRightNormal() );
 
+   return discardedWeight;
 }
 
-void CheMPS2::decomposeMovingRight( bool change, int virtualdimensionD, double cut_off,
-                                    CTensorT * oldLeft, SyBookkeeper * oldLeftBK,
-                                    CTensorT * oldRight, SyBookkeeper * oldRightBK,
-                                    CTensorT * newLeft, SyBookkeeper * newLeftBK,
-                                    CTensorT * newRight, SyBookkeeper * newRightBK ) {
+double CheMPS2::decomposeMovingRight( bool change, int virtualdimensionD, double cut_off,
+                                      CTensorT * oldLeft, SyBookkeeper * oldLeftBK,
+                                      CTensorT * oldRight, SyBookkeeper * oldRightBK,
+                                      CTensorT * newLeft, SyBookkeeper * newLeftBK,
+                                      CTensorT * newRight, SyBookkeeper * newRightBK ) {
    assert( oldLeftBK == oldRightBK );
    assert( newLeftBK == newRightBK );
    assert( oldLeft->gIndex() == newLeft->gIndex() );
@@ -1853,4 +1949,6 @@ void CheMPS2::decomposeMovingRight( bool change, int virtualdimensionD, double c
    delete[] DimRs;
 
    assert( newLeft->CheckLeftNormal() );
+
+   return discardedWeight;
 }
@@ -33,6 +33,9 @@ CheMPS2::ConvergenceScheme::ConvergenceScheme( const int num_instructions ) {
    num_max_sweeps     = new int[ num_instructions ];
    noise_prefac       = new double[ num_instructions ];
    dvdson_rtol        = new double[ num_instructions ];
+   fit_tolerance      = new double[ num_instructions ];
+
+   for ( int instruction = 0; instruction < num_instructions; instruction++ ){ fit_tolerance[ instruction ] = 0.0; }
 }
 
 CheMPS2::ConvergenceScheme::~ConvergenceScheme() {
@@ -43,6 +46,7 @@ CheMPS2::ConvergenceScheme::~ConvergenceScheme() {
    delete[] num_max_sweeps;
    delete[] noise_prefac;
    delete[] dvdson_rtol;
+   delete[] fit_tolerance;
 }
 
 int CheMPS2::ConvergenceScheme::get_number() const { return num_instructions; }
@@ -92,3 +96,14 @@ int CheMPS2::ConvergenceScheme::get_max_sweeps( const int instruction ) const {
 double CheMPS2::ConvergenceScheme::get_noise_prefactor( const int instruction ) const { return noise_prefac[ instruction ]; }
 
 double CheMPS2::ConvergenceScheme::get_dvdson_rtol( const int instruction ) const { return dvdson_rtol[ instruction ]; }
+
+void CheMPS2::ConvergenceScheme::set_fit_tolerance( const int instruction, const double fit_tol ) {
+
+   assert( instruction >= 0 );
+   assert( instruction < num_instructions );
+   assert( fit_tol >= 0.0 );
+
+   fit_tolerance[ instruction ] = fit_tol;
+}
+
+double CheMPS2::ConvergenceScheme::get_fit_tolerance( const int instruction ) const { return fit_tolerance[ instruction ]; }
@@ -18,7 +18,10 @@
 */
 
 #include <iostream>
+#include <math.h>
+#include <string.h>
 #include <assert.h>
+#include <sys/time.h>
 
 #include "CHeffNS.h"
 #include "CHeffNS_1S.h"
@@ -29,6 +32,21 @@
 #include "Special.h"
 #include "Lapack.h"
 
+namespace {
+
+   // The number of complex numbers in the storage of a tensor operator
+   long long storage( const CheMPS2::CTensorOperator * tensor ) {
+      return tensor->gKappa2index( tensor->gNKappa() );
+   }
+
+}
+
+void CheMPS2::lap( struct timeval & start, double & elapsed ) {
+   struct timeval end;
+   gettimeofday( &end, NULL );
+   elapsed += ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
+   start = end;
+}
 
 CheMPS2::HamiltonianOperator::HamiltonianOperator( const Problem * probIn, dcomplex offsetIn ) : prob( probIn ), offset( offsetIn ), L( probIn->gL() ) {
 
@@ -56,9 +74,28 @@ CheMPS2::HamiltonianOperator::HamiltonianOperator( const Problem * probIn, dcomp
    Otensors    = new CTensorO *[ L - 1 ];
    isAllocated = new int[ L - 1 ];
 
+   stampUp             = new unsigned long long[ L - 1 ];
+   stampDown           = new unsigned long long[ L - 1 ];
+   stampBkUp           = new unsigned long long[ L - 1 ];
+   stampBkDown         = new unsigned long long[ L - 1 ];
+   buildCount          = new unsigned long long[ L - 1 ];
+   buildCountNeighbour = new unsigned long long[ L - 1 ];
+   buildCounter        = 0;
+   stampCanonical      = new unsigned long long[ L ];
+   stampCanonicalBk    = 0;
+
+   boundDiscarded = new double[ L + 1 ];
+   boundKept      = new int[ L + 1 ];
+
    for ( int cnt = 0; cnt < L - 1; cnt++ ) {
-      isAllocated[ cnt ] = 0;
+      isAllocated[ cnt ]         = 0;
+      stampBkUp[ cnt ]           = 0;
+      stampBkDown[ cnt ]         = 0;
+      buildCount[ cnt ]          = 0;
+      buildCountNeighbour[ cnt ] = 0;
    }
+
+   ClearProfile();
 }
 
 CheMPS2::HamiltonianOperator::~HamiltonianOperator() {
@@ -88,6 +125,46 @@ CheMPS2::HamiltonianOperator::~HamiltonianOperator() {
    delete[] Xtensors;
    delete[] Otensors;
    delete[] isAllocated;
+   delete[] stampUp;
+   delete[] stampDown;
+   delete[] stampBkUp;
+   delete[] stampBkDown;
+   delete[] buildCount;
+   delete[] buildCountNeighbour;
+   delete[] stampCanonical;
+   delete[] boundDiscarded;
+   delete[] boundKept;
+}
+
+void CheMPS2::HamiltonianOperator::ClearProfile() {
+   for ( int timecnt = 0; timecnt < CHEMPS2_CTIME_VECLENGTH; timecnt++ ) { timings[ timecnt ] = 0.0; }
+   for ( int count = 0; count < CHEMPS2_CCOUNT_VECLENGTH; count++ ) { counters[ count ] = 0; }
+   for ( int bound = 0; bound <= L; bound++ ) {
+      boundDiscarded[ bound ] = 0.0;
+      boundKept[ bound ]      = 0;
+   }
+   fitDiscarded = 0.0;
+}
+
+void CheMPS2::HamiltonianOperator::recordSplit( const int bound, const double discarded, SyBookkeeper * bk, double & sweepDiscarded ) {
+   if ( discarded > boundDiscarded[ bound ] ) { boundDiscarded[ bound ] = discarded; }
+   if ( bk->gTotDimAtBound( bound ) > boundKept[ bound ] ) { boundKept[ bound ] = bk->gTotDimAtBound( bound ); }
+   if ( discarded > sweepDiscarded ) { sweepDiscarded = discarded; }
+}
+
+void CheMPS2::HamiltonianOperator::recordFit( const int sweeps, const double lastSweepDiscarded ) {
+   counters[ CHEMPS2_CCOUNT_FITS ]++;
+   counters[ CHEMPS2_CCOUNT_SWEEPS ] += sweeps;
+   fitDiscarded += lastSweepDiscarded;
+}
+
+bool CheMPS2::HamiltonianOperator::fitConverged( CTensorT ** mps, const double tolerance, double & previousNorm ) const {
+   // The norm of the fit grows towards the norm of its projected target; the first sweep has nothing to compare with
+   if ( tolerance <= 0.0 ) { return false; }
+   const double currentNorm = norm( mps );
+   const bool converged     = ( previousNorm >= 0.0 ) && ( fabs( currentNorm - previousNorm ) <= tolerance * currentNorm );
+   previousNorm             = currentNorm;
+   return converged;
 }
 
 dcomplex CheMPS2::HamiltonianOperator::ExpectationValue( CTensorT ** mps, SyBookkeeper * bk ) {
@@ -95,7 +172,32 @@ dcomplex CheMPS2::HamiltonianOperator::ExpectationValue( CTensorT ** mps, SyBook
 }
 
 dcomplex CheMPS2::HamiltonianOperator::Overlap( CTensorT ** mpsLeft, SyBookkeeper * bkLeft, CTensorT ** mpsRight, SyBookkeeper * bkRight ) {
-   deleteAllBoundaryOperators();
+
+   /* The contraction runs in the direction in which the boundary operators are currently stored, so that the ones
+      left behind by a right-to-left sweep ( e.g. of TDVP ) are reused as well */
+   if ( isAllocated[ L - 2 ] == 2 ) {
+      for ( int cnt = L - 2; cnt >= 0; cnt-- ) {
+         updateMovingLeftSafe( cnt, mpsLeft, bkLeft, mpsRight, bkRight );
+      }
+
+      CTensorO * firstOverlap = new CTensorO( 0, false, bkLeft, bkRight );
+      firstOverlap->update_ownmem( mpsLeft[ 0 ], mpsRight[ 0 ], Otensors[ 0 ] );
+
+      CTensorX * first = new CTensorX( 0, false, bkLeft, bkRight, prob );
+      first->update( mpsLeft[ 0 ], mpsRight[ 0 ],
+                     Otensors[ 0 ],
+                     Ltensors[ 0 ], LtensorsT[ 0 ],
+                     Xtensors[ 0 ],
+                     Qtensors[ 0 ][ 0 ], QtensorsT[ 0 ][ 0 ],
+                     Atensors[ 0 ][ 0 ][ 0 ], AtensorsT[ 0 ][ 0 ][ 0 ],
+                     CtensorsT[ 0 ][ 0 ][ 0 ], DtensorsT[ 0 ][ 0 ][ 0 ] );
+      dcomplex result = first->trace() + firstOverlap->trace() * ( prob->gEconst() + offset );
+
+      delete firstOverlap;
+      delete first;
+
+      return result;
+   }
 
    for ( int cnt = 0; cnt < L - 1; cnt++ ) {
       updateMovingRightSafe( cnt, mpsLeft, bkLeft, mpsRight, bkRight );
@@ -124,7 +226,6 @@ void CheMPS2::HamiltonianOperator::SSApplyAndAdd( CTensorT ** mpsA, SyBookkeeper
                                                   int statesToAdd, dcomplex * factors, CTensorT *** states, SyBookkeeper ** bookkeepers,
                                                   CTensorT ** mpsOut, SyBookkeeper * bkOut,
                                                   ConvergenceScheme * scheme ) {
-   deleteAllBoundaryOperators();
    for ( int index = 0; index < L - 1; index++ ) {
       left_normalize( mpsOut[ index ], mpsOut[ index + 1 ] );
    }
@@ -148,8 +249,13 @@ void CheMPS2::HamiltonianOperator::SSApplyAndAdd( CTensorT ** mpsA, SyBookkeeper
       }
    }
 
+   int sweeps            = 0;
+   double sweepDiscarded = 0.0;
+   double fittedNorm     = -1.0;
    for ( int inst = 0; inst < scheme->get_number(); inst++ ){
       for ( int iswe = 0; iswe < scheme->get_max_sweeps( inst ); ++iswe ) {
+         sweeps++;
+         sweepDiscarded = 0.0;
          for ( int site = L - 1; site > 0; site-- ) {
 
             CTensorT * fromAdded = new CTensorT( site, bkOut );
@@ -168,6 +274,8 @@ void CheMPS2::HamiltonianOperator::SSApplyAndAdd( CTensorT ** mpsA, SyBookkeeper
             CTensorT * expandedRight = new CTensorT( site, subBK ); expandedRight->Clear();
 
             CTensorT * applied = new CTensorT( mpsOut[ site ] );
+            struct timeval start;
+            gettimeofday( &start, NULL );
             CHeffNS_1S * heff  = new CHeffNS_1S( bkOut, bkA, prob );
             heff->Apply( mpsA[ site ], applied,
                         Ltensors, LtensorsT,
@@ -181,6 +289,9 @@ void CheMPS2::HamiltonianOperator::SSApplyAndAdd( CTensorT ** mpsA, SyBookkeeper
                         F1tensors, F1tensorsT,
                         Qtensors, QtensorsT,
                         Xtensors, Otensors );
+            lap( start, timings[ CHEMPS2_CTIME_HEFF ] );
+            counters[ CHEMPS2_CCOUNT_HEFF ]++;
+            counters[ CHEMPS2_CCOUNT_HEFF_BLOCKS ] += applied->gNKappa();
 
             fromAdded->zaxpy( 1.0, applied );
 
@@ -191,12 +302,16 @@ void CheMPS2::HamiltonianOperator::SSApplyAndAdd( CTensorT ** mpsA, SyBookkeeper
                expandedRight->addNoise( scheme->get_noise_prefactor( inst ) );
             }
 
-            decomposeMovingLeft( true, scheme->get_D( inst ), 
+            gettimeofday( &start, NULL );
+            const double disc = decomposeMovingLeft( true, scheme->get_D( inst ), 
                                  scheme->get_cut_off( inst ),
                                  expandedLeft, subBK,
                                  expandedRight, subBK,
                                  mpsOut[ site - 1 ], bkOut,
                                  mpsOut[ site ], bkOut );
+            lap( start, timings[ CHEMPS2_CTIME_SPLIT ] );
+            counters[ CHEMPS2_CCOUNT_SPLIT ]++;
+            recordSplit( site, disc, bkOut, sweepDiscarded );
 
             delete subBK;
             delete expandedLeft;
@@ -239,6 +354,8 @@ void CheMPS2::HamiltonianOperator::SSApplyAndAdd( CTensorT ** mpsA, SyBookkeeper
             expandedRight->Clear();
 
             CTensorT * applied = new CTensorT( mpsOut[ site ] );
+            struct timeval start;
+            gettimeofday( &start, NULL );
             CHeffNS_1S * heff  = new CHeffNS_1S( bkOut, bkA, prob );
             heff->Apply( mpsA[ site ], applied,
                         Ltensors, LtensorsT,
@@ -252,6 +369,9 @@ void CheMPS2::HamiltonianOperator::SSApplyAndAdd( CTensorT ** mpsA, SyBookkeeper
                         F1tensors, F1tensorsT,
                         Qtensors, QtensorsT,
                         Xtensors, Otensors );
+            lap( start, timings[ CHEMPS2_CTIME_HEFF ] );
+            counters[ CHEMPS2_CCOUNT_HEFF ]++;
+            counters[ CHEMPS2_CCOUNT_HEFF_BLOCKS ] += applied->gNKappa();
 
             fromAdded->zaxpy( 1.0, applied );
 
@@ -262,13 +382,17 @@ void CheMPS2::HamiltonianOperator::SSApplyAndAdd( CTensorT ** mpsA, SyBookkeeper
                expandedLeft->addNoise( scheme->get_noise_prefactor( inst ) );
             }
 
-            decomposeMovingRight( true, 
+            gettimeofday( &start, NULL );
+            const double disc = decomposeMovingRight( true, 
                                  scheme->get_D( inst ), 
                                  scheme->get_cut_off( inst ),
                                  expandedLeft, subBK,
                                  expandedRight, subBK,
                                  mpsOut[ site ], bkOut,
                                  mpsOut[ site + 1 ], bkOut );
+            lap( start, timings[ CHEMPS2_CTIME_SPLIT ] );
+            counters[ CHEMPS2_CCOUNT_SPLIT ]++;
+            recordSplit( site + 1, disc, bkOut, sweepDiscarded );
 
             delete subBK;
             delete expandedLeft;
@@ -290,8 +414,10 @@ void CheMPS2::HamiltonianOperator::SSApplyAndAdd( CTensorT ** mpsA, SyBookkeeper
                }
             }
          }
+         if ( fitConverged( mpsOut, scheme->get_fit_tolerance( inst ), fittedNorm ) ) { break; }
       }
    }
+   recordFit( sweeps, sweepDiscarded );
 
    for ( int st = 0; st < statesToAdd; st++ ) {
       for ( int cnt = 0; cnt < L - 1; cnt++ ) {
@@ -306,7 +432,6 @@ void CheMPS2::HamiltonianOperator::SSSum( int statesToAdd,
                                           dcomplex * factors, CTensorT *** states, SyBookkeeper ** bookkeepers,
                                           CTensorT ** mpsOut, SyBookkeeper * bkOut,
                                           ConvergenceScheme * scheme ) {
-   deleteAllBoundaryOperators();
    for ( int index = 0; index < L - 1; index++ ) {
       left_normalize( mpsOut[ index ], mpsOut[ index + 1 ] );
    }
@@ -328,8 +453,13 @@ void CheMPS2::HamiltonianOperator::SSSum( int statesToAdd,
       }
    }
 
+   int sweeps            = 0;
+   double sweepDiscarded = 0.0;
+   double fittedNorm     = -1.0;
    for( int inst = 0; inst < scheme->get_number(); inst++ ){
       for ( int iswe = 0; iswe < scheme->get_max_sweeps( inst ); ++iswe ) {
+         sweeps++;
+         sweepDiscarded = 0.0;
          for ( int site = L - 1; site > 0; site-- ) {
 
             CTensorT * added = new CTensorT( site, bkOut );
@@ -356,13 +486,18 @@ void CheMPS2::HamiltonianOperator::SSSum( int statesToAdd,
                expandedRight->addNoise( scheme->get_noise_prefactor( inst ) );
             }
 
-            decomposeMovingLeft( true, 
+            struct timeval start;
+            gettimeofday( &start, NULL );
+            const double disc = decomposeMovingLeft( true, 
                                  scheme->get_D( inst ),
                                  scheme->get_cut_off( inst ),
                                  expandedLeft, subBK,
                                  expandedRight, subBK,
                                  mpsOut[ site - 1 ], bkOut,
                                  mpsOut[ site ], bkOut );
+            lap( start, timings[ CHEMPS2_CTIME_SPLIT ] );
+            counters[ CHEMPS2_CCOUNT_SPLIT ]++;
+            recordSplit( site, disc, bkOut, sweepDiscarded );
 
             delete subBK;
             delete expandedLeft;
@@ -406,13 +541,18 @@ void CheMPS2::HamiltonianOperator::SSSum( int statesToAdd,
                expandedLeft->addNoise( scheme->get_noise_prefactor( inst ) );
             }
 
-            decomposeMovingRight( true, 
+            struct timeval start;
+            gettimeofday( &start, NULL );
+            const double disc = decomposeMovingRight( true, 
                                   scheme->get_D( inst ), 
                                   scheme->get_cut_off( inst ),
                                   expandedLeft, subBK,
                                   expandedRight, subBK,
                                   mpsOut[ site ], bkOut,
                                   mpsOut[ site + 1 ], bkOut );
+            lap( start, timings[ CHEMPS2_CTIME_SPLIT ] );
+            counters[ CHEMPS2_CCOUNT_SPLIT ]++;
+            recordSplit( site + 1, disc, bkOut, sweepDiscarded );
 
             delete subBK;
             delete expandedLeft;
@@ -430,8 +570,10 @@ void CheMPS2::HamiltonianOperator::SSSum( int statesToAdd,
                }
             }
          }
+         if ( fitConverged( mpsOut, scheme->get_fit_tolerance( inst ), fittedNorm ) ) { break; }
       }
    }
+   recordFit( sweeps, sweepDiscarded );
 
    for ( int st = 0; st < statesToAdd; st++ ) {
       for ( int cnt = 0; cnt < L - 1; cnt++ ) {
@@ -440,7 +582,6 @@ void CheMPS2::HamiltonianOperator::SSSum( int statesToAdd,
       delete[] overlaps[ st ];
    }
    delete[] overlaps;
-   deleteAllBoundaryOperators();
 }
 
 void CheMPS2::HamiltonianOperator::SSOrthogonalize( int statesToOrtho,
@@ -450,7 +591,6 @@ void CheMPS2::HamiltonianOperator::SSOrthogonalize( int statesToOrtho,
                                                     ConvergenceScheme * scheme ){
 
 
-   deleteAllBoundaryOperators();
    for ( int index = 0; index < L - 1; index++ ) {
       left_normalize( mpsOut[ index ], mpsOut[ index + 1 ] );
    }
@@ -665,8 +805,9 @@ void CheMPS2::HamiltonianOperator::orthogonalize( int pos, const int numStates,
 void CheMPS2::HamiltonianOperator::DSApply( CTensorT ** mpsA, SyBookkeeper * bkA,
                                             CTensorT ** mpsOut, SyBookkeeper * bkOut,
                                             ConvergenceScheme * scheme,
-                                          const double dimensionFactor ) {
-   DSApplyAndAdd( mpsA, bkA, 0, NULL, NULL, NULL, mpsOut, bkOut, scheme, dimensionFactor );
+                                            const double dimensionFactor,
+                                            const char method ) {
+   DSApplyAndAdd( mpsA, bkA, 0, NULL, NULL, NULL, mpsOut, bkOut, scheme, dimensionFactor, method );
 }
 
 void CheMPS2::HamiltonianOperator::DSApplyAndAdd( CTensorT ** mpsA, SyBookkeeper * bkA,
@@ -676,9 +817,28 @@ void CheMPS2::HamiltonianOperator::DSApplyAndAdd( CTensorT ** mpsA, SyBookkeeper
                                                   SyBookkeeper ** bookkeepers,
                                                   CTensorT ** mpsOut, SyBookkeeper * bkOut,
                                                   ConvergenceScheme * scheme,
-                                                  const double dimensionFactor ) {
+                                                  const double dimensionFactor,
+                                                  const char method ) {
+
+   assert( ( method == 'F' ) || ( method == 'S' ) || ( method == 'W' ) );
+
+   // Seed the output with the input: the first sweep then only has to add what H moves out of the bases of mpsA
+   if ( method != 'F' ) {
+      for ( int bound = 0; bound <= L; bound++ ) {
+         for ( int N = bkOut->gNmin( bound ); N <= bkOut->gNmax( bound ); N++ ) {
+            for ( int TwoS = bkOut->gTwoSmin( bound, N ); TwoS <= bkOut->gTwoSmax( bound, N ); TwoS += 2 ) {
+               for ( int Irrep = 0; Irrep < bkOut->getNumberOfIrreps(); Irrep++ ) {
+                  bkOut->SetDim( bound, N, TwoS, Irrep, bkA->gCurrentDim( bound, N, TwoS, Irrep ) );
+               }
+            }
+         }
+      }
+      for ( int index = 0; index < L; index++ ) {
+         mpsOut[ index ]->Reset();
+         mpsA[ index ]->zcopy( mpsOut[ index ] );
+      }
+   }
 
-   deleteAllBoundaryOperators();
    for ( int index = 0; index < L - 2; index++ ) {
       left_normalize( mpsOut[ index ], mpsOut[ index + 1 ] );
    }
@@ -701,8 +861,15 @@ void CheMPS2::HamiltonianOperator::DSApplyAndAdd( CTensorT ** mpsA, SyBookkeeper
       }
    }
 
-   for ( int inst = 0; inst < scheme->get_number(); inst++ ){
-      for ( int iswe = 0; iswe < scheme->get_max_sweeps( inst ); ++iswe ) {
+   const int firstInst   = ( method == 'S' ) ? scheme->get_number() - 1 : 0;
+   int sweeps            = 0;
+   double sweepDiscarded = 0.0;
+   double fittedNorm     = -1.0;
+   for ( int inst = firstInst; inst < scheme->get_number(); inst++ ){
+      const int numSweeps = ( method == 'S' ) ? 1 : scheme->get_max_sweeps( inst );
+      for ( int iswe = 0; iswe < numSweeps; ++iswe ) {
+         sweeps++;
+         sweepDiscarded = 0.0;
          for ( int site = L - 2; site > 0; site-- ) {
             CSobject * fromAdded = new CSobject( site, bkOut );
             fromAdded->Clear();
@@ -724,18 +891,27 @@ void CheMPS2::HamiltonianOperator::DSApplyAndAdd( CTensorT ** mpsA, SyBookkeeper
 
             CSobject * applied = new CSobject( site, bkOut );
 
-            CHeffNS * heff = new CHeffNS( bkOut, bkA, prob, offset );
+            struct timeval start;
+            gettimeofday( &start, NULL );
+            CHeffNS * heff = new CHeffNS( bkOut, bkA, prob, offset, timings );
             heff->Apply( in, applied, Ltensors, LtensorsT, Atensors, AtensorsT,
                         Btensors, BtensorsT, Ctensors, CtensorsT, Dtensors, DtensorsT,
                         S0tensors, S0tensorsT, S1tensors, S1tensorsT, F0tensors,
                         F0tensorsT, F1tensors, F1tensorsT, Qtensors, QtensorsT,
                         Xtensors, leftOverlapA, rightOverlapA );
+            lap( start, timings[ CHEMPS2_CTIME_HEFF ] );
+            counters[ CHEMPS2_CCOUNT_HEFF ]++;
+            counters[ CHEMPS2_CCOUNT_HEFF_BLOCKS ] += applied->gNKappa();
 
             applied->Add( 1.0, fromAdded );
             delete fromAdded;
 
             if ( scheme->get_noise_prefactor( inst ) > 0 ) { applied->addNoise( scheme->get_noise_prefactor( inst ) ); }
+            gettimeofday( &start, NULL );
             double disc = applied->Split( mpsOut[ site ], mpsOut[ site + 1 ], dimensionFactor * scheme->get_D( inst ), scheme->get_cut_off( inst ), false, true );
+            lap( start, timings[ CHEMPS2_CTIME_SPLIT ] );
+            counters[ CHEMPS2_CCOUNT_SPLIT ]++;
+            recordSplit( site + 1, disc, bkOut, sweepDiscarded );
 
             delete heff;
             delete applied;
@@ -777,19 +953,28 @@ void CheMPS2::HamiltonianOperator::DSApplyAndAdd( CTensorT ** mpsA, SyBookkeeper
             CSobject * applied = new CSobject( site, bkOut );
             applied->Clear();
 
-            CHeffNS * heff = new CHeffNS( bkOut, bkA, prob, offset );
+            struct timeval start;
+            gettimeofday( &start, NULL );
+            CHeffNS * heff = new CHeffNS( bkOut, bkA, prob, offset, timings );
             heff->Apply( in, applied, Ltensors, LtensorsT, Atensors, AtensorsT,
                         Btensors, BtensorsT, Ctensors, CtensorsT, Dtensors, DtensorsT,
                         S0tensors, S0tensorsT, S1tensors, S1tensorsT, F0tensors,
                         F0tensorsT, F1tensors, F1tensorsT, Qtensors, QtensorsT,
                         Xtensors, leftOverlapA, rightOverlapA );
+            lap( start, timings[ CHEMPS2_CTIME_HEFF ] );
+            counters[ CHEMPS2_CCOUNT_HEFF ]++;
+            counters[ CHEMPS2_CCOUNT_HEFF_BLOCKS ] += applied->gNKappa();
 
             delete heff;
 
             applied->Add( 1.0, fromAdded );
 
             if ( scheme->get_noise_prefactor( inst ) > 0 ) { applied->addNoise( scheme->get_noise_prefactor( inst ) ); }
+            gettimeofday( &start, NULL );
             double disc = applied->Split( mpsOut[ site ], mpsOut[ site + 1 ], dimensionFactor * scheme->get_D( inst ), scheme->get_cut_off( inst ), true, true );
+            lap( start, timings[ CHEMPS2_CTIME_SPLIT ] );
+            counters[ CHEMPS2_CCOUNT_SPLIT ]++;
+            recordSplit( site + 1, disc, bkOut, sweepDiscarded );
 
             delete applied;
             delete in;
@@ -808,9 +993,10 @@ void CheMPS2::HamiltonianOperator::DSApplyAndAdd( CTensorT ** mpsA, SyBookkeeper
                }
             }
          }
+         if ( fitConverged( mpsOut, scheme->get_fit_tolerance( inst ), fittedNorm ) ) { break; }
       }
    }
-
+   recordFit( sweeps, sweepDiscarded );
 
    for ( int st = 0; st < statesToAdd; st++ ) {
       for ( int cnt = 0; cnt < L - 1; cnt++ ) {
@@ -826,7 +1012,6 @@ void CheMPS2::HamiltonianOperator::DSSum( int statesToAdd,
                                           CTensorT ** mpsOut, SyBookkeeper * bkOut,
                                           ConvergenceScheme * scheme,
                                           const double dimensionFactor ) {
-   deleteAllBoundaryOperators();
 
    for ( int index = 0; index < L - 1; index++ ) {
       left_normalize( mpsOut[ index ], mpsOut[ index + 1 ] );
@@ -849,8 +1034,13 @@ void CheMPS2::HamiltonianOperator::DSSum( int statesToAdd,
       }
    }
 
+   int sweeps            = 0;
+   double sweepDiscarded = 0.0;
+   double fittedNorm     = -1.0;
    for ( int inst = 0; inst < scheme->get_number(); inst++ ){
       for ( int i = 0; i < 2 * scheme->get_max_sweeps( inst ); ++i ) {
+         sweeps++;
+         sweepDiscarded = 0.0;
          for ( int site = L - 2; site > 0; site-- ) {
 
             CSobject * added = new CSobject( site, bkOut );
@@ -864,7 +1054,12 @@ void CheMPS2::HamiltonianOperator::DSSum( int statesToAdd,
                delete add;
             }
             if ( scheme->get_noise_prefactor( inst ) > 0 ) { added->addNoise( scheme->get_noise_prefactor( inst ) ); }
-            added->Split( mpsOut[ site ], mpsOut[ site + 1 ], dimensionFactor * scheme->get_D( inst ), scheme->get_cut_off( inst ), false, true );
+            struct timeval start;
+            gettimeofday( &start, NULL );
+            const double disc = added->Split( mpsOut[ site ], mpsOut[ site + 1 ], dimensionFactor * scheme->get_D( inst ), scheme->get_cut_off( inst ), false, true );
+            lap( start, timings[ CHEMPS2_CTIME_SPLIT ] );
+            counters[ CHEMPS2_CCOUNT_SPLIT ]++;
+            recordSplit( site + 1, disc, bkOut, sweepDiscarded );
             delete added;
 
             // Otensors
@@ -892,7 +1087,12 @@ void CheMPS2::HamiltonianOperator::DSSum( int statesToAdd,
             }
 
             if ( scheme->get_noise_prefactor( inst ) > 0 ) { added->addNoise( scheme->get_noise_prefactor( inst ) ); }
-            added->Split( mpsOut[ site ], mpsOut[ site + 1 ], dimensionFactor * scheme->get_D( inst ), scheme->get_cut_off( inst ), true, true );
+            struct timeval start;
+            gettimeofday( &start, NULL );
+            const double disc = added->Split( mpsOut[ site ], mpsOut[ site + 1 ], dimensionFactor * scheme->get_D( inst ), scheme->get_cut_off( inst ), true, true );
+            lap( start, timings[ CHEMPS2_CTIME_SPLIT ] );
+            counters[ CHEMPS2_CCOUNT_SPLIT ]++;
+            recordSplit( site + 1, disc, bkOut, sweepDiscarded );
             delete added;
 
             // Otensors
@@ -906,8 +1106,10 @@ void CheMPS2::HamiltonianOperator::DSSum( int statesToAdd,
                }
             }
          }
+         if ( fitConverged( mpsOut, scheme->get_fit_tolerance( inst ), fittedNorm ) ) { break; }
       }
    }
+   recordFit( sweeps, sweepDiscarded );
 
    for ( int st = 0; st < statesToAdd; st++ ) {
       for ( int cnt = 0; cnt < L - 1; cnt++ ) {
@@ -918,7 +1120,308 @@ void CheMPS2::HamiltonianOperator::DSSum( int statesToAdd,
    delete[] overlaps;
 }
 
+void CheMPS2::HamiltonianOperator::TDVP( const dcomplex step, const bool twoSite,
+                                         CTensorT ** mps, SyBookkeeper * bk,
+                                         ConvergenceScheme * scheme, const int krylovSize, const double tolerance ) {
+
+   // Symmetric splitting: a left-to-right and a right-to-left sweep, each with half the time step
+   const dcomplex half = 0.5 * step;
+   const int inst      = scheme->get_number() - 1;
+   char notrans        = 'N';
+   char cotrans        = 'C';
+
+   // Same convention as TimeEvolution::doStep_arnoldi: without a tolerance, the Lanczos recursions stop at 1e-12
+   const double threshold = ( tolerance > 0.0 ) ? tolerance : 1e-12;
+
+   /* Bring the MPS in right-canonical form and build all moving-left boundary operators. The sites which the previous
+      sweep left right-normalized, and which have not been changed since, are not normalized again, so that the boundary
+      operators built from them are reused. */
+   int canonical = L;
+   if ( stampCanonicalBk == bk->gId() ) {
+      while ( ( canonical > 1 ) && ( stampCanonical[ canonical - 1 ] == fingerprint( mps[ canonical - 1 ] ) ) ) { canonical--; }
+   }
+   for ( int site = canonical - 1; site > 0; site-- ) {
+      right_normalize( mps[ site - 1 ], mps[ site ] );
+   }
+   for ( int cnt = L - 2; cnt >= 0; cnt-- ) {
+      updateMovingLeftSafe( cnt, mps, bk, mps, bk );
+   }
+
+   double sweepDiscarded = 0.0;
+   if ( twoSite ) {
+      for ( int site = 0; site < L - 1; site++ ) {
+         CSobject * denS = new CSobject( site, bk );
+         denS->Clear();
+         denS->Join( mps[ site ], mps[ site + 1 ] );
+         localExponential( half, krylovSize, threshold, NULL, denS, NULL, true );
+         struct timeval start;
+         gettimeofday( &start, NULL );
+         const double disc = denS->Split( mps[ site ], mps[ site + 1 ], scheme->get_D( inst ), scheme->get_cut_off( inst ), true, true );
+         lap( start, timings[ CHEMPS2_CTIME_SPLIT ] );
+         counters[ CHEMPS2_CCOUNT_SPLIT ]++;
+         recordSplit( site + 1, disc, bk, sweepDiscarded );
+         delete denS;
+
+         if ( site < L - 2 ) {
+            updateMovingRightSafe( site, mps, bk, mps, bk );
+            localExponential( -half, krylovSize, threshold, mps[ site + 1 ], NULL, NULL, true );
+         }
+      }
+      for ( int site = L - 2; site >= 0; site-- ) {
+         CSobject * denS = new CSobject( site, bk );
+         denS->Clear();
+         denS->Join( mps[ site ], mps[ site + 1 ] );
+         localExponential( half, krylovSize, threshold, NULL, denS, NULL, false );
+         struct timeval start;
+         gettimeofday( &start, NULL );
+         const double disc = denS->Split( mps[ site ], mps[ site + 1 ], scheme->get_D( inst ), scheme->get_cut_off( inst ), false, true );
+         lap( start, timings[ CHEMPS2_CTIME_SPLIT ] );
+         counters[ CHEMPS2_CCOUNT_SPLIT ]++;
+         recordSplit( site + 1, disc, bk, sweepDiscarded );
+         delete denS;
+
+         if ( site > 0 ) {
+            updateMovingLeftSafe( site, mps, bk, mps, bk );
+            localExponential( -half, krylovSize, threshold, mps[ site ], NULL, NULL, false );
+         }
+      }
+   } else {
+      /* The backward evolution of the bond matrix C between site and site + 1 is performed as the evolution of C B
+         with the one-site effective Hamiltonian of site + 1, projected onto the span of { X B }. B is the
+         right-normalized tensor of site + 1 from which the boundary operators at site + 1 were built. */
+      for ( int site = 0; site < L; site++ ) {
+         localExponential( half, krylovSize, threshold, mps[ site ], NULL, NULL, true );
+         if ( site < L - 1 ) {
+            CTensorT * basis       = new CTensorT( mps[ site + 1 ] );
+            CTensorOperator * temp = new CTensorOperator( site + 1, 0, 0, 0, true, true, false, bk, bk );
+            mps[ site ]->QR( temp );
+            mps[ site + 1 ]->LeftMultiply( temp, &notrans );
+            delete temp;
+
+            updateMovingRightSafe( site, mps, bk, mps, bk );
+            localExponential( -half, krylovSize, threshold, mps[ site + 1 ], NULL, basis, true );
+            delete basis;
+         }
+      }
+      for ( int site = L - 1; site >= 0; site-- ) {
+         localExponential( half, krylovSize, threshold, mps[ site ], NULL, NULL, false );
+         if ( site > 0 ) {
+            CTensorT * basis       = new CTensorT( mps[ site - 1 ] );
+            CTensorOperator * temp = new CTensorOperator( site, 0, 0, 0, true, true, false, bk, bk );
+            mps[ site ]->LQ( temp );
+            mps[ site - 1 ]->RightMultiply( temp, &cotrans );
+            delete temp;
+
+            updateMovingLeftSafe( site - 1, mps, bk, mps, bk );
+            localExponential( -half, krylovSize, threshold, mps[ site - 1 ], NULL, basis, false );
+            delete basis;
+         }
+      }
+   }
+   recordFit( 1, sweepDiscarded );
+
+   // The right-to-left sweep leaves the sites 1 to L - 1 right-normalized
+   for ( int site = 1; site < L; site++ ) {
+      stampCanonical[ site ] = fingerprint( mps[ site ] );
+   }
+   stampCanonicalBk = bk->gId();
+}
+
+void CheMPS2::HamiltonianOperator::localExponential( const dcomplex step, const int krylovSize, const double threshold, CTensorT * tensor, CSobject * sobject, CTensorT * projector, const bool movingRight ) {
+   /* Lanczos approximation of exp( step * Heff ) x for a one-site tensor ( sobject == NULL ) or a two-site
+      object ( tensor == NULL ), in place. With orthonormal environments, the inner product of the full
+      wavefunctions is the one of the local vectors with weight ( 2 S_R + 1 ) per block ( cfr. prog2symm ). */
+   assert( ( tensor == NULL ) != ( sobject == NULL ) );
+
+   dcomplex * storage = ( tensor != NULL ) ? tensor->gStorage() : sobject->gStorage();
+   const int nKappa   = ( tensor != NULL ) ? tensor->gNKappa() : sobject->gNKappa();
+   const int size     = ( tensor != NULL ) ? tensor->gKappa2index( nKappa ) : sobject->gKappa2index( nKappa );
+   if ( size == 0 ) { return; }
+
+   double * weight = new double[ size ];
+   for ( int ikappa = 0; ikappa < nKappa; ikappa++ ) {
+      const int start = ( tensor != NULL ) ? tensor->gKappa2index( ikappa ) : sobject->gKappa2index( ikappa );
+      const int stop  = ( tensor != NULL ) ? tensor->gKappa2index( ikappa + 1 ) : sobject->gKappa2index( ikappa + 1 );
+      const int TwoSR = ( tensor != NULL ) ? tensor->gTwoSR( ikappa ) : sobject->gTwoSR( ikappa );
+      for ( int elem = start; elem < stop; elem++ ) { weight[ elem ] = TwoSR + 1.0; }
+   }
+
+   double beta0 = 0.0;
+   for ( int elem = 0; elem < size; elem++ ) { beta0 += weight[ elem ] * std::norm( storage[ elem ] ); }
+   beta0 = std::sqrt( beta0 );
+   if ( beta0 == 0.0 ) {
+      delete[] weight;
+      return;
+   }
+
+   const int maxKrylov = std::max( 1, std::min( krylovSize, size ) );
+   dcomplex * basis    = new dcomplex[ maxKrylov * size ];
+   double * alpha      = new double[ maxKrylov ];
+   double * beta       = new double[ maxKrylov ];
+   dcomplex * coef     = new dcomplex[ maxKrylov ];
+
+   CTensorT * tin  = ( tensor != NULL ) ? new CTensorT( tensor ) : NULL;
+   CTensorT * tout = ( tensor != NULL ) ? new CTensorT( tensor ) : NULL;
+   CSobject * sin  = ( sobject != NULL ) ? new CSobject( sobject ) : NULL;
+   CSobject * sout = ( sobject != NULL ) ? new CSobject( sobject ) : NULL;
+   dcomplex * vin  = ( tensor != NULL ) ? tin->gStorage() : sin->gStorage();
+   dcomplex * vout = ( tensor != NULL ) ? tout->gStorage() : sout->gStorage();
+
+   for ( int elem = 0; elem < size; elem++ ) { basis[ elem ] = storage[ elem ] / beta0; }
+
+   int dim = 0;
+   while ( dim < maxKrylov ) {
+      dcomplex * current = basis + dim * size;
+      for ( int elem = 0; elem < size; elem++ ) { vin[ elem ] = current[ elem ]; }
+      applyEffective( tin, tout, sin, sout, projector, movingRight );
+
+      dcomplex inproduct = 0.0;
+      for ( int elem = 0; elem < size; elem++ ) { inproduct += weight[ elem ] * std::conj( current[ elem ] ) * vout[ elem ]; }
+      alpha[ dim ] = std::real( inproduct );
+      dim++;
+
+      // Full reorthogonalization against the ( few ) previous Lanczos vectors
+      for ( int vec = 0; vec < dim; vec++ ) {
+         dcomplex * previous = basis + vec * size;
+         dcomplex overlap    = 0.0;
+         for ( int elem = 0; elem < size; elem++ ) { overlap += weight[ elem ] * std::conj( previous[ elem ] ) * vout[ elem ]; }
+         for ( int elem = 0; elem < size; elem++ ) { vout[ elem ] -= overlap * previous[ elem ]; }
+      }
+      double residual = 0.0;
+      for ( int elem = 0; elem < size; elem++ ) { residual += weight[ elem ] * std::norm( vout[ elem ] ); }
+      residual = std::sqrt( residual );
+
+      // coef = exp( step * T ) e_0 for the tridiagonal Lanczos matrix T
+      {
+         char jobz       = 'V';
+         char uplo       = 'U';
+         int lwork       = 2 * dim;
+         int info;
+         dcomplex * U    = new dcomplex[ dim * dim ];
+         dcomplex * work = new dcomplex[ lwork ];
+         double * evals  = new double[ dim ];
+         double * rwork  = new double[ 3 * dim ];
+         for ( int elem = 0; elem < dim * dim; elem++ ) { U[ elem ] = 0.0; }
+         for ( int row = 0; row < dim; row++ ) {
+            U[ row + dim * row ] = alpha[ row ];
+            if ( row > 0 ) { U[ row - 1 + dim * row ] = beta[ row ]; }
+         }
+         zheev_( &jobz, &uplo, &dim, U, &dim, evals, work, &lwork, rwork, &info );
+         assert( info == 0 );
+         for ( int row = 0; row < dim; row++ ) {
+            coef[ row ] = 0.0;
+            for ( int eig = 0; eig < dim; eig++ ) {
+               coef[ row ] += U[ row + dim * eig ] * std::exp( step * evals[ eig ] ) * std::conj( U[ 0 + dim * eig ] );
+            }
+         }
+         delete[] U;
+         delete[] work;
+         delete[] evals;
+         delete[] rwork;
+      }
+
+      // Stop when the next Lanczos vector would not contribute anymore
+      if ( ( dim == maxKrylov ) || ( residual * std::abs( coef[ dim - 1 ] ) < threshold ) ) { break; }
+
+      beta[ dim ]     = residual;
+      dcomplex * next = basis + dim * size;
+      for ( int elem = 0; elem < size; elem++ ) { next[ elem ] = vout[ elem ] / residual; }
+   }
+
+   for ( int elem = 0; elem < size; elem++ ) {
+      storage[ elem ] = 0.0;
+      for ( int vec = 0; vec < dim; vec++ ) { storage[ elem ] += beta0 * coef[ vec ] * basis[ elem + vec * size ]; }
+   }
+
+   if ( tensor != NULL ) {
+      delete tin;
+      delete tout;
+   } else {
+      delete sin;
+      delete sout;
+   }
+   delete[] weight;
+   delete[] basis;
+   delete[] alpha;
+   delete[] beta;
+   delete[] coef;
+}
+
+void CheMPS2::HamiltonianOperator::applyEffective( CTensorT * in, CTensorT * out, CSobject * sin, CSobject * sout, CTensorT * projector, const bool movingRight ) {
+   if ( sin != NULL ) {
+      const int site           = sin->gIndex();
+      CTensorO * leftOverlapA  = ( site - 1 ) >= 0 ? Otensors[ site - 1 ] : NULL;
+      CTensorO * rightOverlapA = ( site + 2 ) < L ? Otensors[ site + 1 ] : NULL;
+
+      // CHeffNS::Apply adds to its output
+      sout->Clear();
+      struct timeval start;
+      gettimeofday( &start, NULL );
+      CHeffNS * heff = new CHeffNS( sin->gBK(), sin->gBK(), prob, offset, timings );
+      heff->Apply( sin, sout, Ltensors, LtensorsT, Atensors, AtensorsT,
+                   Btensors, BtensorsT, Ctensors, CtensorsT, Dtensors, DtensorsT,
+                   S0tensors, S0tensorsT, S1tensors, S1tensorsT, F0tensors,
+                   F0tensorsT, F1tensors, F1tensorsT, Qtensors, QtensorsT,
+                   Xtensors, leftOverlapA, rightOverlapA );
+      delete heff;
+      lap( start, timings[ CHEMPS2_CTIME_HEFF ] );
+      counters[ CHEMPS2_CCOUNT_HEFF ]++;
+      counters[ CHEMPS2_CCOUNT_HEFF_BLOCKS ] += sout->gNKappa();
+      return;
+   }
+
+   struct timeval start;
+   gettimeofday( &start, NULL );
+   CHeffNS_1S * heff = new CHeffNS_1S( in->gBK(), in->gBK(), prob );
+   heff->Apply( in, out,
+                Ltensors, LtensorsT,
+                Atensors, AtensorsT,
+                Btensors, BtensorsT,
+                Ctensors, CtensorsT,
+                Dtensors, DtensorsT,
+                S0tensors, S0tensorsT,
+                S1tensors, S1tensorsT,
+                F0tensors, F0tensorsT,
+                F1tensors, F1tensorsT,
+                Qtensors, QtensorsT,
+                Xtensors, Otensors );
+   delete heff;
+   lap( start, timings[ CHEMPS2_CTIME_HEFF ] );
+   counters[ CHEMPS2_CCOUNT_HEFF ]++;
+   counters[ CHEMPS2_CCOUNT_HEFF_BLOCKS ] += out->gNKappa();
+   // CHeffNS_1S does not know about the energy offset
+   in->zaxpy( offset, out );
+
+   if ( projector != NULL ) {
+      const int site = projector->gIndex();
+      char notrans   = 'N';
+      char cotrans   = 'C';
+      if ( movingRight ) {
+         // out <-- ( sum_k w_k out_k B_k^dagger ) B
+         CTensorO * coefficients = new CTensorO( site, false, projector->gBK(), projector->gBK() );
+         coefficients->create( out, projector );
+         projector->zcopy( out );
+         out->LeftMultiply( coefficients, &notrans );
+         delete coefficients;
+      } else {
+         // out <-- A ( sum_k A_k^dagger out_k )
+         CTensorO * coefficients = new CTensorO( site + 1, true, projector->gBK(), projector->gBK() );
+         coefficients->create( projector, out );
+         projector->zcopy( out );
+         out->RightMultiply( coefficients, &cotrans );
+         delete coefficients;
+      }
+   }
+}
+
 void CheMPS2::HamiltonianOperator::updateMovingLeftSafe( const int cnt, CTensorT ** mpsUp, SyBookkeeper * bkUp, CTensorT ** mpsDown, SyBookkeeper * bkDown ) {
+   if ( isUpToDate( cnt, false, mpsUp[ cnt + 1 ], bkUp, mpsDown[ cnt + 1 ], bkDown ) ) {
+      counters[ CHEMPS2_CCOUNT_ENV_REUSE ]++;
+      return;
+   }
+
+   struct timeval start;
+   gettimeofday( &start, NULL );
    if ( isAllocated[ cnt ] == 2 ) {
       deleteTensors( cnt, false );
       isAllocated[ cnt ] = 0;
@@ -930,11 +1433,23 @@ void CheMPS2::HamiltonianOperator::updateMovingLeftSafe( const int cnt, CTensorT
    if ( isAllocated[ cnt ] == 0 ) {
       allocateTensors( cnt, false, bkUp, bkDown );
       isAllocated[ cnt ] = 2;
+      counters[ CHEMPS2_CCOUNT_ENV_BYTES ] += boundaryBytes( cnt, false );
    }
+   lap( start, timings[ CHEMPS2_CTIME_ENV_ALLOC ] );
    updateMovingLeft( cnt, mpsUp, bkUp, mpsDown, bkDown );
+   lap( start, timings[ CHEMPS2_CTIME_ENV ] );
+   counters[ CHEMPS2_CCOUNT_ENV_BUILD ]++;
+   stampBoundary( cnt, false, mpsUp[ cnt + 1 ], bkUp, mpsDown[ cnt + 1 ], bkDown );
 }
 
 void CheMPS2::HamiltonianOperator::updateMovingRightSafe( const int cnt, CTensorT ** mpsUp, SyBookkeeper * bkUp, CTensorT ** mpsDown, SyBookkeeper * bkDown ) {
+   if ( isUpToDate( cnt, true, mpsUp[ cnt ], bkUp, mpsDown[ cnt ], bkDown ) ) {
+      counters[ CHEMPS2_CCOUNT_ENV_REUSE ]++;
+      return;
+   }
+
+   struct timeval start;
+   gettimeofday( &start, NULL );
    if ( isAllocated[ cnt ] == 2 ) {
       deleteTensors( cnt, false );
       isAllocated[ cnt ] = 0;
@@ -946,10 +1461,81 @@ void CheMPS2::HamiltonianOperator::updateMovingRightSafe( const int cnt, CTensor
    if ( isAllocated[ cnt ] == 0 ) {
       allocateTensors( cnt, true, bkUp, bkDown );
       isAllocated[ cnt ] = 1;
+      counters[ CHEMPS2_CCOUNT_ENV_BYTES ] += boundaryBytes( cnt, true );
    }
+   lap( start, timings[ CHEMPS2_CTIME_ENV_ALLOC ] );
    updateMovingRight( cnt, mpsUp, bkUp, mpsDown, bkDown );
+   lap( start, timings[ CHEMPS2_CTIME_ENV ] );
+   counters[ CHEMPS2_CCOUNT_ENV_BUILD ]++;
+   stampBoundary( cnt, true, mpsUp[ cnt ], bkUp, mpsDown[ cnt ], bkDown );
+}
+
+bool CheMPS2::HamiltonianOperator::isUpToDate( const int cnt, const bool movingRight, CTensorT * siteUp, SyBookkeeper * bkUp, CTensorT * siteDown, SyBookkeeper * bkDown ) const {
+   /* The boundary operators at cnt are a function of the bra and ket site tensors on one side of the boundary only.
+      They can be reused when they were built in the same direction, with the same bookkeepers, from the same newly
+      absorbed site tensors, and the neighbouring boundary they were built from has not been rebuilt since. The bookkeepers
+      are compared by id rather than by address, as a new bookkeeper can be allocated at the address of a deleted one.
+      The site tensors are only hashed once everything else matches. */
+   if ( isAllocated[ cnt ] != ( ( movingRight ) ? 1 : 2 ) ) { return false; }
+   if ( ( stampBkUp[ cnt ] != bkUp->gId() ) || ( stampBkDown[ cnt ] != bkDown->gId() ) ) { return false; }
+
+   const int neighbour = ( movingRight ) ? cnt - 1 : cnt + 1;
+   if ( ( neighbour >= 0 ) && ( neighbour < L - 1 ) ) {
+      if ( isAllocated[ neighbour ] != isAllocated[ cnt ] ) { return false; }
+      if ( buildCount[ neighbour ] != buildCountNeighbour[ cnt ] ) { return false; }
+   }
+
+   const unsigned long long fpUp = fingerprint( siteUp );
+   if ( stampUp[ cnt ] != fpUp ) { return false; }
+   return ( stampDown[ cnt ] == ( ( siteDown == siteUp ) ? fpUp : fingerprint( siteDown ) ) );
 }
 
+void CheMPS2::HamiltonianOperator::stampBoundary( const int cnt, const bool movingRight, CTensorT * siteUp, SyBookkeeper * bkUp, CTensorT * siteDown, SyBookkeeper * bkDown ) {
+   const int neighbour = ( movingRight ) ? cnt - 1 : cnt + 1;
+
+   stampUp[ cnt ]             = fingerprint( siteUp );
+   stampDown[ cnt ]           = ( siteDown == siteUp ) ? stampUp[ cnt ] : fingerprint( siteDown );
+   stampBkUp[ cnt ]           = bkUp->gId();
+   stampBkDown[ cnt ]         = bkDown->gId();
+   buildCounter++;
+   buildCount[ cnt ]          = buildCounter;
+   buildCountNeighbour[ cnt ] = ( ( neighbour >= 0 ) && ( neighbour < L - 1 ) ) ? buildCount[ neighbour ] : 0;
+}
+
+unsigned long long CheMPS2::HamiltonianOperator::fingerprint( CTensorT * tensor ) {
+   // 64-bit FNV-1a type hash of the virtual dimensions around a site tensor and of its content
+   const unsigned long long prime = 1099511628211ULL;
+   unsigned long long hash        = 14695981039346656037ULL;
+
+   const SyBookkeeper * bk = tensor->gBK();
+   for ( int bound = tensor->gIndex(); bound <= tensor->gIndex() + 1; bound++ ) {
+      for ( int N = bk->gNmin( bound ); N <= bk->gNmax( bound ); N++ ) {
+         for ( int TwoS = bk->gTwoSmin( bound, N ); TwoS <= bk->gTwoSmax( bound, N ); TwoS += 2 ) {
+            for ( int irrep = 0; irrep < bk->getNumberOfIrreps(); irrep++ ) {
+               hash = ( hash ^ ( unsigned long long )( bk->gCurrentDim( bound, N, TwoS, irrep ) ) ) * prime;
+            }
+         }
+      }
+   }
+
+   const int nKappa = tensor->gNKappa();
+
+   const double * values = reinterpret_cast< double * >( tensor->gStorage() );
+   const int size        = 2 * tensor->gKappa2index( nKappa );
+   for ( int cnt = 0; cnt < size; cnt++ ) {
+      unsigned long long bits;
+      memcpy( &bits, values + cnt, sizeof( double ) );
+      // Scramble the word first: with plain FNV-1a on 64-bit words, changes in the sign bit would never propagate
+      bits = ( bits ^ ( bits >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+      bits = ( bits ^ ( bits >> 27 ) ) * 0x94d049bb133111ebULL;
+      bits = bits ^ ( bits >> 31 );
+      hash = ( hash ^ bits ) * prime;
+   }
+   return hash;
+}
+
+void CheMPS2::HamiltonianOperator::ClearBoundaryOperators() { deleteAllBoundaryOperators(); }
+
 void CheMPS2::HamiltonianOperator::deleteAllBoundaryOperators() {
    for ( int cnt = 0; cnt < L - 1; cnt++ ) {
       if ( isAllocated[ cnt ] == 1 ) {
@@ -964,38 +1550,96 @@ void CheMPS2::HamiltonianOperator::deleteAllBoundaryOperators() {
 
 void CheMPS2::HamiltonianOperator::updateMovingLeft( const int index, CTensorT ** mpsUp, SyBookkeeper * bkUp, CTensorT ** mpsDown, SyBookkeeper * bkDown ) {
 
+   // Every matrix element of the update has an index on the absorbed site
+   prob->set_mxelem_window( index + 1, index + 1 );
+
    const int dimL = std::max( bkUp->gMaxDimAtBound( index + 1 ), bkDown->gMaxDimAtBound( index + 1 ) );
    const int dimR = std::max( bkUp->gMaxDimAtBound( index + 2 ), bkDown->gMaxDimAtBound( index + 2 ) );
 
+   // Every operator family and its transposed partner are updated in separate work-sharing loops with dynamic scheduling:
+   // the cost of the items differs strongly (create vs. update, and the inner num loop of the complementary operators),
+   // and threads that finish one family continue with the next one instead of waiting
+
 #pragma omp parallel
    {
-      dcomplex * workmem = new dcomplex[ dimL * dimR ];
+      // Workspaces are allocated once per thread, not once per operator
+      dcomplex * workmem    = new dcomplex[ dimL * dimR ];
+      dcomplex * workmemBIS = ( index == L - 2 ) ? NULL : new dcomplex[ dimR * dimR ];
+
+      // Thread times of the L, F and S, A, B, C and D, and Q families
+      double familyTimes[ 4 ] = { 0.0, 0.0, 0.0, 0.0 };
+      struct timeval start;
+      gettimeofday( &start, NULL );
 
 // Ltensors_MPSDT_MPS : all processes own all Ltensors_MPSDT_MPS
-#pragma omp for schedule( static ) nowait
+#pragma omp for schedule( dynamic ) nowait
       for ( int cnt2 = 0; cnt2 < L - 1 - index; cnt2++ ) {
          if ( cnt2 == 0 ) {
             if ( index == L - 2 ) {
                Ltensors[ index ][ cnt2 ]->create( mpsUp[ index + 1 ], mpsDown[ index + 1 ], NULL, NULL );
-               LtensorsT[ index ][ cnt2 ]->create( mpsUp[ index + 1 ], mpsDown[ index + 1 ], NULL, NULL );
             } else {
                Ltensors[ index ][ cnt2 ]->create( mpsUp[ index + 1 ], mpsDown[ index + 1 ], Otensors[ index + 1 ], workmem );
-               LtensorsT[ index ][ cnt2 ]->create( mpsUp[ index + 1 ], mpsDown[ index + 1 ], Otensors[ index + 1 ], workmem );
             }
          } else {
             Ltensors[ index ][ cnt2 ]->update( Ltensors[ index + 1 ][ cnt2 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
+         }
+      }
+
+#pragma omp for schedule( dynamic ) nowait
+      for ( int cnt2 = 0; cnt2 < L - 1 - index; cnt2++ ) {
+         if ( cnt2 == 0 ) {
+            if ( index == L - 2 ) {
+               LtensorsT[ index ][ cnt2 ]->create( mpsUp[ index + 1 ], mpsDown[ index + 1 ], NULL, NULL );
+            } else {
+               LtensorsT[ index ][ cnt2 ]->create( mpsUp[ index + 1 ], mpsDown[ index + 1 ], Otensors[ index + 1 ], workmem );
+            }
+         } else {
             LtensorsT[ index ][ cnt2 ]->update( LtensorsT[ index + 1 ][ cnt2 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
          }
       }
 
+      lap( start, familyTimes[ 0 ] );
+
       // Two-operator tensors : certain processes own certain two-operator tensors
       const int k1          = L - 1 - index;
       const int upperbound1 = ( k1 * ( k1 + 1 ) ) / 2;
       int result[ 2 ];
 
+#pragma omp for schedule( dynamic ) nowait
+      for ( int global = 0; global < upperbound1; global++ ) {
+         Special::invert_triangle_two( global, result );
+         const int cnt2 = k1 - 1 - result[ 1 ];
+         const int cnt3 = result[ 0 ];
+         if ( cnt3 == 0 ) {
+            if ( cnt2 == 0 ) {
+               if ( index == L - 2 ) {
+                  F0tensors[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index + 1 ], mpsDown[ index + 1 ], NULL, NULL );
+                  F1tensors[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index + 1 ], mpsDown[ index + 1 ], NULL, NULL );
+                  S0tensors[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index + 1 ], mpsDown[ index + 1 ], NULL, NULL );
+               } else {
+                  F0tensors[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index + 1 ], mpsDown[ index + 1 ], Otensors[ index + 1 ], workmem );
+                  F1tensors[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index + 1 ], mpsDown[ index + 1 ], Otensors[ index + 1 ], workmem );
+                  S0tensors[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index + 1 ], mpsDown[ index + 1 ], Otensors[ index + 1 ], workmem );
+               }
+            } else {
+               F0tensors[ index ][ cnt2 ][ cnt3 ]->makenew( Ltensors[ index + 1 ][ cnt2 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
+               F1tensors[ index ][ cnt2 ][ cnt3 ]->makenew( Ltensors[ index + 1 ][ cnt2 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
+               S0tensors[ index ][ cnt2 ][ cnt3 ]->makenew( Ltensors[ index + 1 ][ cnt2 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
+               S1tensors[ index ][ cnt2 ][ cnt3 ]->makenew( Ltensors[ index + 1 ][ cnt2 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
+            }
+         } else {
+            F0tensors[ index ][ cnt2 ][ cnt3 ]->update( F0tensors[ index + 1 ][ cnt2 ][ cnt3 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
+            F1tensors[ index ][ cnt2 ][ cnt3 ]->update( F1tensors[ index + 1 ][ cnt2 ][ cnt3 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
+            S0tensors[ index ][ cnt2 ][ cnt3 ]->update( S0tensors[ index + 1 ][ cnt2 ][ cnt3 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
+            if ( cnt2 > 0 ) {
+               S1tensors[ index ][ cnt2 ][ cnt3 ]->update( S1tensors[ index + 1 ][ cnt2 ][ cnt3 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
+            }
+         }
+      }
+
 // After this parallel region, WAIT because F0,F1,S0,S1[ index ][ cnt2 ][ cnt3
 // == 0 ] is required for the complementary operators
-#pragma omp for schedule( static )
+#pragma omp for schedule( dynamic )
       for ( int global = 0; global < upperbound1; global++ ) {
          Special::invert_triangle_two( global, result );
          const int cnt2 = k1 - 1 - result[ 1 ];
@@ -1003,50 +1647,38 @@ void CheMPS2::HamiltonianOperator::updateMovingLeft( const int index, CTensorT *
          if ( cnt3 == 0 ) {
             if ( cnt2 == 0 ) {
                if ( index == L - 2 ) {
-                  F0tensors[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index + 1 ], mpsDown[ index + 1 ], NULL, NULL );
                   F0tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index + 1 ], mpsDown[ index + 1 ], NULL, NULL );
-                  F1tensors[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index + 1 ], mpsDown[ index + 1 ], NULL, NULL );
                   F1tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index + 1 ], mpsDown[ index + 1 ], NULL, NULL );
-                  S0tensors[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index + 1 ], mpsDown[ index + 1 ], NULL, NULL );
                   S0tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index + 1 ], mpsDown[ index + 1 ], NULL, NULL );
                } else {
-                  F0tensors[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index + 1 ], mpsDown[ index + 1 ], Otensors[ index + 1 ], workmem );
                   F0tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index + 1 ], mpsDown[ index + 1 ], Otensors[ index + 1 ], workmem );
-                  F1tensors[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index + 1 ], mpsDown[ index + 1 ], Otensors[ index + 1 ], workmem );
                   F1tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index + 1 ], mpsDown[ index + 1 ], Otensors[ index + 1 ], workmem );
-                  S0tensors[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index + 1 ], mpsDown[ index + 1 ], Otensors[ index + 1 ], workmem );
                   S0tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index + 1 ], mpsDown[ index + 1 ], Otensors[ index + 1 ], workmem );
                }
             } else {
-               F0tensors[ index ][ cnt2 ][ cnt3 ]->makenew( Ltensors[ index + 1 ][ cnt2 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
                F0tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( LtensorsT[ index + 1 ][ cnt2 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
-               F1tensors[ index ][ cnt2 ][ cnt3 ]->makenew( Ltensors[ index + 1 ][ cnt2 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
                F1tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( LtensorsT[ index + 1 ][ cnt2 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
-               S0tensors[ index ][ cnt2 ][ cnt3 ]->makenew( Ltensors[ index + 1 ][ cnt2 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
                S0tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( LtensorsT[ index + 1 ][ cnt2 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
-               S1tensors[ index ][ cnt2 ][ cnt3 ]->makenew( Ltensors[ index + 1 ][ cnt2 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
                S1tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( LtensorsT[ index + 1 ][ cnt2 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
             }
          } else {
-            F0tensors[ index ][ cnt2 ][ cnt3 ]->update( F0tensors[ index + 1 ][ cnt2 ][ cnt3 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
             F0tensorsT[ index ][ cnt2 ][ cnt3 ]->update( F0tensorsT[ index + 1 ][ cnt2 ][ cnt3 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
-            F1tensors[ index ][ cnt2 ][ cnt3 ]->update( F1tensors[ index + 1 ][ cnt2 ][ cnt3 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
             F1tensorsT[ index ][ cnt2 ][ cnt3 ]->update( F1tensorsT[ index + 1 ][ cnt2 ][ cnt3 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
-            S0tensors[ index ][ cnt2 ][ cnt3 ]->update( S0tensors[ index + 1 ][ cnt2 ][ cnt3 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
             S0tensorsT[ index ][ cnt2 ][ cnt3 ]->update( S0tensorsT[ index + 1 ][ cnt2 ][ cnt3 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
             if ( cnt2 > 0 ) {
-               S1tensors[ index ][ cnt2 ][ cnt3 ]->update( S1tensors[ index + 1 ][ cnt2 ][ cnt3 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
                S1tensorsT[ index ][ cnt2 ][ cnt3 ]->update( S1tensorsT[ index + 1 ][ cnt2 ][ cnt3 - 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
             }
          }
       }
 
+      lap( start, familyTimes[ 1 ] );
+
       // Complementary two-operator tensors : certain processes own certain
       // complementary two-operator tensors
       const int k2          = index + 1;
       const int upperbound2 = ( k2 * ( k2 + 1 ) ) / 2;
 
-#pragma omp for schedule( static ) nowait
+#pragma omp for schedule( dynamic ) nowait
       for ( int global = 0; global < upperbound2; global++ ) {
          Special::invert_triangle_two( global, result );
          const int cnt2       = k2 - 1 - result[ 1 ];
@@ -1056,26 +1688,18 @@ void CheMPS2::HamiltonianOperator::updateMovingLeft( const int index, CTensorT *
          const int irrep_prod = Irreps::directProd( bkUp->gIrrep( siteindex1 ), bkUp->gIrrep( siteindex2 ) );
          if ( index == L - 2 ) {
             Atensors[ index ][ cnt2 ][ cnt3 ]->clear();
-            AtensorsT[ index ][ cnt2 ][ cnt3 ]->clear();
             if ( cnt2 > 0 ) {
                Btensors[ index ][ cnt2 ][ cnt3 ]->clear();
-               BtensorsT[ index ][ cnt2 ][ cnt3 ]->clear();
             }
             Ctensors[ index ][ cnt2 ][ cnt3 ]->clear();
-            CtensorsT[ index ][ cnt2 ][ cnt3 ]->clear();
             Dtensors[ index ][ cnt2 ][ cnt3 ]->clear();
-            DtensorsT[ index ][ cnt2 ][ cnt3 ]->clear();
          } else {
             Atensors[ index ][ cnt2 ][ cnt3 ]->update( Atensors[ index + 1 ][ cnt2 ][ cnt3 + 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
-            AtensorsT[ index ][ cnt2 ][ cnt3 ]->update( AtensorsT[ index + 1 ][ cnt2 ][ cnt3 + 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
             if ( cnt2 > 0 ) {
                Btensors[ index ][ cnt2 ][ cnt3 ]->update( Btensors[ index + 1 ][ cnt2 ][ cnt3 + 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
-               BtensorsT[ index ][ cnt2 ][ cnt3 ]->update( BtensorsT[ index + 1 ][ cnt2 ][ cnt3 + 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
             }
             Ctensors[ index ][ cnt2 ][ cnt3 ]->update( Ctensors[ index + 1 ][ cnt2 ][ cnt3 + 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
-            CtensorsT[ index ][ cnt2 ][ cnt3 ]->update( CtensorsT[ index + 1 ][ cnt2 ][ cnt3 + 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
             Dtensors[ index ][ cnt2 ][ cnt3 ]->update( Dtensors[ index + 1 ][ cnt2 ][ cnt3 + 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
-            DtensorsT[ index ][ cnt2 ][ cnt3 ]->update( DtensorsT[ index + 1 ][ cnt2 ][ cnt3 + 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
          }
          for ( int num = 0; num < L - index - 1; num++ ) {
             if ( irrep_prod ==
@@ -1086,63 +1710,136 @@ void CheMPS2::HamiltonianOperator::updateMovingLeft( const int index, CTensorT *
                if ( ( cnt2 > 0 ) && ( num > 0 ) )
                   alpha += prob->gMxElement( siteindex1, siteindex2, index + 1 + num, index + 1 );
                Atensors[ index ][ cnt2 ][ cnt3 ]->zaxpy( alpha, S0tensors[ index ][ num ][ 0 ] );
-               AtensorsT[ index ][ cnt2 ][ cnt3 ]->zaxpy( alpha, S0tensorsT[ index ][ num ][ 0 ] );
 
                if ( ( num > 0 ) && ( cnt2 > 0 ) ) {
                   alpha = prob->gMxElement( siteindex1, siteindex2, index + 1, index + 1 + num ) -
                           prob->gMxElement( siteindex1, siteindex2, index + 1 + num, index + 1 );
                   Btensors[ index ][ cnt2 ][ cnt3 ]->zaxpy( alpha, S1tensors[ index ][ num ][ 0 ] );
-                  BtensorsT[ index ][ cnt2 ][ cnt3 ]->zaxpy( alpha, S1tensorsT[ index ][ num ][ 0 ] );
                }
                alpha = 2 * prob->gMxElement( siteindex1, index + 1, siteindex2, index + 1 + num ) -
                        prob->gMxElement( siteindex1, index + 1, index + 1 + num, siteindex2 );
                Ctensors[ index ][ cnt2 ][ cnt3 ]->zaxpy( alpha, F0tensors[ index ][ num ][ 0 ] );
+
+               alpha = -prob->gMxElement( siteindex1, index + 1, index + 1 + num, siteindex2 ); // Second line for Ctensors
+               Dtensors[ index ][ cnt2 ][ cnt3 ]->zaxpy( alpha, F1tensors[ index ][ num ][ 0 ] );
+
+               if ( num > 0 ) {
+                  alpha = 2 * prob->gMxElement( siteindex1, index + 1 + num, siteindex2, index + 1 ) -
+                          prob->gMxElement( siteindex1, index + 1 + num, index + 1, siteindex2 );
+                  Ctensors[ index ][ cnt2 ][ cnt3 ]->zaxpy_tensorCD( alpha, F0tensorsT[ index ][ num ][ 0 ] );
+
+                  alpha = -prob->gMxElement( siteindex1, index + 1 + num, index + 1, siteindex2 ); // Second line for Ctensors
+                  Dtensors[ index ][ cnt2 ][ cnt3 ]->zaxpy_tensorCD( alpha, F1tensorsT[ index ][ num ][ 0 ] );
+               }
+            }
+         }
+      }
+
+#pragma omp for schedule( dynamic ) nowait
+      for ( int global = 0; global < upperbound2; global++ ) {
+         Special::invert_triangle_two( global, result );
+         const int cnt2       = k2 - 1 - result[ 1 ];
+         const int cnt3       = result[ 0 ];
+         const int siteindex1 = index - cnt3 - cnt2;
+         const int siteindex2 = index - cnt3;
+         const int irrep_prod = Irreps::directProd( bkUp->gIrrep( siteindex1 ), bkUp->gIrrep( siteindex2 ) );
+         if ( index == L - 2 ) {
+            AtensorsT[ index ][ cnt2 ][ cnt3 ]->clear();
+            if ( cnt2 > 0 ) {
+               BtensorsT[ index ][ cnt2 ][ cnt3 ]->clear();
+            }
+            CtensorsT[ index ][ cnt2 ][ cnt3 ]->clear();
+            DtensorsT[ index ][ cnt2 ][ cnt3 ]->clear();
+         } else {
+            AtensorsT[ index ][ cnt2 ][ cnt3 ]->update( AtensorsT[ index + 1 ][ cnt2 ][ cnt3 + 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
+            if ( cnt2 > 0 ) {
+               BtensorsT[ index ][ cnt2 ][ cnt3 ]->update( BtensorsT[ index + 1 ][ cnt2 ][ cnt3 + 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
+            }
+            CtensorsT[ index ][ cnt2 ][ cnt3 ]->update( CtensorsT[ index + 1 ][ cnt2 ][ cnt3 + 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
+            DtensorsT[ index ][ cnt2 ][ cnt3 ]->update( DtensorsT[ index + 1 ][ cnt2 ][ cnt3 + 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
+         }
+         for ( int num = 0; num < L - index - 1; num++ ) {
+            if ( irrep_prod ==
+                 S0tensorsT[ index ][ num ][ 0 ]->get_irrep() ) { // Then the matrix elements are not 0 due to symm.
+               double alpha = prob->gMxElement( siteindex1, siteindex2, index + 1, index + 1 + num );
+               if ( ( cnt2 == 0 ) && ( num == 0 ) )
+                  alpha *= 0.5;
+               if ( ( cnt2 > 0 ) && ( num > 0 ) )
+                  alpha += prob->gMxElement( siteindex1, siteindex2, index + 1 + num, index + 1 );
+               AtensorsT[ index ][ cnt2 ][ cnt3 ]->zaxpy( alpha, S0tensorsT[ index ][ num ][ 0 ] );
+
+               if ( ( num > 0 ) && ( cnt2 > 0 ) ) {
+                  alpha = prob->gMxElement( siteindex1, siteindex2, index + 1, index + 1 + num ) -
+                          prob->gMxElement( siteindex1, siteindex2, index + 1 + num, index + 1 );
+                  BtensorsT[ index ][ cnt2 ][ cnt3 ]->zaxpy( alpha, S1tensorsT[ index ][ num ][ 0 ] );
+               }
+               alpha = 2 * prob->gMxElement( siteindex1, index + 1, siteindex2, index + 1 + num ) -
+                       prob->gMxElement( siteindex1, index + 1, index + 1 + num, siteindex2 );
                CtensorsT[ index ][ cnt2 ][ cnt3 ]->zaxpy( alpha, F0tensorsT[ index ][ num ][ 0 ] );
 
                alpha = -prob->gMxElement( siteindex1, index + 1, index + 1 + num, siteindex2 ); // Second line for CtensorsT
-               Dtensors[ index ][ cnt2 ][ cnt3 ]->zaxpy( alpha, F1tensors[ index ][ num ][ 0 ] );
                DtensorsT[ index ][ cnt2 ][ cnt3 ]->zaxpy( alpha, F1tensorsT[ index ][ num ][ 0 ] );
 
                if ( num > 0 ) {
                   alpha = 2 * prob->gMxElement( siteindex1, index + 1 + num, siteindex2, index + 1 ) -
                           prob->gMxElement( siteindex1, index + 1 + num, index + 1, siteindex2 );
-                  Ctensors[ index ][ cnt2 ][ cnt3 ]->zaxpy_tensorCD( alpha, F0tensorsT[ index ][ num ][ 0 ] );
                   CtensorsT[ index ][ cnt2 ][ cnt3 ]->zaxpy_tensorCTDT( alpha, F0tensors[ index ][ num ][ 0 ] );
 
-                  alpha = -prob->gMxElement( siteindex1, index + 1 + num, index + 1, siteindex2 ); // Second line for Ctensors_MPS_mpsUp
-                  Dtensors[ index ][ cnt2 ][ cnt3 ]->zaxpy_tensorCD( alpha, F1tensorsT[ index ][ num ][ 0 ] );
+                  alpha = -prob->gMxElement( siteindex1, index + 1 + num, index + 1, siteindex2 ); // Second line for CtensorsT
                   DtensorsT[ index ][ cnt2 ][ cnt3 ]->zaxpy_tensorCTDT( alpha, F1tensors[ index ][ num ][ 0 ] );
                }
             }
          }
       }
+
+      lap( start, familyTimes[ 2 ] );
+
 // QQtensors  : certain processes own certain QQtensors  --- You don't want to
 // locally parallellize when sending and receiving buffers!
-#pragma omp for schedule( static ) nowait
+#pragma omp for schedule( dynamic ) nowait
       for ( int cnt2 = 0; cnt2 < index + 1; cnt2++ ) {
          if ( index == L - 2 ) {
             Qtensors[ index ][ cnt2 ]->clear();
-            QtensorsT[ index ][ cnt2 ]->clear();
             Qtensors[ index ][ cnt2 ]->AddTermSimple( mpsUp[ index + 1 ], mpsDown[ index + 1 ], NULL, NULL );
-            QtensorsT[ index ][ cnt2 ]->AddTermSimple( mpsUp[ index + 1 ], mpsDown[ index + 1 ], NULL, NULL );
          } else {
-            dcomplex * workmemBIS = new dcomplex[ dimR * dimR ];
             Qtensors[ index ][ cnt2 ]->update( Qtensors[ index + 1 ][ cnt2 + 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
-            QtensorsT[ index ][ cnt2 ]->update( QtensorsT[ index + 1 ][ cnt2 + 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
             Qtensors[ index ][ cnt2 ]->AddTermSimple( mpsUp[ index + 1 ], mpsDown[ index + 1 ], Otensors[ index + 1 ], workmem );
-            QtensorsT[ index ][ cnt2 ]->AddTermSimple( mpsUp[ index + 1 ], mpsDown[ index + 1 ], Otensors[ index + 1 ], workmem );
             Qtensors[ index ][ cnt2 ]->AddTermsL( Ltensors[ index + 1 ], LtensorsT[ index + 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmemBIS, workmem );
-            QtensorsT[ index ][ cnt2 ]->AddTermsL( Ltensors[ index + 1 ], LtensorsT[ index + 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmemBIS, workmem );
             Qtensors[ index ][ cnt2 ]->AddTermsAB( Atensors[ index + 1 ][ cnt2 + 1 ][ 0 ], Btensors[ index + 1 ][ cnt2 + 1 ][ 0 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmemBIS, workmem );
-            QtensorsT[ index ][ cnt2 ]->AddTermsAB( AtensorsT[ index + 1 ][ cnt2 + 1 ][ 0 ], BtensorsT[ index + 1 ][ cnt2 + 1 ][ 0 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmemBIS, workmem );
             Qtensors[ index ][ cnt2 ]->AddTermsCD( Ctensors[ index + 1 ][ cnt2 + 1 ][ 0 ], Dtensors[ index + 1 ][ cnt2 + 1 ][ 0 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmemBIS, workmem );
+         }
+      }
+
+#pragma omp for schedule( dynamic ) nowait
+      for ( int cnt2 = 0; cnt2 < index + 1; cnt2++ ) {
+         if ( index == L - 2 ) {
+            QtensorsT[ index ][ cnt2 ]->clear();
+            QtensorsT[ index ][ cnt2 ]->AddTermSimple( mpsUp[ index + 1 ], mpsDown[ index + 1 ], NULL, NULL );
+         } else {
+            QtensorsT[ index ][ cnt2 ]->update( QtensorsT[ index + 1 ][ cnt2 + 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmem );
+            QtensorsT[ index ][ cnt2 ]->AddTermSimple( mpsUp[ index + 1 ], mpsDown[ index + 1 ], Otensors[ index + 1 ], workmem );
+            QtensorsT[ index ][ cnt2 ]->AddTermsL( Ltensors[ index + 1 ], LtensorsT[ index + 1 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmemBIS, workmem );
+            QtensorsT[ index ][ cnt2 ]->AddTermsAB( AtensorsT[ index + 1 ][ cnt2 + 1 ][ 0 ], BtensorsT[ index + 1 ][ cnt2 + 1 ][ 0 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmemBIS, workmem );
             QtensorsT[ index ][ cnt2 ]->AddTermsCD( CtensorsT[ index + 1 ][ cnt2 + 1 ][ 0 ], DtensorsT[ index + 1 ][ cnt2 + 1 ][ 0 ], mpsUp[ index + 1 ], mpsDown[ index + 1 ], workmemBIS, workmem );
-            delete[] workmemBIS;
          }
       }
 
+      lap( start, familyTimes[ 3 ] );
+
+#pragma omp critical
+      {
+         timings[ CHEMPS2_CTIME_ENV_L ]    += familyTimes[ 0 ];
+         timings[ CHEMPS2_CTIME_ENV_FS ]   += familyTimes[ 1 ];
+         timings[ CHEMPS2_CTIME_ENV_ABCD ] += familyTimes[ 2 ];
+         timings[ CHEMPS2_CTIME_ENV_Q ]    += familyTimes[ 3 ];
+      }
+
       delete[] workmem;
+      delete[] workmemBIS;
    }
+
+   struct timeval start;
+   gettimeofday( &start, NULL );
    // Xtensors
    if ( index == L - 2 ) {
       Xtensors[ index ]->update( mpsUp[ index + 1 ], mpsDown[ index + 1 ] );
@@ -1160,41 +1857,65 @@ void CheMPS2::HamiltonianOperator::updateMovingLeft( const int index, CTensorT *
    } else {
       Otensors[ index ]->update_ownmem( mpsUp[ index + 1 ], mpsDown[ index + 1 ], Otensors[ index + 1 ] );
    }
+   lap( start, timings[ CHEMPS2_CTIME_ENV_XO ] );
 }
 
 void CheMPS2::HamiltonianOperator::updateMovingRight( const int index, CTensorT ** mpsUp, SyBookkeeper * bkUp, CTensorT ** mpsDown, SyBookkeeper * bkDown ) {
 
+   // Every matrix element of the update has an index on the absorbed site
+   prob->set_mxelem_window( index, index );
+
    const int dimL = std::max( bkUp->gMaxDimAtBound( index ), bkDown->gMaxDimAtBound( index ) );
    const int dimR = std::max( bkUp->gMaxDimAtBound( index + 1 ), bkDown->gMaxDimAtBound( index + 1 ) );
 
+   // Same work distribution as in updateMovingLeft: one dynamically scheduled loop per operator family
+
 #pragma omp parallel
    {
-      dcomplex * workmem = new dcomplex[ dimL * dimR ];
+      // Workspaces are allocated once per thread, not once per operator
+      dcomplex * workmem    = new dcomplex[ dimL * dimR ];
+      dcomplex * workmemBIS = ( index == 0 ) ? NULL : new dcomplex[ dimL * dimL ];
+
+      // Thread times of the L, F and S, A, B, C and D, and Q families
+      double familyTimes[ 4 ] = { 0.0, 0.0, 0.0, 0.0 };
+      struct timeval start;
+      gettimeofday( &start, NULL );
 
 // Ltensors
-#pragma omp for schedule( static ) nowait
+#pragma omp for schedule( dynamic ) nowait
       for ( int cnt2 = 0; cnt2 < index + 1; cnt2++ ) {
          if ( cnt2 == 0 ) {
             if ( index == 0 ) {
                Ltensors[ index ][ cnt2 ]->create( mpsUp[ index ], mpsDown[ index ], NULL, NULL );
-               LtensorsT[ index ][ cnt2 ]->create( mpsUp[ index ], mpsDown[ index ], NULL, NULL );
             } else {
                Ltensors[ index ][ cnt2 ]->create( mpsUp[ index ], mpsDown[ index ], Otensors[ index - 1 ], workmem );
-               LtensorsT[ index ][ cnt2 ]->create( mpsUp[ index ], mpsDown[ index ], Otensors[ index - 1 ], workmem );
             }
          } else {
             Ltensors[ index ][ cnt2 ]->update( Ltensors[ index - 1 ][ cnt2 - 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
+         }
+      }
+
+#pragma omp for schedule( dynamic ) nowait
+      for ( int cnt2 = 0; cnt2 < index + 1; cnt2++ ) {
+         if ( cnt2 == 0 ) {
+            if ( index == 0 ) {
+               LtensorsT[ index ][ cnt2 ]->create( mpsUp[ index ], mpsDown[ index ], NULL, NULL );
+            } else {
+               LtensorsT[ index ][ cnt2 ]->create( mpsUp[ index ], mpsDown[ index ], Otensors[ index - 1 ], workmem );
+            }
+         } else {
             LtensorsT[ index ][ cnt2 ]->update( LtensorsT[ index - 1 ][ cnt2 - 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
          }
       }
 
+      lap( start, familyTimes[ 0 ] );
+
       // Two-operator tensors : certain processes own certain two-operator tensors
       const int k1          = index + 1;
       const int upperbound1 = ( k1 * ( k1 + 1 ) ) / 2;
       int result[ 2 ];
-// After this parallel region, WAIT because F0,F1,S0,S1[ index ][ cnt2 ][ cnt3
-// == 0 ] is required for the complementary operators
-#pragma omp for schedule( static )
+
+#pragma omp for schedule( dynamic ) nowait
       for ( int global = 0; global < upperbound1; global++ ) {
          Special::invert_triangle_two( global, result );
          const int cnt2 = index - result[ 1 ];
@@ -1206,16 +1927,10 @@ void CheMPS2::HamiltonianOperator::updateMovingRight( const int index, CTensorT
                   F0tensors[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index ], mpsDown[ index ], NULL, NULL );
                   F1tensors[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index ], mpsDown[ index ], NULL, NULL );
                   S0tensors[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index ], mpsDown[ index ], NULL, NULL );
-                  F0tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index ], mpsDown[ index ], NULL, NULL );
-                  F1tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index ], mpsDown[ index ], NULL, NULL );
-                  S0tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index ], mpsDown[ index ], NULL, NULL );
                } else {
                   F0tensors[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index ], mpsDown[ index ], Otensors[ index - 1 ], workmem );
                   F1tensors[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index ], mpsDown[ index ], Otensors[ index - 1 ], workmem );
                   S0tensors[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index ], mpsDown[ index ], Otensors[ index - 1 ], workmem );
-                  F0tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index ], mpsDown[ index ], Otensors[ index - 1 ], workmem );
-                  F1tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index ], mpsDown[ index ], Otensors[ index - 1 ], workmem );
-                  S0tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index ], mpsDown[ index ], Otensors[ index - 1 ], workmem );
                }
                // // S1[ index ][ 0 ][ cnt3 ] doesn't exist
             } else {
@@ -1223,30 +1938,59 @@ void CheMPS2::HamiltonianOperator::updateMovingRight( const int index, CTensorT
                F1tensors[ index ][ cnt2 ][ cnt3 ]->makenew( Ltensors[ index - 1 ][ cnt2 - 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
                S0tensors[ index ][ cnt2 ][ cnt3 ]->makenew( Ltensors[ index - 1 ][ cnt2 - 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
                S1tensors[ index ][ cnt2 ][ cnt3 ]->makenew( Ltensors[ index - 1 ][ cnt2 - 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
+            }
+         } else {
+            F0tensors[ index ][ cnt2 ][ cnt3 ]->update( F0tensors[ index - 1 ][ cnt2 ][ cnt3 - 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
+            F1tensors[ index ][ cnt2 ][ cnt3 ]->update( F1tensors[ index - 1 ][ cnt2 ][ cnt3 - 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
+            S0tensors[ index ][ cnt2 ][ cnt3 ]->update( S0tensors[ index - 1 ][ cnt2 ][ cnt3 - 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
+            if ( cnt2 > 0 ) {
+               S1tensors[ index ][ cnt2 ][ cnt3 ]->update( S1tensors[ index - 1 ][ cnt2 ][ cnt3 - 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
+            }
+         }
+      }
+
+// After this parallel region, WAIT because F0,F1,S0,S1[ index ][ cnt2 ][ cnt3
+// == 0 ] is required for the complementary operators
+#pragma omp for schedule( dynamic )
+      for ( int global = 0; global < upperbound1; global++ ) {
+         Special::invert_triangle_two( global, result );
+         const int cnt2 = index - result[ 1 ];
+         const int cnt3 = result[ 0 ];
+         if ( cnt3 == 0 ) {
+            if ( cnt2 == 0 ) {
+               if ( index == 0 ) {
+                  F0tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index ], mpsDown[ index ], NULL, NULL );
+                  F1tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index ], mpsDown[ index ], NULL, NULL );
+                  S0tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index ], mpsDown[ index ], NULL, NULL );
+               } else {
+                  F0tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index ], mpsDown[ index ], Otensors[ index - 1 ], workmem );
+                  F1tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index ], mpsDown[ index ], Otensors[ index - 1 ], workmem );
+                  S0tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( mpsUp[ index ], mpsDown[ index ], Otensors[ index - 1 ], workmem );
+               }
+            } else {
                F0tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( LtensorsT[ index - 1 ][ cnt2 - 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
                F1tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( LtensorsT[ index - 1 ][ cnt2 - 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
                S0tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( LtensorsT[ index - 1 ][ cnt2 - 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
                S1tensorsT[ index ][ cnt2 ][ cnt3 ]->makenew( LtensorsT[ index - 1 ][ cnt2 - 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
             }
          } else {
-            F0tensors[ index ][ cnt2 ][ cnt3 ]->update( F0tensors[ index - 1 ][ cnt2 ][ cnt3 - 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
-            F1tensors[ index ][ cnt2 ][ cnt3 ]->update( F1tensors[ index - 1 ][ cnt2 ][ cnt3 - 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
-            S0tensors[ index ][ cnt2 ][ cnt3 ]->update( S0tensors[ index - 1 ][ cnt2 ][ cnt3 - 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
             F0tensorsT[ index ][ cnt2 ][ cnt3 ]->update( F0tensorsT[ index - 1 ][ cnt2 ][ cnt3 - 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
             F1tensorsT[ index ][ cnt2 ][ cnt3 ]->update( F1tensorsT[ index - 1 ][ cnt2 ][ cnt3 - 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
             S0tensorsT[ index ][ cnt2 ][ cnt3 ]->update( S0tensorsT[ index - 1 ][ cnt2 ][ cnt3 - 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
             if ( cnt2 > 0 ) {
-               S1tensors[ index ][ cnt2 ][ cnt3 ]->update( S1tensors[ index - 1 ][ cnt2 ][ cnt3 - 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
                S1tensorsT[ index ][ cnt2 ][ cnt3 ]->update( S1tensorsT[ index - 1 ][ cnt2 ][ cnt3 - 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
             }
          }
       }
 
+      lap( start, familyTimes[ 1 ] );
+
       // Complementary two-operator tensors : certain processes own certain
       // complementary two-operator tensors
       const int k2          = L - 1 - index;
       const int upperbound2 = ( k2 * ( k2 + 1 ) ) / 2;
-#pragma omp for schedule( static ) nowait
+
+#pragma omp for schedule( dynamic ) nowait
       for ( int global = 0; global < upperbound2; global++ ) {
          Special::invert_triangle_two( global, result );
          const int cnt2       = k2 - 1 - result[ 1 ];
@@ -1256,26 +2000,18 @@ void CheMPS2::HamiltonianOperator::updateMovingRight( const int index, CTensorT
          const int irrep_prod = CheMPS2::Irreps::directProd( bkUp->gIrrep( siteindex1 ), bkUp->gIrrep( siteindex2 ) );
          if ( index == 0 ) {
             Atensors[ index ][ cnt2 ][ cnt3 ]->clear();
-            AtensorsT[ index ][ cnt2 ][ cnt3 ]->clear();
             if ( cnt2 > 0 ) {
                Btensors[ index ][ cnt2 ][ cnt3 ]->clear();
-               BtensorsT[ index ][ cnt2 ][ cnt3 ]->clear();
             }
             Ctensors[ index ][ cnt2 ][ cnt3 ]->clear();
-            CtensorsT[ index ][ cnt2 ][ cnt3 ]->clear();
             Dtensors[ index ][ cnt2 ][ cnt3 ]->clear();
-            DtensorsT[ index ][ cnt2 ][ cnt3 ]->clear();
          } else {
             Atensors[ index ][ cnt2 ][ cnt3 ]->update( Atensors[ index - 1 ][ cnt2 ][ cnt3 + 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
-            AtensorsT[ index ][ cnt2 ][ cnt3 ]->update( AtensorsT[ index - 1 ][ cnt2 ][ cnt3 + 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
             if ( cnt2 > 0 ) {
                Btensors[ index ][ cnt2 ][ cnt3 ]->update( Btensors[ index - 1 ][ cnt2 ][ cnt3 + 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
-               BtensorsT[ index ][ cnt2 ][ cnt3 ]->update( BtensorsT[ index - 1 ][ cnt2 ][ cnt3 + 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
             }
             Ctensors[ index ][ cnt2 ][ cnt3 ]->update( Ctensors[ index - 1 ][ cnt2 ][ cnt3 + 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
-            CtensorsT[ index ][ cnt2 ][ cnt3 ]->update( CtensorsT[ index - 1 ][ cnt2 ][ cnt3 + 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
             Dtensors[ index ][ cnt2 ][ cnt3 ]->update( Dtensors[ index - 1 ][ cnt2 ][ cnt3 + 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
-            DtensorsT[ index ][ cnt2 ][ cnt3 ]->update( DtensorsT[ index - 1 ][ cnt2 ][ cnt3 + 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
          }
 
          for ( int num = 0; num < index + 1; num++ ) {
@@ -1288,67 +2024,141 @@ void CheMPS2::HamiltonianOperator::updateMovingRight( const int index, CTensorT
                   alpha += prob->gMxElement( index - num, index, siteindex2, siteindex1 );
                }
                Atensors[ index ][ cnt2 ][ cnt3 ]->zaxpy( alpha, S0tensors[ index ][ num ][ 0 ] );
-               AtensorsT[ index ][ cnt2 ][ cnt3 ]->zaxpy( alpha, S0tensorsT[ index ][ num ][ 0 ] );
 
                if ( ( num > 0 ) && ( cnt2 > 0 ) ) {
                   alpha =
                       prob->gMxElement( index - num, index, siteindex1, siteindex2 ) -
                       prob->gMxElement( index - num, index, siteindex2, siteindex1 );
                   Btensors[ index ][ cnt2 ][ cnt3 ]->zaxpy( alpha, S1tensors[ index ][ num ][ 0 ] );
-                  BtensorsT[ index ][ cnt2 ][ cnt3 ]->zaxpy( alpha, S1tensorsT[ index ][ num ][ 0 ] );
                }
 
                alpha = 2 * prob->gMxElement( index - num, siteindex1, index, siteindex2 ) -
                        prob->gMxElement( index - num, siteindex1, siteindex2, index );
                Ctensors[ index ][ cnt2 ][ cnt3 ]->zaxpy( alpha, F0tensors[ index ][ num ][ 0 ] );
+
+               alpha = -prob->gMxElement( index - num, siteindex1, siteindex2, index ); // Second line for Ctensors
+               Dtensors[ index ][ cnt2 ][ cnt3 ]->zaxpy( alpha, F1tensors[ index ][ num ][ 0 ] );
+               if ( num > 0 ) {
+                  alpha = 2 * prob->gMxElement( index - num, siteindex2, index, siteindex1 ) -
+                          prob->gMxElement( index - num, siteindex2, siteindex1, index );
+                  Ctensors[ index ][ cnt2 ][ cnt3 ]->zaxpy_tensorCD( alpha, F0tensorsT[ index ][ num ][ 0 ] );
+
+                  alpha = -prob->gMxElement( index - num, siteindex2, siteindex1, index ); // Second line for Ctensors
+                  Dtensors[ index ][ cnt2 ][ cnt3 ]->zaxpy_tensorCD( alpha, F1tensorsT[ index ][ num ][ 0 ] );
+               }
+            }
+         }
+      }
+
+#pragma omp for schedule( dynamic ) nowait
+      for ( int global = 0; global < upperbound2; global++ ) {
+         Special::invert_triangle_two( global, result );
+         const int cnt2       = k2 - 1 - result[ 1 ];
+         const int cnt3       = result[ 0 ];
+         const int siteindex1 = index + 1 + cnt3;
+         const int siteindex2 = index + 1 + cnt2 + cnt3;
+         const int irrep_prod = CheMPS2::Irreps::directProd( bkUp->gIrrep( siteindex1 ), bkUp->gIrrep( siteindex2 ) );
+         if ( index == 0 ) {
+            AtensorsT[ index ][ cnt2 ][ cnt3 ]->clear();
+            if ( cnt2 > 0 ) {
+               BtensorsT[ index ][ cnt2 ][ cnt3 ]->clear();
+            }
+            CtensorsT[ index ][ cnt2 ][ cnt3 ]->clear();
+            DtensorsT[ index ][ cnt2 ][ cnt3 ]->clear();
+         } else {
+            AtensorsT[ index ][ cnt2 ][ cnt3 ]->update( AtensorsT[ index - 1 ][ cnt2 ][ cnt3 + 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
+            if ( cnt2 > 0 ) {
+               BtensorsT[ index ][ cnt2 ][ cnt3 ]->update( BtensorsT[ index - 1 ][ cnt2 ][ cnt3 + 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
+            }
+            CtensorsT[ index ][ cnt2 ][ cnt3 ]->update( CtensorsT[ index - 1 ][ cnt2 ][ cnt3 + 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
+            DtensorsT[ index ][ cnt2 ][ cnt3 ]->update( DtensorsT[ index - 1 ][ cnt2 ][ cnt3 + 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
+         }
+
+         for ( int num = 0; num < index + 1; num++ ) {
+            if ( irrep_prod == S0tensorsT[ index ][ num ][ 0 ]->get_irrep() ) { // Then the matrix elements are not 0 due to symm.
+               double alpha = prob->gMxElement( index - num, index, siteindex1, siteindex2 );
+               if ( ( cnt2 == 0 ) && ( num == 0 ) ) {
+                  alpha *= 0.5;
+               }
+               if ( ( cnt2 > 0 ) && ( num > 0 ) ) {
+                  alpha += prob->gMxElement( index - num, index, siteindex2, siteindex1 );
+               }
+               AtensorsT[ index ][ cnt2 ][ cnt3 ]->zaxpy( alpha, S0tensorsT[ index ][ num ][ 0 ] );
+
+               if ( ( num > 0 ) && ( cnt2 > 0 ) ) {
+                  alpha =
+                      prob->gMxElement( index - num, index, siteindex1, siteindex2 ) -
+                      prob->gMxElement( index - num, index, siteindex2, siteindex1 );
+                  BtensorsT[ index ][ cnt2 ][ cnt3 ]->zaxpy( alpha, S1tensorsT[ index ][ num ][ 0 ] );
+               }
+
+               alpha = 2 * prob->gMxElement( index - num, siteindex1, index, siteindex2 ) -
+                       prob->gMxElement( index - num, siteindex1, siteindex2, index );
                CtensorsT[ index ][ cnt2 ][ cnt3 ]->zaxpy( alpha, F0tensorsT[ index ][ num ][ 0 ] );
 
                alpha = -prob->gMxElement( index - num, siteindex1, siteindex2, index ); // Second line for CtensorsT
-               Dtensors[ index ][ cnt2 ][ cnt3 ]->zaxpy( alpha, F1tensors[ index ][ num ][ 0 ] );
                DtensorsT[ index ][ cnt2 ][ cnt3 ]->zaxpy( alpha, F1tensorsT[ index ][ num ][ 0 ] );
                if ( num > 0 ) {
                   alpha = 2 * prob->gMxElement( index - num, siteindex2, index, siteindex1 ) -
                           prob->gMxElement( index - num, siteindex2, siteindex1, index );
-
-                  Ctensors[ index ][ cnt2 ][ cnt3 ]->zaxpy_tensorCD( alpha, F0tensorsT[ index ][ num ][ 0 ] );
                   CtensorsT[ index ][ cnt2 ][ cnt3 ]->zaxpy_tensorCTDT( alpha, F0tensors[ index ][ num ][ 0 ] );
 
                   alpha = -prob->gMxElement( index - num, siteindex2, siteindex1, index ); // Second line for CtensorsT
-                  Dtensors[ index ][ cnt2 ][ cnt3 ]->zaxpy_tensorCD( alpha, F1tensorsT[ index ][ num ][ 0 ] );
                   DtensorsT[ index ][ cnt2 ][ cnt3 ]->zaxpy_tensorCTDT( alpha, F1tensors[ index ][ num ][ 0 ] );
                }
             }
          }
       }
 
+      lap( start, familyTimes[ 2 ] );
+
 // QQtensors_mpsUp_MPS : certain processes own certain QQtensors_mpsUp_MPS ---
 // You don't want to locally parallellize when sending and receiving buffers!
-#pragma omp for schedule( static ) nowait
+#pragma omp for schedule( dynamic ) nowait
       for ( int cnt2 = 0; cnt2 < L - 1 - index; cnt2++ ) {
          if ( index == 0 ) {
             Qtensors[ index ][ cnt2 ]->clear();
-            QtensorsT[ index ][ cnt2 ]->clear();
             Qtensors[ index ][ cnt2 ]->AddTermSimple( mpsUp[ index ], mpsDown[ index ], NULL, NULL );
-            QtensorsT[ index ][ cnt2 ]->AddTermSimple( mpsUp[ index ], mpsDown[ index ], NULL, NULL );
          } else {
-            dcomplex * workmemBIS = new dcomplex[ dimL * dimL ];
             Qtensors[ index ][ cnt2 ]->update( Qtensors[ index - 1 ][ cnt2 + 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
-            QtensorsT[ index ][ cnt2 ]->update( QtensorsT[ index - 1 ][ cnt2 + 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
             Qtensors[ index ][ cnt2 ]->AddTermSimple( mpsUp[ index ], mpsDown[ index ], Otensors[ index - 1 ], workmem );
-            QtensorsT[ index ][ cnt2 ]->AddTermSimple( mpsUp[ index ], mpsDown[ index ], Otensors[ index - 1 ], workmem );
             Qtensors[ index ][ cnt2 ]->AddTermsL( Ltensors[ index - 1 ], LtensorsT[ index - 1 ], mpsUp[ index ], mpsDown[ index ], workmemBIS, workmem );
-            QtensorsT[ index ][ cnt2 ]->AddTermsL( Ltensors[ index - 1 ], LtensorsT[ index - 1 ], mpsUp[ index ], mpsDown[ index ], workmemBIS, workmem );
             Qtensors[ index ][ cnt2 ]->AddTermsAB( Atensors[ index - 1 ][ cnt2 + 1 ][ 0 ], Btensors[ index - 1 ][ cnt2 + 1 ][ 0 ], mpsUp[ index ], mpsDown[ index ], workmemBIS, workmem );
-            QtensorsT[ index ][ cnt2 ]->AddTermsAB( AtensorsT[ index - 1 ][ cnt2 + 1 ][ 0 ], BtensorsT[ index - 1 ][ cnt2 + 1 ][ 0 ], mpsUp[ index ], mpsDown[ index ], workmemBIS, workmem );
             Qtensors[ index ][ cnt2 ]->AddTermsCD( Ctensors[ index - 1 ][ cnt2 + 1 ][ 0 ], Dtensors[ index - 1 ][ cnt2 + 1 ][ 0 ], mpsUp[ index ], mpsDown[ index ], workmemBIS, workmem );
+         }
+      }
+
+#pragma omp for schedule( dynamic ) nowait
+      for ( int cnt2 = 0; cnt2 < L - 1 - index; cnt2++ ) {
+         if ( index == 0 ) {
+            QtensorsT[ index ][ cnt2 ]->clear();
+            QtensorsT[ index ][ cnt2 ]->AddTermSimple( mpsUp[ index ], mpsDown[ index ], NULL, NULL );
+         } else {
+            QtensorsT[ index ][ cnt2 ]->update( QtensorsT[ index - 1 ][ cnt2 + 1 ], mpsUp[ index ], mpsDown[ index ], workmem );
+            QtensorsT[ index ][ cnt2 ]->AddTermSimple( mpsUp[ index ], mpsDown[ index ], Otensors[ index - 1 ], workmem );
+            QtensorsT[ index ][ cnt2 ]->AddTermsL( Ltensors[ index - 1 ], LtensorsT[ index - 1 ], mpsUp[ index ], mpsDown[ index ], workmemBIS, workmem );
+            QtensorsT[ index ][ cnt2 ]->AddTermsAB( AtensorsT[ index - 1 ][ cnt2 + 1 ][ 0 ], BtensorsT[ index - 1 ][ cnt2 + 1 ][ 0 ], mpsUp[ index ], mpsDown[ index ], workmemBIS, workmem );
             QtensorsT[ index ][ cnt2 ]->AddTermsCD( CtensorsT[ index - 1 ][ cnt2 + 1 ][ 0 ], DtensorsT[ index - 1 ][ cnt2 + 1 ][ 0 ], mpsUp[ index ], mpsDown[ index ], workmemBIS, workmem );
-            delete[] workmemBIS;
          }
       }
 
+      lap( start, familyTimes[ 3 ] );
+
+#pragma omp critical
+      {
+         timings[ CHEMPS2_CTIME_ENV_L ]    += familyTimes[ 0 ];
+         timings[ CHEMPS2_CTIME_ENV_FS ]   += familyTimes[ 1 ];
+         timings[ CHEMPS2_CTIME_ENV_ABCD ] += familyTimes[ 2 ];
+         timings[ CHEMPS2_CTIME_ENV_Q ]    += familyTimes[ 3 ];
+      }
+
       delete[] workmem;
+      delete[] workmemBIS;
    }
 
+   struct timeval start;
+   gettimeofday( &start, NULL );
+
    // Xtensors
    if ( index == 0 ) {
       Xtensors[ index ]->update( mpsUp[ index ], mpsDown[ index ] );
@@ -1366,6 +2176,7 @@ void CheMPS2::HamiltonianOperator::updateMovingRight( const int index, CTensorT
    } else {
       Otensors[ index ]->update_ownmem( mpsUp[ index ], mpsDown[ index ], Otensors[ index - 1 ] );
    }
+   lap( start, timings[ CHEMPS2_CTIME_ENV_XO ] );
 }
 
 void CheMPS2::HamiltonianOperator::allocateTensors( const int index, const bool movingRight, SyBookkeeper * bkUp, SyBookkeeper * bkDown ) {
@@ -1668,4 +2479,34 @@ void CheMPS2::HamiltonianOperator::deleteTensors( const int index, const bool mo
 
    // Otensors
    delete Otensors[ index ];
+}
+
+long long CheMPS2::HamiltonianOperator::boundaryBytes( const int index, const bool movingRight ) const {
+   const int Nbound = movingRight ? index + 1 : L - 1 - index;
+   const int Cbound = movingRight ? L - 1 - index : index + 1;
+
+   long long size = storage( Xtensors[ index ] ) + storage( Otensors[ index ] );
+   for ( int cnt2 = 0; cnt2 < Nbound; cnt2++ ) {
+      size += storage( Ltensors[ index ][ cnt2 ] ) + storage( LtensorsT[ index ][ cnt2 ] );
+      for ( int cnt3 = 0; cnt3 < Nbound - cnt2; cnt3++ ) {
+         size += storage( F0tensors[ index ][ cnt2 ][ cnt3 ] ) + storage( F0tensorsT[ index ][ cnt2 ][ cnt3 ] );
+         size += storage( F1tensors[ index ][ cnt2 ][ cnt3 ] ) + storage( F1tensorsT[ index ][ cnt2 ][ cnt3 ] );
+         size += storage( S0tensors[ index ][ cnt2 ][ cnt3 ] ) + storage( S0tensorsT[ index ][ cnt2 ][ cnt3 ] );
+         if ( cnt2 > 0 ) {
+            size += storage( S1tensors[ index ][ cnt2 ][ cnt3 ] ) + storage( S1tensorsT[ index ][ cnt2 ][ cnt3 ] );
+         }
+      }
+   }
+   for ( int cnt2 = 0; cnt2 < Cbound; cnt2++ ) {
+      size += storage( Qtensors[ index ][ cnt2 ] ) + storage( QtensorsT[ index ][ cnt2 ] );
+      for ( int cnt3 = 0; cnt3 < Cbound - cnt2; cnt3++ ) {
+         size += storage( Atensors[ index ][ cnt2 ][ cnt3 ] ) + storage( AtensorsT[ index ][ cnt2 ][ cnt3 ] );
+         if ( cnt2 > 0 ) {
+            size += storage( Btensors[ index ][ cnt2 ][ cnt3 ] ) + storage( BtensorsT[ index ][ cnt2 ][ cnt3 ] );
+         }
+         size += storage( Ctensors[ index ][ cnt2 ][ cnt3 ] ) + storage( CtensorsT[ index ][ cnt2 ][ cnt3 ] );
+         size += storage( Dtensors[ index ][ cnt2 ][ cnt3 ] ) + storage( DtensorsT[ index ][ cnt2 ][ cnt3 ] );
+      }
+   }
+   return size * ( long long ) sizeof( dcomplex );
 }
\ No newline at end of file
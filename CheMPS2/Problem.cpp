@@ -21,9 +21,12 @@
 #include <iostream>
 #include <math.h> // fabs
 #include <stdlib.h>
+#include <algorithm>
+#include <vector>
 
 #include "Problem.h"
 #include "Irreps.h"
+#include "Lapack.h"
 #include "MPIchemps2.h"
 #include "Problem.h"
 
@@ -32,11 +35,50 @@ using std::endl;
 
 CheMPS2::Problem::Problem( const Hamiltonian * Hamin, const int TwoSin, const int Nin,
                            const int Irrepin, const int InitialIn )
-    : Ham( Hamin ), L( Ham->getL() ), TwoS( TwoSin ), N( Nin ), Irrep( Irrepin ),
-      bReorder( false ), mx_elem( NULL ), Initial( InitialIn ) {
+    : Ham( Hamin ), L( Ham->getL() ), TwoS( TwoSin ), N( Nin ), Irrep( Irrepin ), Initial( InitialIn ),
+      bReorder( false ), mx_elem( NULL ), cholesky_threshold( 0.0 ), num_cholesky( 0 ), cholesky( NULL ), cholesky_start( NULL ), mx_onebody( NULL ),
+      window_orb1( -1 ), window_orb2( -1 ), num_window( 0 ), window_slot( NULL ), window_table( NULL ) {
    checkConsistency();
 }
 
+CheMPS2::Problem::Problem( const Problem & tocopy )
+    : Ham( tocopy.Ham ), L( tocopy.L ), TwoS( tocopy.TwoS ), N( tocopy.N ), Irrep( tocopy.Irrep ), Initial( tocopy.Initial ),
+      bReorder( tocopy.bReorder ), mx_elem( NULL ), cholesky_threshold( tocopy.cholesky_threshold ), num_cholesky( tocopy.num_cholesky ),
+      cholesky( NULL ), cholesky_start( NULL ), mx_onebody( NULL ), window_orb1( -1 ), window_orb2( -1 ), num_window( 0 ), window_slot( NULL ), window_table( NULL ) {
+
+   if ( bReorder ) {
+      f1 = new int[ L ];
+      f2 = new int[ L ];
+      std::copy( tocopy.f1, tocopy.f1 + L, f1 );
+      std::copy( tocopy.f2, tocopy.f2 + L, f2 );
+   }
+   if ( tocopy.max_occu != NULL ) {
+      max_occu = new int[ L + 1 ];
+      std::copy( tocopy.max_occu, tocopy.max_occu + L + 1, max_occu );
+   }
+   if ( tocopy.min_occu != NULL ) {
+      min_occu = new int[ L + 1 ];
+      std::copy( tocopy.min_occu, tocopy.min_occu + L + 1, min_occu );
+   }
+   if ( tocopy.mx_elem != NULL ) {
+      mx_elem = new double[ L * L * L * L ];
+      std::copy( tocopy.mx_elem, tocopy.mx_elem + L * L * L * L, mx_elem );
+   }
+   if ( tocopy.cholesky != NULL ) {
+      cholesky = new double[ std::max( num_cholesky * L * L, 1 ) ];
+      std::copy( tocopy.cholesky, tocopy.cholesky + num_cholesky * L * L, cholesky );
+   }
+   if ( tocopy.cholesky_start != NULL ) {
+      const int num_irreps = Irreps::getNumberOfIrreps( gSy() );
+      cholesky_start       = new int[ num_irreps + 1 ];
+      std::copy( tocopy.cholesky_start, tocopy.cholesky_start + num_irreps + 1, cholesky_start );
+   }
+   if ( tocopy.mx_onebody != NULL ) {
+      mx_onebody = new double[ L * L ];
+      std::copy( tocopy.mx_onebody, tocopy.mx_onebody + L * L, mx_onebody );
+   }
+}
+
 CheMPS2::Problem::~Problem() {
 
    if ( bReorder ) {
@@ -45,6 +87,10 @@ CheMPS2::Problem::~Problem() {
    }
 
    if ( mx_elem != NULL ) { delete[] mx_elem; }
+   if ( cholesky != NULL ) { delete[] cholesky; }
+   if ( cholesky_start != NULL ) { delete[] cholesky_start; }
+   if ( mx_onebody != NULL ) { delete[] mx_onebody; }
+   clear_window();
    if ( max_occu != NULL ) { delete[] max_occu; }
    if ( min_occu != NULL ) { delete[] min_occu; }
 }
@@ -342,16 +388,54 @@ int CheMPS2::Problem::gf2( const int DMRGOrb ) const { return ( bReorder ) ? f2[
 
 double CheMPS2::Problem::gMxElement( const int alpha, const int beta, const int gamma, const int delta ) const {
 
-   return mx_elem[ alpha + L * ( beta + L * ( gamma + L * delta ) ) ];
+   if ( cholesky == NULL ) { return mx_elem[ alpha + L * ( beta + L * ( gamma + L * delta ) ) ]; }
+
+   // ( alpha gamma | beta delta ) is symmetric in its two pairs: a table entry exists when either pair is in the window
+   if ( window_slot != NULL ) {
+      const int slot_left = window_slot[ alpha + L * gamma ];
+      if ( slot_left >= 0 ) { return window_table[ slot_left + num_window * ( beta + L * delta ) ]; }
+      const int slot_right = window_slot[ beta + L * delta ];
+      if ( slot_right >= 0 ) { return window_table[ slot_right + num_window * ( alpha + L * gamma ) ]; }
+   }
+
+   const int irrep      = Irreps::directProd( gIrrep( alpha ), gIrrep( gamma ) );
+   const double * left  = cholesky + num_cholesky * ( alpha + L * gamma );
+   const double * right = cholesky + num_cholesky * ( beta + L * delta );
+   double value = 0.0;
+   for ( int vec = cholesky_start[ irrep ]; vec < cholesky_start[ irrep + 1 ]; vec++ ) { value += left[ vec ] * right[ vec ]; }
+   if ( alpha == gamma ) { value += mx_onebody[ beta + L * delta ]; }
+   if ( beta == delta ) { value += mx_onebody[ alpha + L * gamma ]; }
+   return value;
 }
 
 void CheMPS2::Problem::setMxElement( const int alpha, const int beta, const int gamma, const int delta, const double value ) {
 
+   if ( cholesky != NULL ) {
+      std::cerr << "Problem::setMxElement : the matrix elements are represented by Cholesky vectors and cannot be set one by one!" << std::endl;
+      return;
+   }
    mx_elem[ alpha + L * ( beta + L * ( gamma + L * delta ) ) ] = value;
 }
 
+void CheMPS2::Problem::set_cholesky_threshold( const double threshold ) {
+
+   assert( threshold >= 0.0 );
+   cholesky_threshold = threshold;
+}
+
 void CheMPS2::Problem::construct_mxelem() {
 
+   clear_window();
+   if ( cholesky_threshold > 0.0 ) {
+      construct_cholesky();
+      return;
+   }
+
+   if ( cholesky != NULL ) {
+      delete[] cholesky;
+      cholesky     = NULL;
+      num_cholesky = 0;
+   }
    if ( mx_elem == NULL ) { mx_elem = new double[ L * L * L * L ]; }
    const double prefact = 1.0 / ( N - 1 );
 
@@ -370,6 +454,175 @@ void CheMPS2::Problem::construct_mxelem() {
    }
 }
 
+void CheMPS2::Problem::construct_cholesky() {
+
+   if ( mx_elem != NULL ) {
+      delete[] mx_elem;
+      mx_elem = NULL;
+   }
+   if ( cholesky != NULL ) { delete[] cholesky; }
+   if ( mx_onebody == NULL ) { mx_onebody = new double[ L * L ]; }
+   const double prefact = 1.0 / ( N - 1 );
+
+   int * map = new int[ L ];
+   for ( int orb = 0; orb < L; orb++ ) { map[ orb ] = ( ( !bReorder ) ? orb : f2[ orb ] ); }
+   for ( int orb1 = 0; orb1 < L; orb1++ ) {
+      for ( int orb3 = 0; orb3 < L; orb3++ ) {
+         mx_onebody[ orb1 + L * orb3 ] = prefact * Ham->getTmat( map[ orb1 ], map[ orb3 ] );
+      }
+   }
+
+   /* Pivoted Cholesky decomposition of the positive semidefinite supermatrix M[ ( alpha, gamma ), ( beta, delta ) ] = Vmat( alpha, beta, gamma, delta ).
+      Only the columns of the pivots are evaluated. For localized orbitals the number of vectors grows much slower than L^2. */
+   const int num_pairs = L * L;
+   double * diagonal   = new double[ num_pairs ];
+   for ( int orb1 = 0; orb1 < L; orb1++ ) {
+      for ( int orb3 = 0; orb3 < L; orb3++ ) {
+         diagonal[ orb1 + L * orb3 ] = Ham->getVmat( map[ orb1 ], map[ orb1 ], map[ orb3 ], map[ orb3 ] );
+      }
+   }
+
+   std::vector< double * > vectors;
+   std::vector< int > pivots;
+   while ( ( int ) vectors.size() < num_pairs ) {
+      int pivot = 0;
+      for ( int pair = 1; pair < num_pairs; pair++ ) {
+         if ( diagonal[ pair ] > diagonal[ pivot ] ) { pivot = pair; }
+      }
+      if ( diagonal[ pivot ] <= cholesky_threshold ) { break; }
+
+      const int pivot1    = pivot % L;
+      const int pivot3    = pivot / L;
+      const double scale  = 1.0 / sqrt( diagonal[ pivot ] );
+      double * vector     = new double[ num_pairs ];
+      for ( int orb3 = 0; orb3 < L; orb3++ ) {
+         for ( int orb1 = 0; orb1 < L; orb1++ ) {
+            const int pair = orb1 + L * orb3;
+            double value   = Ham->getVmat( map[ orb1 ], map[ pivot1 ], map[ orb3 ], map[ pivot3 ] );
+            for ( int prev = 0; prev < ( int ) vectors.size(); prev++ ) { value -= vectors[ prev ][ pair ] * vectors[ prev ][ pivot ]; }
+            vector[ pair ] = scale * value;
+         }
+      }
+      for ( int pair = 0; pair < num_pairs; pair++ ) { diagonal[ pair ] -= vector[ pair ] * vector[ pair ]; }
+      diagonal[ pivot ] = 0.0;
+      vectors.push_back( vector );
+      pivots.push_back( pivot );
+   }
+
+   /* A vector only differs from zero on the pairs with the irrep of its pivot pair. The vectors are stored sorted by that
+      irrep, so that the ones of irrep I are cholesky_start[ I ] <= vec < cholesky_start[ I + 1 ]. */
+   Irreps SymmInfo( gSy() );
+   const int num_irreps = SymmInfo.getNumberOfIrreps();
+   if ( cholesky_start == NULL ) { cholesky_start = new int[ num_irreps + 1 ]; }
+   num_cholesky = vectors.size();
+   cholesky     = new double[ std::max( num_cholesky * num_pairs, 1 ) ];
+   int vec      = 0;
+   for ( int irrep = 0; irrep < num_irreps; irrep++ ) {
+      cholesky_start[ irrep ] = vec;
+      for ( int prev = 0; prev < num_cholesky; prev++ ) {
+         if ( Irreps::directProd( gIrrep( pivots[ prev ] % L ), gIrrep( pivots[ prev ] / L ) ) == irrep ) {
+            for ( int pair = 0; pair < num_pairs; pair++ ) { cholesky[ vec + num_cholesky * pair ] = vectors[ prev ][ pair ]; }
+            vec++;
+         }
+      }
+   }
+   cholesky_start[ num_irreps ] = vec;
+   for ( int prev = 0; prev < num_cholesky; prev++ ) { delete[] vectors[ prev ]; }
+
+   delete[] diagonal;
+   delete[] map;
+}
+
+void CheMPS2::Problem::clear_window() const {
+
+   if ( window_slot != NULL ) { delete[] window_slot; }
+   if ( window_table != NULL ) { delete[] window_table; }
+   window_slot  = NULL;
+   window_table = NULL;
+   window_orb1  = -1;
+   window_orb2  = -1;
+   num_window   = 0;
+}
+
+void CheMPS2::Problem::set_mxelem_window( const int orb1, const int orb2 ) const {
+
+   if ( cholesky == NULL ) { return; }
+   const bool has1 = ( ( orb1 == window_orb1 ) || ( orb1 == window_orb2 ) );
+   const bool has2 = ( ( orb2 == window_orb1 ) || ( orb2 == window_orb2 ) );
+   if ( ( has1 ) && ( has2 ) ) { return; }
+
+   const int num_pairs = L * L;
+   if ( window_slot == NULL ) {
+      window_slot  = new int[ num_pairs ];
+      window_table = new double[ 4 * L * num_pairs ];
+   }
+   window_orb1 = orb1;
+   window_orb2 = orb2;
+
+   // The pairs with an orbital in the window
+   num_window = 0;
+   for ( int second = 0; second < L; second++ ) {
+      for ( int first = 0; first < L; first++ ) {
+         const bool inside = ( first == orb1 ) || ( first == orb2 ) || ( second == orb1 ) || ( second == orb2 );
+         window_slot[ first + L * second ] = ( inside ) ? num_window++ : -1;
+      }
+   }
+   for ( int elem = 0; elem < num_window * num_pairs; elem++ ) { window_table[ elem ] = 0.0; }
+
+   /* Only pairs with the same irrep couple, through the vectors of that irrep, so the window is contracted irrep by irrep:
+      window_table = selected^T cholesky for the window pairs and all pairs of the irrep, plus the one-body part */
+   int * rows        = new int[ num_window ];
+   int * cols        = new int[ num_pairs ];
+   double * selected = new double[ std::max( num_cholesky * num_window, 1 ) ];
+   double * gathered = new double[ std::max( num_cholesky * num_pairs, 1 ) ];
+   double * result   = new double[ std::max( num_window * num_pairs, 1 ) ];
+   Irreps SymmInfo( gSy() );
+   for ( int irrep = 0; irrep < SymmInfo.getNumberOfIrreps(); irrep++ ) {
+      int m = 0;
+      int n = 0;
+      for ( int pair = 0; pair < num_pairs; pair++ ) {
+         if ( Irreps::directProd( gIrrep( pair % L ), gIrrep( pair / L ) ) == irrep ) {
+            if ( window_slot[ pair ] >= 0 ) { rows[ m++ ] = pair; }
+            cols[ n++ ] = pair;
+         }
+      }
+      const int first = cholesky_start[ irrep ];
+      int k           = cholesky_start[ irrep + 1 ] - first;
+      if ( ( m == 0 ) || ( k == 0 ) ) { continue; }
+      for ( int row = 0; row < m; row++ ) {
+         for ( int vec = 0; vec < k; vec++ ) { selected[ vec + k * row ] = cholesky[ first + vec + num_cholesky * rows[ row ] ]; }
+      }
+      for ( int col = 0; col < n; col++ ) {
+         for ( int vec = 0; vec < k; vec++ ) { gathered[ vec + k * col ] = cholesky[ first + vec + num_cholesky * cols[ col ] ]; }
+      }
+      char trans   = 'T';
+      char notrans = 'N';
+      double one   = 1.0;
+      double zero  = 0.0;
+      dgemm_( &trans, &notrans, &m, &n, &k, &one, selected, &k, gathered, &k, &zero, result, &m );
+      for ( int col = 0; col < n; col++ ) {
+         for ( int row = 0; row < m; row++ ) { window_table[ window_slot[ rows[ row ] ] + num_window * cols[ col ] ] = result[ row + m * col ]; }
+      }
+   }
+   for ( int second = 0; second < L; second++ ) {
+      for ( int first = 0; first < L; first++ ) {
+         const int slot = window_slot[ first + L * second ];
+         if ( slot >= 0 ) {
+            if ( first == second ) {
+               for ( int pair = 0; pair < num_pairs; pair++ ) { window_table[ slot + num_window * pair ] += mx_onebody[ pair ]; }
+            }
+            for ( int orb = 0; orb < L; orb++ ) { window_table[ slot + num_window * ( orb + L * orb ) ] += mx_onebody[ first + L * second ]; }
+         }
+      }
+   }
+
+   delete[] rows;
+   delete[] cols;
+   delete[] selected;
+   delete[] gathered;
+   delete[] result;
+}
+
 bool CheMPS2::Problem::checkConsistency() const {
 
    Irreps SymmInfo( gSy() );
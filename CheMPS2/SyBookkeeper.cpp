@@ -28,9 +28,20 @@
 #include "Options.h"
 #include "SyBookkeeper.h"
 
+unsigned long long CheMPS2::SyBookkeeper::next_id() {
+
+   // Ids start at 1 and are never reused, also not when a SyBookkeeper is reallocated at the address of a deleted one
+   static unsigned long long counter = 0;
+   unsigned long long value;
+   #pragma omp atomic capture
+   value = ++counter;
+   return value;
+}
+
 CheMPS2::SyBookkeeper::SyBookkeeper( const Problem * Prob, const int D ) {
 
    this->Prob = Prob;
+   this->id   = next_id();
    Irreps temp( Prob->gSy() );
    this->num_irreps = temp.getNumberOfIrreps();
 
@@ -52,6 +63,7 @@ CheMPS2::SyBookkeeper::SyBookkeeper( const Problem * Prob, const int D ) {
 CheMPS2::SyBookkeeper::SyBookkeeper( const SyBookkeeper & tocopy ) {
 
    this->Prob = tocopy.gProb();
+   this->id   = next_id();
    Irreps temp( Prob->gSy() );
    this->num_irreps = temp.getNumberOfIrreps();
 
@@ -76,6 +88,7 @@ CheMPS2::SyBookkeeper::SyBookkeeper( const SyBookkeeper & tocopy ) {
 CheMPS2::SyBookkeeper::SyBookkeeper( const Problem * Prob, const int * occupation ) {
 
    this->Prob = Prob;
+   this->id   = next_id();
    Irreps temp( Prob->gSy() );
    this->num_irreps = temp.getNumberOfIrreps();
 
@@ -131,6 +144,7 @@ CheMPS2::SyBookkeeper::SyBookkeeper( const Problem * Prob, const int * occupatio
 CheMPS2::SyBookkeeper::SyBookkeeper( const int site, SyBookkeeper * orig ) {
 
    this->Prob = orig->gProb();
+   this->id   = next_id();
    Irreps temp( Prob->gSy() );
    this->num_irreps = temp.getNumberOfIrreps();
 
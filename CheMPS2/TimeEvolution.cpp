@@ -4,16 +4,23 @@
 #include <iomanip>
 #include <iostream>
 #include <algorithm>
+#include <sstream>
+#include <cstdio>
+#include <vector>
+#include <sys/stat.h>
 #include <sys/time.h>
+#ifdef _OPENMP
+   #include <omp.h>
+#endif
 
+#include "CMPSio.h"
 #include "COneDM.h"
 #include "CTwoDMBuilder.h"
-#include "HamiltonianOperator.h"
 #include "Lapack.h"
 #include "TwoDMBuilder.h"
 
-CheMPS2::TimeEvolution::TimeEvolution( Problem * probIn, ConvergenceScheme * schemeIn, hid_t HDF5FILEIDIN )
-    : prob( probIn ), scheme( schemeIn ), HDF5FILEID( HDF5FILEIDIN ), L( probIn->gL() ) {
+CheMPS2::TimeEvolution::TimeEvolution( Problem * probIn, ConvergenceScheme * schemeIn, hid_t HDF5FILEIDIN, const int deflateIn )
+    : L( probIn->gL() ), prob( probIn ), scheme( schemeIn ), HDF5FILEID( HDF5FILEIDIN ), deflate( deflateIn ) {
 
    start        = time( NULL );
    tm * tmstart = localtime( &start );
@@ -54,6 +61,7 @@ CheMPS2::TimeEvolution::TimeEvolution( Problem * probIn, ConvergenceScheme * sch
    std::cout << "   N = " << N << "\n";
    std::cout << "   TwoS = " << TwoS << "\n";
    std::cout << "   I = " << I << "\n";
+   if ( prob->gNumCholesky() > 0 ) { std::cout << "   Cholesky vectors of the two-body matrix elements = " << prob->gNumCholesky() << "\n"; }
    std::cout << "\n";
    std::cout << "   Orbital ordering:\n";
    std::cout << "      ";
@@ -70,21 +78,27 @@ CheMPS2::TimeEvolution::TimeEvolution( Problem * probIn, ConvergenceScheme * sch
    std::cout << "\n";
    std::cout << hashline;
 
-   const hid_t inputGroupID             = ( HDF5FILEID != H5_CHEMPS2_TIME_NO_H5OUT ) ? H5Gcreate( HDF5FILEID, "/Input", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT ) : H5_CHEMPS2_TIME_NO_H5OUT;
-   const hid_t systemPropertiesID       = ( HDF5FILEID != H5_CHEMPS2_TIME_NO_H5OUT ) ? H5Gcreate( HDF5FILEID, "/Input/SystemProperties", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT ) : H5_CHEMPS2_TIME_NO_H5OUT;
-   const hid_t waveFunctionPropertiesID = ( HDF5FILEID != H5_CHEMPS2_TIME_NO_H5OUT ) ? H5Gcreate( HDF5FILEID, "/Input/WaveFunctionProperties", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT ) : H5_CHEMPS2_TIME_NO_H5OUT;
-   const hsize_t dimarray1              = 1;
-   const hsize_t Lsize = L;
-   const hsize_t Lposize = L + 1;
-   HDF5_MAKE_DATASET( systemPropertiesID,       "L",        1, &dimarray1, H5T_STD_I32LE, &L          );
-   HDF5_MAKE_DATASET( systemPropertiesID,       "Sy",       1, &dimarray1, H5T_STD_I32LE, &Sy         );
-   HDF5_MAKE_DATASET( systemPropertiesID,       "Irrep",    1, &Lsize,     H5T_STD_I32LE, irreps      );
-   HDF5_MAKE_DATASET( systemPropertiesID,       "Econst",   1, &dimarray1, H5T_NATIVE_DOUBLE, &Econst );
-   HDF5_MAKE_DATASET( waveFunctionPropertiesID, "N",        1, &dimarray1, H5T_STD_I32LE, &N          );
-   HDF5_MAKE_DATASET( waveFunctionPropertiesID, "TwoS",     1, &dimarray1, H5T_STD_I32LE, &TwoS       );
-   HDF5_MAKE_DATASET( waveFunctionPropertiesID, "I",        1, &dimarray1, H5T_STD_I32LE, &I          );
-   HDF5_MAKE_DATASET( waveFunctionPropertiesID, "Ham2DMRG", 1, &Lsize,     H5T_STD_I32LE, ham2dmrg    );
-   HDF5_MAKE_DATASET( waveFunctionPropertiesID, "FCIDims",  1, &Lposize,   H5T_STD_I32LE, fcidims     );
+   // A restarted run continues the output file of the interrupted run, which already contains the input
+   if ( ( HDF5FILEID != H5_CHEMPS2_TIME_NO_H5OUT ) && ( H5Lexists( HDF5FILEID, "/Input", H5P_DEFAULT ) <= 0 ) ) {
+      const hid_t inputGroupID             = H5Gcreate( HDF5FILEID, "/Input", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT );
+      const hid_t systemPropertiesID       = H5Gcreate( HDF5FILEID, "/Input/SystemProperties", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT );
+      const hid_t waveFunctionPropertiesID = H5Gcreate( HDF5FILEID, "/Input/WaveFunctionProperties", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT );
+      const hsize_t dimarray1              = 1;
+      const hsize_t Lsize = L;
+      const hsize_t Lposize = L + 1;
+      HDF5_MAKE_DATASET( systemPropertiesID,       "L",        1, &dimarray1, H5T_STD_I32LE, &L          );
+      HDF5_MAKE_DATASET( systemPropertiesID,       "Sy",       1, &dimarray1, H5T_STD_I32LE, &Sy         );
+      HDF5_MAKE_DATASET( systemPropertiesID,       "Irrep",    1, &Lsize,     H5T_STD_I32LE, irreps      );
+      HDF5_MAKE_DATASET( systemPropertiesID,       "Econst",   1, &dimarray1, H5T_NATIVE_DOUBLE, &Econst );
+      HDF5_MAKE_DATASET( waveFunctionPropertiesID, "N",        1, &dimarray1, H5T_STD_I32LE, &N          );
+      HDF5_MAKE_DATASET( waveFunctionPropertiesID, "TwoS",     1, &dimarray1, H5T_STD_I32LE, &TwoS       );
+      HDF5_MAKE_DATASET( waveFunctionPropertiesID, "I",        1, &dimarray1, H5T_STD_I32LE, &I          );
+      HDF5_MAKE_DATASET( waveFunctionPropertiesID, "Ham2DMRG", 1, &Lsize,     H5T_STD_I32LE, ham2dmrg    );
+      HDF5_MAKE_DATASET( waveFunctionPropertiesID, "FCIDims",  1, &Lposize,   H5T_STD_I32LE, fcidims     );
+      H5Gclose( waveFunctionPropertiesID );
+      H5Gclose( systemPropertiesID );
+      H5Gclose( inputGroupID );
+   }
    delete[] irreps;
    delete[] ham2dmrg;
    delete[] fcidims;
@@ -116,167 +130,339 @@ void CheMPS2::TimeEvolution::HDF5_MAKE_DATASET( hid_t setID, const char * name,
    }
 }
 
-double CheMPS2::TimeEvolution::calc1h0p( Problem * probState, CTensorT ** mpsState, SyBookkeeper * bkState, const int * hf_state ){
-   
-   const int L = prob->gL();
-   double result = 0;
+void CheMPS2::TimeEvolution::HDF5_APPEND_DATASET( hid_t setID, const char * name, int rank, const hsize_t * dims, hid_t typeID, const void * data ) {
+   if ( HDF5FILEID == H5_CHEMPS2_TIME_NO_H5OUT ) { return; }
+   assert( rank <= 4 );
 
-// PARALLEL
-#pragma omp parallel
-   {
-      int* alphas = new int[ L ];
-      int* betas = new int[ L ];
-
-      for( int idx = 0; idx < L; idx++ ){
-         if( hf_state[ idx ] == 2 ){
-            betas[ idx ] = 1;
-            alphas[ idx ] = 1;
-         } else if ( hf_state[ idx ] == 0 ) {
-            betas[ idx ] = 0;
-            alphas[ idx ] = 0;
-         } else {
-            std::cerr << "CheMPS2::TimeEvolution::calc1h0p is implemented for closed shell molecules only. Exiting..." << std::endl;
-            abort();
-         }
-      }
+   hsize_t extent[ 4 ];
+   hsize_t offset[ 4 ];
+   for ( int dim = 0; dim < rank; dim++ ) {
+      extent[ dim ] = dims[ dim ];
+      offset[ dim ] = 0;
+   }
 
-#pragma omp for schedule( dynamic )
-      for( int idx = 0; idx < L; idx++ ){
-         if( alphas[ idx ] == 1 ){
-            alphas[ idx ] = 0;
-            result += 2.0 * std::pow( std::abs( getFCICoefficient( probState, mpsState, alphas, betas ) ), 2.0 );
-            alphas[ idx ] = 1;
-         }
+   hid_t datasetID;
+   if ( H5Lexists( setID, name, H5P_DEFAULT ) > 0 ) {
+      datasetID = H5Dopen( setID, name, H5P_DEFAULT );
+      const hid_t spaceID = H5Dget_space( datasetID );
+      H5Sget_simple_extent_dims( spaceID, extent, NULL );
+      H5Sclose( spaceID );
+      offset[ 0 ] = extent[ 0 ];
+      extent[ 0 ] += dims[ 0 ];
+      H5Dset_extent( datasetID, extent );
+   } else {
+      // Chunks of about 16 KiB along the unlimited dimension, but always at least one full row
+      hsize_t maxdims[ 4 ];
+      hsize_t chunk[ 4 ];
+      hsize_t rowSize = H5Tget_size( typeID );
+      for ( int dim = 1; dim < rank; dim++ ) {
+         maxdims[ dim ] = dims[ dim ];
+         chunk[ dim ]   = dims[ dim ];
+         rowSize       *= dims[ dim ];
+      }
+      maxdims[ 0 ] = H5S_UNLIMITED;
+      chunk[ 0 ]   = std::max( ( hsize_t ) 1, ( ( hsize_t ) 16384 ) / rowSize );
+
+      const hid_t spaceID = H5Screate_simple( rank, extent, maxdims );
+      const hid_t propID  = H5Pcreate( H5P_DATASET_CREATE );
+      H5Pset_chunk( propID, rank, chunk );
+      if ( ( deflate > 0 ) && ( H5Zfilter_avail( H5Z_FILTER_DEFLATE ) > 0 ) ) {
+         H5Pset_shuffle( propID );
+         H5Pset_deflate( propID, deflate );
       }
-   
-      delete[] alphas;
-      delete[] betas;
+      datasetID = H5Dcreate( setID, name, typeID, spaceID, H5P_DEFAULT, propID, H5P_DEFAULT );
+      H5Pclose( propID );
+      H5Sclose( spaceID );
    }
 
-   return result;
+   if ( dims[ 0 ] > 0 ) {
+      const hid_t fileSpaceID = H5Dget_space( datasetID );
+      const hid_t memSpaceID  = H5Screate_simple( rank, dims, NULL );
+      H5Sselect_hyperslab( fileSpaceID, H5S_SELECT_SET, offset, NULL, dims, NULL );
+      H5Dwrite( datasetID, typeID, memSpaceID, fileSpaceID, H5P_DEFAULT, data );
+      H5Sclose( memSpaceID );
+      H5Sclose( fileSpaceID );
+   }
+   H5Dclose( datasetID );
 }
 
-double CheMPS2::TimeEvolution::calc2h1p( Problem * probState, CTensorT ** mpsState, SyBookkeeper * bkState, const int * hf_state ){
-   
-   const int L = prob->gL();
-   double result = 0;
-
-   int* alphas = new int[ L ];
-   int* betas = new int[ L ];
-
-   for( int idx = 0; idx < L; idx++ ){
-      if( hf_state[ idx ] == 2 ){
-         betas[ idx ] = 1;
-         alphas[ idx ] = 1;
-      } else if ( hf_state[ idx ] == 0 ) {
-         betas[ idx ] = 0;
-         alphas[ idx ] = 0;
-      } else {
-         std::cerr << "CheMPS2::TimeEvolution::calc2h1p is implemented for closed shell molecules only. Exiting..." << std::endl;
-         abort();
-      }
+void CheMPS2::TimeEvolution::writeCheckpoint( const std::string filename, const char time_type, const double time_step_major, const double time_step_minor,
+                                              const double t, const double chrono, const double time_step,
+                                              const long long fciTotal, const hid_t outputID, CTensorT ** mps, SyBookkeeper * bk ) {
+
+   /* The checkpoint is written to a temporary file, which then replaces the previous checkpoint with a rename. A run which is
+      killed while writing hence always leaves a complete checkpoint behind. The output is flushed first, so that the series on
+      disk are at least as long as the lengths which are recorded in the checkpoint. */
+   if ( outputID != H5_CHEMPS2_TIME_NO_H5OUT ) { H5Fflush( outputID, H5F_SCOPE_GLOBAL ); }
+
+   const std::string temporary = filename + ".tmp";
+   const hid_t fileID          = H5Fcreate( temporary.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT );
+   const hsize_t dimarray1     = 1;
+   const int N                 = prob->gN();
+   const int TwoS              = prob->gTwoS();
+   const int I                 = prob->gIrrep();
+   const int type              = time_type;
+   H5LTmake_dataset( fileID, "L",        1, &dimarray1, H5T_STD_I32LE,     &L         );
+   H5LTmake_dataset( fileID, "N",        1, &dimarray1, H5T_STD_I32LE,     &N         );
+   H5LTmake_dataset( fileID, "TwoS",     1, &dimarray1, H5T_STD_I32LE,     &TwoS      );
+   H5LTmake_dataset( fileID, "I",        1, &dimarray1, H5T_STD_I32LE,     &I         );
+
+   // The input of the run, which a restart should repeat
+   const hsize_t numInst = scheme->get_number();
+   std::vector< int > MaxMs( numInst );
+   std::vector< double > CutOs( numInst );
+   std::vector< int > NSwes( numInst );
+   std::vector< double > FitTs( numInst );
+   for ( int inst = 0; inst < ( int ) numInst; inst++ ) {
+      MaxMs[ inst ] = scheme->get_D( inst );
+      CutOs[ inst ] = scheme->get_cut_off( inst );
+      NSwes[ inst ] = scheme->get_max_sweeps( inst );
+      FitTs[ inst ] = scheme->get_fit_tolerance( inst );
    }
-
-   for( int a = 0; a < L; a++ ){
-      for( int i = 0; i < L; i++ ){
-         for( int j = 0; j < i; j++ ){
-            for( int twoKappa = -1; twoKappa <= 1; twoKappa+=2 ){
-               for( int twoTau = -1; twoTau <= 1; twoTau+=2 ){
-                  for( int twoSigma = -1; twoSigma <= 1; twoSigma+=2 ){
-                     int * toCreate = ( twoKappa == -1 ) ? alphas : betas;
-                     int * toAnniA = ( twoTau == -1 ) ? alphas : betas;
-                     int * toAnniB = ( twoSigma == -1 ) ? alphas : betas;
-
-                     toCreate[ a ]++;
-                     toAnniA[ i ]--;
-                     toAnniB[ j ]--;
-
-                     if( ( toAnniB[ j ] >= 0 ) && ( toAnniA[ i ] >= 0 ) && ( toCreate[ a ] <= 1 ) && ( i != j ) && ( i != a ) && ( j != a ) ){
-                        result += std::pow( std::abs( getFCICoefficient( probState, mpsState, alphas, betas ) ), 2.0 );
-                     }
-
-                     toCreate[ a ]--;
-                     toAnniA[ i ]++;
-                     toAnniB[ j ]++;
-
-                  }
-               }
-            }
+   H5LTmake_dataset( fileID, "TimeType", 1, &dimarray1, H5T_STD_I32LE,     &type            );
+   H5LTmake_dataset( fileID, "dtmajor",  1, &dimarray1, H5T_NATIVE_DOUBLE, &time_step_major );
+   H5LTmake_dataset( fileID, "dtinput",  1, &dimarray1, H5T_NATIVE_DOUBLE, &time_step_minor );
+   H5LTmake_dataset( fileID, "MaxMs",    1, &numInst,   H5T_STD_I32LE,     &MaxMs[ 0 ]      );
+   H5LTmake_dataset( fileID, "CutOs",    1, &numInst,   H5T_NATIVE_DOUBLE, &CutOs[ 0 ]      );
+   H5LTmake_dataset( fileID, "NSwes",    1, &numInst,   H5T_STD_I32LE,     &NSwes[ 0 ]      );
+   H5LTmake_dataset( fileID, "FitTs",    1, &numInst,   H5T_NATIVE_DOUBLE, &FitTs[ 0 ]      );
+
+   // The state of the integrator
+   H5LTmake_dataset( fileID, "t",        1, &dimarray1, H5T_NATIVE_DOUBLE, &t         );
+   H5LTmake_dataset( fileID, "chrono",   1, &dimarray1, H5T_NATIVE_DOUBLE, &chrono    );
+   H5LTmake_dataset( fileID, "dtminor",  1, &dimarray1, H5T_NATIVE_DOUBLE, &time_step );
+   H5LTmake_dataset( fileID, "FCITotal", 1, &dimarray1, H5T_STD_I64LE,     &fciTotal  );
+
+   // The MPS itself in the packed format
+   writePackedMPS( fileID, mps, bk, deflate );
+
+   // The number of data points ( rows ) of every chunked output series
+   const hid_t seriesID = H5Gcreate( fileID, "Series", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT );
+   if ( outputID != H5_CHEMPS2_TIME_NO_H5OUT ) {
+      H5G_info_t info;
+      H5Gget_info( outputID, &info );
+      for ( hsize_t idx = 0; idx < info.nlinks; idx++ ) {
+         char name[ 256 ];
+         H5Lget_name_by_idx( outputID, ".", H5_INDEX_NAME, H5_ITER_INC, idx, name, 256, H5P_DEFAULT );
+         const hid_t datasetID = H5Dopen( outputID, name, H5P_DEFAULT );
+         const hid_t spaceID   = H5Dget_space( datasetID );
+         hsize_t extent[ 4 ];
+         hsize_t maxdims[ 4 ];
+         if ( ( H5Sget_simple_extent_ndims( spaceID ) <= 4 ) && ( H5Sget_simple_extent_dims( spaceID, extent, maxdims ) > 0 ) && ( maxdims[ 0 ] == H5S_UNLIMITED ) ) {
+            const long long rows = extent[ 0 ];
+            H5LTmake_dataset( seriesID, name, 1, &dimarray1, H5T_STD_I64LE, &rows );
          }
+         H5Sclose( spaceID );
+         H5Dclose( datasetID );
       }
    }
+   H5Gclose( seriesID );
+   H5Fclose( fileID );
 
-   delete[] alphas;
-   delete[] betas;
-
-   return result;
+   if ( std::rename( temporary.c_str(), filename.c_str() ) != 0 ) {
+      std::cerr << "   Could not move the checkpoint " << temporary << " to " << filename << "\n";
+   }
 }
 
+bool CheMPS2::TimeEvolution::checkpointMatches( const std::string filename, const char time_type, const double time_step_major, const double time_step_minor,
+                                                SyBookkeeper * bk ) const {
 
-double CheMPS2::TimeEvolution::calcWieght( int nHoles, int nParticles, Problem * probState, CTensorT ** mpsState, SyBookkeeper * bkState, const int * hf_state ){
+   struct stat file_info;
+   if ( stat( filename.c_str(), &file_info ) != 0 ) { return true; }
 
-   if( ( nHoles == 1 ) && ( nParticles == 0 ) ){
-      return calc1h0p( probState, mpsState, bkState, hf_state );
+   /* The time steps and the scheme are parsed from the same input text in both runs, so they are compared exactly. Checkpoints
+      without the input of the run are refused as well, as nothing guarantees that the restart repeats it. */
+   const hid_t fileID    = H5Fopen( filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT );
+   const hsize_t numInst = scheme->get_number();
+   const char * names[]  = { "L", "N", "TwoS", "I", "TimeType", "dtmajor", "dtinput", "MaxMs", "CutOs", "NSwes", "FitTs" };
+   bool complete         = true;
+   for ( int item = 0; item < 11; item++ ) {
+      if ( H5Lexists( fileID, names[ item ], H5P_DEFAULT ) <= 0 ) { complete = false; }
    }
+   hsize_t numStored = 0;
+   if ( complete ) { H5LTget_dataset_info( fileID, "MaxMs", &numStored, NULL, NULL ); }
+
+   bool sameProblem = false;
+   bool sameInput   = false;
+   if ( complete && ( numStored == numInst ) ) {
+      int sizes[ 5 ];
+      H5LTread_dataset_int( fileID, "L",        sizes     );
+      H5LTread_dataset_int( fileID, "N",        sizes + 1 );
+      H5LTread_dataset_int( fileID, "TwoS",     sizes + 2 );
+      H5LTread_dataset_int( fileID, "I",        sizes + 3 );
+      H5LTread_dataset_int( fileID, "TimeType", sizes + 4 );
+      double steps[ 2 ];
+      H5LTread_dataset_double( fileID, "dtmajor", steps     );
+      H5LTread_dataset_double( fileID, "dtinput", steps + 1 );
+      std::vector< int > MaxMs( numInst );
+      std::vector< double > CutOs( numInst );
+      std::vector< int > NSwes( numInst );
+      std::vector< double > FitTs( numInst );
+      H5LTread_dataset_int( fileID, "MaxMs", &MaxMs[ 0 ] );
+      H5LTread_dataset_double( fileID, "CutOs", &CutOs[ 0 ] );
+      H5LTread_dataset_int( fileID, "NSwes", &NSwes[ 0 ] );
+      H5LTread_dataset_double( fileID, "FitTs", &FitTs[ 0 ] );
+
+      // The virtual dimensions are only compared, the bookkeeper of the run is not touched
+      SyBookkeeper trial( *bk );
+      sameProblem = ( sizes[ 0 ] == L ) && ( sizes[ 1 ] == prob->gN() ) && ( sizes[ 2 ] == prob->gTwoS() ) && ( sizes[ 3 ] == prob->gIrrep() )
+                 && ( readPackedDIM( fileID, &trial ) );
+      sameInput   = ( sizes[ 4 ] == time_type ) && ( steps[ 0 ] == time_step_major ) && ( steps[ 1 ] == time_step_minor );
+      for ( int inst = 0; inst < ( int ) numInst; inst++ ) {
+         sameInput = sameInput && ( MaxMs[ inst ] == scheme->get_D( inst ) ) && ( CutOs[ inst ] == scheme->get_cut_off( inst ) )
+                               && ( NSwes[ inst ] == scheme->get_max_sweeps( inst ) ) && ( FitTs[ inst ] == scheme->get_fit_tolerance( inst ) );
+      }
+   }
+   H5Fclose( fileID );
 
-   if( ( nHoles == 2 ) && ( nParticles == 1 ) ){
-      return calc2h1p( probState, mpsState, bkState, hf_state );
+   if ( sameProblem == false ) {
+      std::cerr << "TimeEvolution::Propagate : the checkpoint " << filename << " belongs to another problem!" << std::endl;
+   } else if ( sameInput == false ) {
+      std::cerr << "TimeEvolution::Propagate : the checkpoint " << filename << " was written with another TIME_TYPE, time step or convergence scheme!" << std::endl;
    }
+   return ( sameProblem && sameInput );
+}
 
+bool CheMPS2::TimeEvolution::readCheckpoint( const std::string filename, double * t, double * chrono, double * time_step,
+                                             long long * fciTotal, const hid_t outputID, CTensorT ** mps, SyBookkeeper * bk ) {
 
-   const int L = prob->gL();
-   double result = 0;
+   struct stat file_info;
+   if ( stat( filename.c_str(), &file_info ) != 0 ) {
+      std::cout << "   No checkpoint " << filename << " found: starting from the initial state\n";
+      return false;
+   }
+
+   const hid_t fileID = H5Fopen( filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT );
+   readPackedDIM( fileID, bk );
+
+   H5LTread_dataset_double( fileID, "t",       t         );
+   H5LTread_dataset_double( fileID, "chrono",  chrono    );
+   H5LTread_dataset_double( fileID, "dtminor", time_step );
+   H5LTread_dataset( fileID, "FCITotal", H5T_NATIVE_LLONG, fciTotal );
 
-   int* myoccus = new int[ 2 * L ];
-   for( int idx = 0; idx < 2 * L; idx++ ){
-      if( idx < prob->gN() ){
-         myoccus[ idx ] = 1;
-      } else {
-         myoccus[ idx ] = 0;
+   for ( int site = 0; site < L; site++ ) {
+      mps[ site ]->sBK( bk );
+      mps[ site ]->Reset();
+   }
+   readPackedMPS( fileID, L, mps );
+
+   // Data points which were written after the checkpoint are evaluated again, so the output series are cut back to the checkpoint
+   if ( outputID != H5_CHEMPS2_TIME_NO_H5OUT ) {
+      const hid_t seriesID = H5Gopen( fileID, "Series", H5P_DEFAULT );
+      H5G_info_t info;
+      H5Gget_info( seriesID, &info );
+      for ( hsize_t idx = 0; idx < info.nlinks; idx++ ) {
+         char name[ 256 ];
+         H5Lget_name_by_idx( seriesID, ".", H5_INDEX_NAME, H5_ITER_INC, idx, name, 256, H5P_DEFAULT );
+         long long rows;
+         H5LTread_dataset( seriesID, name, H5T_NATIVE_LLONG, &rows );
+         if ( H5Lexists( outputID, name, H5P_DEFAULT ) > 0 ) {
+            const hid_t datasetID = H5Dopen( outputID, name, H5P_DEFAULT );
+            const hid_t spaceID   = H5Dget_space( datasetID );
+            hsize_t extent[ 4 ];
+            H5Sget_simple_extent_dims( spaceID, extent, NULL );
+            H5Sclose( spaceID );
+            extent[ 0 ] = rows;
+            H5Dset_extent( datasetID, extent );
+            H5Dclose( datasetID );
+         }
       }
+      H5Gclose( seriesID );
    }
 
-   std::sort( myoccus, myoccus + 2 * L );
-   do {
-
-      bool alphaEqualsBeta = true;
+   H5Fclose( fileID );
+   return true;
+}
 
-      int* alphas = &myoccus[ 0 ];
-      int* betas = &myoccus[ L ];
+void CheMPS2::TimeEvolution::calcWeights( const int nWeights, const int * nHoles, const int * nParticles, Problem * probState, CTensorT ** mpsState, SyBookkeeper * bkState, const int * hf_state, double * weights ){
 
-      int iHoles = 0;
-      int iParticles = 0;
+   /* The weight of an excitation class only depends on the spatial orbital occupations, and the projector onto a local
+      occupation is a spin scalar which selects the MPS blocks with NR - NL = n. The overlap < mps | P | mps > is hence
+      contracted from left to right, with one overlap environment per ( holes, particles ) class. The environments are
+      only kept up to the largest requested numbers of holes and particles, as both can only increase along the chain. */
+   const int L = probState->gL();
 
-      for( int idx = 0; idx < L; idx++ ) { 
-         if ( alphas[ idx ] + betas[ idx ] < hf_state[ idx ] ){
-            iHoles += hf_state[ idx ] - ( alphas[ idx ] + betas[ idx ] );
+   int maxHoles     = 0;
+   int maxParticles = 0;
+   for ( int iWeight = 0; iWeight < nWeights; iWeight++ ){
+      maxHoles     = std::max( maxHoles,     nHoles[ iWeight ] );
+      maxParticles = std::max( maxParticles, nParticles[ iWeight ] );
+   }
+   const int nClasses = ( maxHoles + 1 ) * ( maxParticles + 1 );
+
+   CTensorO ** current = new CTensorO *[ nClasses ];
+   CTensorO ** next    = new CTensorO *[ nClasses ];
+   for ( int cls = 0; cls < nClasses; cls++ ){ current[ cls ] = NULL; }
+
+   for ( int site = 0; site < L; site++ ){
+      const int hf = hf_state[ ( probState->gReorder() ) ? probState->gf2( site ) : site ];
+      for ( int cls = 0; cls < nClasses; cls++ ){ next[ cls ] = NULL; }
+
+      for ( int nLocal = 0; nLocal <= 2; nLocal++ ){
+         const int dHoles     = std::max( 0, hf - nLocal );
+         const int dParticles = std::max( 0, nLocal - hf );
+
+         // The MPS tensor with only the blocks of local occupation nLocal
+         CTensorT * projected = new CTensorT( mpsState[ site ] );
+         bool isZero = true;
+         for ( int ikappa = 0; ikappa < projected->gNKappa(); ikappa++ ){
+            if ( projected->gNR( ikappa ) - projected->gNL( ikappa ) != nLocal ){
+               for ( int elem = projected->gKappa2index( ikappa ); elem < projected->gKappa2index( ikappa + 1 ); elem++ ){ projected->gStorage()[ elem ] = 0.0; }
+            } else if ( projected->gKappa2index( ikappa + 1 ) > projected->gKappa2index( ikappa ) ){
+               isZero = false;
+            }
          }
-         alphaEqualsBeta = alphaEqualsBeta && ( alphas[ idx ] == betas[ idx ] );
-      }
 
-      for( int idx = 0; idx < L; idx++ ) { 
-         if ( alphas[ idx ] + betas[ idx ] > hf_state[ idx ] ){
-            iParticles += ( alphas[ idx ] + betas[ idx ] ) - hf_state[ idx ];
+         for ( int holes = 0; ( !isZero ) && ( holes + dHoles <= maxHoles ); holes++ ){
+            for ( int particles = 0; particles + dParticles <= maxParticles; particles++ ){
+               const int from = holes + ( maxHoles + 1 ) * particles;
+               const int to   = ( holes + dHoles ) + ( maxHoles + 1 ) * ( particles + dParticles );
+               if ( ( site == 0 ) && ( from != 0 ) ){ continue; }
+               if ( ( site > 0 ) && ( current[ from ] == NULL ) ){ continue; }
+
+               CTensorO * contribution = new CTensorO( site + 1, true, bkState, bkState );
+               if ( site == 0 ){
+                  contribution->create( mpsState[ site ], projected );
+               } else {
+                  contribution->update_ownmem( mpsState[ site ], projected, current[ from ] );
+               }
+               if ( next[ to ] == NULL ){
+                  next[ to ] = contribution;
+               } else {
+                  next[ to ]->zaxpy( 1.0, contribution );
+                  delete contribution;
+               }
+            }
          }
+         delete projected;
       }
 
-      if( ( iHoles == nHoles ) && ( iParticles == nParticles ) ){
-         result += std::pow( std::abs( getFCICoefficient( probState, mpsState, alphas, betas ) ), 2.0 );
+      for ( int cls = 0; cls < nClasses; cls++ ){
+         if ( current[ cls ] != NULL ){ delete current[ cls ]; }
+         current[ cls ] = next[ cls ];
       }
+   }
 
-   } while ( std::next_permutation( myoccus, myoccus + 2 * L ) );
-
-   delete[] myoccus;
+   for ( int iWeight = 0; iWeight < nWeights; iWeight++ ){
+      weights[ iWeight ] = 0.0;
+      if ( ( nHoles[ iWeight ] >= 0 ) && ( nParticles[ iWeight ] >= 0 ) ){
+         CTensorO * env = current[ nHoles[ iWeight ] + ( maxHoles + 1 ) * nParticles[ iWeight ] ];
+         if ( env != NULL ){ weights[ iWeight ] = std::real( env->trace() ); }
+      }
+   }
 
-   return result;
+   for ( int cls = 0; cls < nClasses; cls++ ){
+      if ( current[ cls ] != NULL ){ delete current[ cls ]; }
+   }
+   delete[] current;
+   delete[] next;
 }
 
 
-void CheMPS2::TimeEvolution::doStep_euler( const double time_step, const int kry_size, dcomplex offset, const bool backwards, CTensorT ** mpsIn, SyBookkeeper * bkIn, CTensorT ** mpsOut, SyBookkeeper * bkOut ) {
+void CheMPS2::TimeEvolution::doStep_euler( const double time_step, const int kry_size, HamiltonianOperator * op, const bool backwards, CTensorT ** mpsIn, SyBookkeeper * bkIn, CTensorT ** mpsOut, SyBookkeeper * bkOut ) {
 
    dcomplex step = backwards ? dcomplex( 0.0, 1.0 * time_step ) : dcomplex( 0.0, -1.0 * time_step );
 
-   HamiltonianOperator * op = new HamiltonianOperator( prob, offset );
 
    SyBookkeeper * bkTemp = new SyBookkeeper( prob, scheme->get_D( 0 ) );
    CTensorT ** mpsTemp   = new CTensorT *[ L ];
@@ -308,16 +494,14 @@ void CheMPS2::TimeEvolution::doStep_euler( const double time_step, const int kry
    delete bkTemp;
    delete[] states;
    delete[] bkers;
-   delete op;
    delete coefs;
 
 }
 
-void CheMPS2::TimeEvolution::doStep_runge_kutta( const double time_step, const int kry_size, dcomplex offset, const bool backwards, CTensorT ** mpsIn, SyBookkeeper * bkIn, CTensorT ** mpsOut, SyBookkeeper * bkOut ) {
+double CheMPS2::TimeEvolution::doStep_runge_kutta( const double time_step, const int kry_size, HamiltonianOperator * op, const bool backwards, const char apply, CTensorT ** mpsIn, SyBookkeeper * bkIn, CTensorT ** mpsOut, SyBookkeeper * bkOut ) {
 
    dcomplex step = backwards ? dcomplex( 0.0, 1.0 * time_step ) : dcomplex( 0.0, -1.0 * time_step );
 
-   HamiltonianOperator * op = new HamiltonianOperator( prob, offset );
 
    ////////////////////////////////////////////////////////////////////////////////////////
    ////
@@ -344,7 +528,7 @@ void CheMPS2::TimeEvolution::doStep_runge_kutta( const double time_step, const i
       }
       normalize( L, rungeKuttaVectors[ 1 ] );
 
-      op->DSApply( mpsIn, bkIn, rungeKuttaVectors[ 1 ], rungeKuttaSyBookkeepers[ 1 ], scheme );
+      op->DSApply( mpsIn, bkIn, rungeKuttaVectors[ 1 ], rungeKuttaSyBookkeepers[ 1 ], scheme, 1.0, apply );
       scale( step, L, rungeKuttaVectors[ 1 ] );
    }
 
@@ -376,7 +560,7 @@ void CheMPS2::TimeEvolution::doStep_runge_kutta( const double time_step, const i
       }
       normalize( L, rungeKuttaVectors[ 2 ] );
 
-      op->DSApply( mpsTemp, bkTemp, rungeKuttaVectors[ 2 ], rungeKuttaSyBookkeepers[ 2 ], scheme );
+      op->DSApply( mpsTemp, bkTemp, rungeKuttaVectors[ 2 ], rungeKuttaSyBookkeepers[ 2 ], scheme, 1.0, apply );
       scale( step, L, rungeKuttaVectors[ 2 ] );
 
       for ( int site = 0; site < L; site++ ) {
@@ -417,7 +601,7 @@ void CheMPS2::TimeEvolution::doStep_runge_kutta( const double time_step, const i
       }
       normalize( L, rungeKuttaVectors[ 3 ] );
 
-      op->DSApply( mpsTemp, bkTemp, rungeKuttaVectors[ 3 ], rungeKuttaSyBookkeepers[ 3 ], scheme );
+      op->DSApply( mpsTemp, bkTemp, rungeKuttaVectors[ 3 ], rungeKuttaSyBookkeepers[ 3 ], scheme, 1.0, apply );
       scale( step, L, rungeKuttaVectors[ 3 ] );
 
       for ( int site = 0; site < L; site++ ) {
@@ -457,7 +641,7 @@ void CheMPS2::TimeEvolution::doStep_runge_kutta( const double time_step, const i
       }
       normalize( L, rungeKuttaVectors[ 4 ] );
 
-      op->DSApply( mpsTemp, bkTemp, rungeKuttaVectors[ 4 ], rungeKuttaSyBookkeepers[ 4 ], scheme );
+      op->DSApply( mpsTemp, bkTemp, rungeKuttaVectors[ 4 ], rungeKuttaSyBookkeepers[ 4 ], scheme, 1.0, apply );
       scale( step, L, rungeKuttaVectors[ 4 ] );
 
       for ( int site = 0; site < L; site++ ) {
@@ -473,6 +657,19 @@ void CheMPS2::TimeEvolution::doStep_runge_kutta( const double time_step, const i
    dcomplex coefs[] = { 1.0, 1.0 / 6.0, 2.0 / 6.0, 2.0 / 6.0, 1.0 / 6.0 };
    op->DSSum( 5, &coefs[0], rungeKuttaVectors, rungeKuttaSyBookkeepers, mpsOut, bkOut, scheme );
 
+   /* For the linear, autonomous Schroedinger equation the stages satisfy k1 - 2 k3 + k4 = ( step H )^4 | mpsIn > / 4, so the
+      fourth order term ( k1 - 2 k3 + k4 ) / 6 is the difference with the embedded third order solution. Its norm is
+      evaluated with the overlaps of the stages, without fitting another MPS. */
+   const int embedded[]         = { 1, 3, 4 };
+   const double embeddedCoefs[] = { 1.0 / 6.0, -2.0 / 6.0, 1.0 / 6.0 };
+   dcomplex difference = 0.0;
+   for ( int i = 0; i < 3; i++ ) {
+      for ( int j = 0; j < 3; j++ ) {
+         difference += embeddedCoefs[ i ] * embeddedCoefs[ j ] * overlap( rungeKuttaVectors[ embedded[ i ] ], rungeKuttaVectors[ embedded[ j ] ] );
+      }
+   }
+   const double errorEstimate = sqrt( std::abs( difference ) );
+
    for ( int cnt = 1; cnt < 5; cnt++ ) {
       for ( int site = 0; site < L; site++ ) {
          delete rungeKuttaVectors[ cnt ][ site ];
@@ -480,44 +677,60 @@ void CheMPS2::TimeEvolution::doStep_runge_kutta( const double time_step, const i
    delete[] rungeKuttaVectors[ cnt ];
    delete rungeKuttaSyBookkeepers[ cnt ];
    }
-   delete op;
+
+   return errorEstimate;
 }
 
-void CheMPS2::TimeEvolution::doStep_arnoldi( const double time_step, 
-                                             const int kry_size, 
-                                             dcomplex offset, 
-                                             const bool backwards, 
-                                             const bool do_ortho,
-                                             CTensorT ** mpsIn, 
-                                             SyBookkeeper * bkIn, 
-                                             CTensorT ** mpsOut, 
-                                             SyBookkeeper * bkOut ) {
+void CheMPS2::TimeEvolution::doStep_tdvp( const double time_step, const int kry_size, HamiltonianOperator * op, const bool backwards, const bool twoSite, const double tolerance, CTensorT ** mps, SyBookkeeper * bk ) {
+
+   dcomplex step = backwards ? dcomplex( 0.0, 1.0 * time_step ) : dcomplex( 0.0, -1.0 * time_step );
+
+   /* The TDVP sweep evolves the MPS in place, with its own bookkeeper, so that the boundary operators of the last
+      sweep are reused by the next step */
+   op->TDVP( step, twoSite, mps, bk, scheme, kry_size, tolerance );
+
+}
 
-   int krylovSpaceDimension = kry_size;
-   char notrans = 'N';
-   char trans = 'C';
+double CheMPS2::TimeEvolution::doStep_arnoldi( const double time_step, 
+                                               const int kry_size, 
+                                               HamiltonianOperator * op, 
+                                               const bool backwards, 
+                                               const bool do_ortho,
+                                               const double tolerance,
+                                               const char apply,
+                                               CTensorT ** mpsIn, 
+                                               SyBookkeeper * bkIn, 
+                                               CTensorT ** mpsOut, 
+                                               SyBookkeeper * bkOut ) {
 
    dcomplex step = backwards ? dcomplex( 0.0, 1.0 * time_step ) : dcomplex( 0.0, -1.0 * time_step );
 
-   HamiltonianOperator * op = new HamiltonianOperator( prob, offset );
+   /* Hermitian Lanczos: every new vector is fitted as H | j > - alpha_j | j > - beta_j | j - 1 > with DSApplyAndAdd, so that only
+      the tridiagonal coefficients are needed. With do_ortho, the previous vectors are projected out as well. The recursion stops
+      as soon as the a-posteriori estimate beta_m dt | [ exp( step T_m ) ]_{m-1,0} | of the error drops below the tolerance ( or
+      1e-10 when the time step is not adaptive ), or after kry_size vectors. The starting vector is mpsIn / norm( mpsIn ). */
+   const double threshold = ( tolerance > 0.0 ) ? tolerance : 1e-10;
 
    ////////////////////////////////////////////////////////////////////////////////////////
    ////
-   //// Generating Krylov Space vectors
+   //// Generating Lanczos vectors
    ////
    ////////////////////////////////////////////////////////////////////////////////////////
-   std::cout << "  Krylov space vectors:\n";
+   std::cout << "  Lanczos vectors:\n";
 
-   CTensorT *** krylovBasisVectors          = new CTensorT **[ krylovSpaceDimension ];
-   SyBookkeeper ** krylovBasisSyBookkeepers = new SyBookkeeper *[ krylovSpaceDimension ];
+   CTensorT *** krylovBasisVectors          = new CTensorT **[ kry_size ];
+   SyBookkeeper ** krylovBasisSyBookkeepers = new SyBookkeeper *[ kry_size ];
+   double * alpha                           = new double[ kry_size ];
+   double * beta                            = new double[ kry_size + 1 ];
+   double * scales                          = new double[ kry_size ];
+   dcomplex * coef                          = new dcomplex[ kry_size ];
 
-
-   dcomplex * krylovHamiltonian = new dcomplex[ krylovSpaceDimension * krylovSpaceDimension ];
-   dcomplex * overlaps          = new dcomplex[ krylovSpaceDimension * krylovSpaceDimension ];
-
-   // First vector is starting state
+   const double normIn           = norm( mpsIn );
    krylovBasisVectors[ 0 ]       = mpsIn;
    krylovBasisSyBookkeepers[ 0 ] = bkIn;
+   scales[ 0 ]                   = 1.0 / normIn;
+   beta[ 0 ]                     = 0.0;
+
    std::cout << "      i = " << 0 << " ";
    std::cout << "MPS dimensions:";
    for (int i = 0; i <= L; i++){
@@ -525,514 +738,644 @@ void CheMPS2::TimeEvolution::doStep_arnoldi( const double time_step,
    }
    std::cout << std::endl;
 
-   krylovHamiltonian[ 0 + 0 * krylovSpaceDimension ] = op->Overlap( krylovBasisVectors[ 0 ], krylovBasisSyBookkeepers[ 0 ], krylovBasisVectors[ 0 ], krylovBasisSyBookkeepers[ 0 ] );
-   overlaps[ 0 + 0 * krylovSpaceDimension ]          = overlap( krylovBasisVectors[ 0 ], krylovBasisVectors[ 0 ] );
-
-   for ( int kry = 1; kry < krylovSpaceDimension; kry++ ) {
+   int dim              = 0;
+   double errorEstimate = 0.0;
+   while ( dim < kry_size ) {
 
       struct timeval start, end;
       gettimeofday( &start, NULL );
 
-      SyBookkeeper * bkTemp = new SyBookkeeper( *krylovBasisSyBookkeepers[ kry - 1 ] );
+      const int kry = dim;
+      alpha[ kry ]  = std::real( op->Overlap( krylovBasisVectors[ kry ], krylovBasisSyBookkeepers[ kry ], krylovBasisVectors[ kry ], krylovBasisSyBookkeepers[ kry ] ) ) * scales[ kry ] * scales[ kry ];
+      dim++;
+
+      // Residual H | kry > - alpha | kry > - beta | kry - 1 > ( - the other previous vectors with do_ortho ), up to the factor 1 / scales[ kry ]
+      const int numAdd            = ( do_ortho ) ? kry + 1 : std::min( kry + 1, 2 );
+      dcomplex * coefs            = new dcomplex[ numAdd ];
+      CTensorT *** states         = new CTensorT **[ numAdd ];
+      SyBookkeeper ** bookkeepers = new SyBookkeeper *[ numAdd ];
+      for ( int i = 0; i < numAdd; i++ ) {
+         const int vec = kry - i;
+         if ( vec == kry ) {
+            coefs[ i ] = -alpha[ kry ];
+         } else if ( vec == kry - 1 ) {
+            coefs[ i ] = -beta[ kry ] * scales[ vec ] / scales[ kry ];
+         } else {
+            coefs[ i ] = -op->Overlap( krylovBasisVectors[ vec ], krylovBasisSyBookkeepers[ vec ], krylovBasisVectors[ kry ], krylovBasisSyBookkeepers[ kry ] ) * scales[ vec ] * scales[ vec ];
+         }
+         states[ i ]      = krylovBasisVectors[ vec ];
+         bookkeepers[ i ] = krylovBasisSyBookkeepers[ vec ];
+      }
+
+      SyBookkeeper * bkTemp = new SyBookkeeper( *krylovBasisSyBookkeepers[ kry ] );
       CTensorT ** mpsTemp   = new CTensorT *[ L ];
       for ( int index = 0; index < L; index++ ) {
          mpsTemp[ index ] = new CTensorT( index, bkTemp );
          mpsTemp[ index ]->random();
       }
-      normalize( L, mpsTemp );      
+      normalize( L, mpsTemp );
 
-      if ( do_ortho ){
-         dcomplex * coefs            = new dcomplex[ kry ];
-         CTensorT *** states         = new CTensorT **[ kry ];
-         SyBookkeeper ** bookkeepers = new SyBookkeeper *[ kry ];
+      op->DSApplyAndAdd( krylovBasisVectors[ kry ], krylovBasisSyBookkeepers[ kry ],
+                         numAdd, coefs, states, bookkeepers,
+                         mpsTemp, bkTemp,
+                         scheme, 1.0, apply );
 
-         for ( int i = 0; i < kry; i++ ) {
-            coefs[ i ]       = -krylovHamiltonian[ i + ( kry - 1 ) * krylovSpaceDimension ] / overlaps[ i + i * krylovSpaceDimension ];
-            states[ i ]      = krylovBasisVectors[ i ];
-            bookkeepers[ i ] = krylovBasisSyBookkeepers[ i ];
+      delete[] coefs;
+      delete[] states;
+      delete[] bookkeepers;
+
+      const double normTemp = norm( mpsTemp );
+      beta[ dim ]           = normTemp * scales[ kry ];
+
+      // coef = exp( step * T ) e_0 for the tridiagonal Lanczos matrix T
+      {
+         char jobz       = 'V';
+         char uplo       = 'U';
+         int lwork       = 2 * dim;
+         int info;
+         dcomplex * U    = new dcomplex[ dim * dim ];
+         dcomplex * work = new dcomplex[ lwork ];
+         double * evals  = new double[ dim ];
+         double * rwork  = new double[ 3 * dim ];
+         for ( int elem = 0; elem < dim * dim; elem++ ) { U[ elem ] = 0.0; }
+         for ( int row = 0; row < dim; row++ ) {
+            U[ row + dim * row ] = alpha[ row ];
+            if ( row > 0 ) { U[ row - 1 + dim * row ] = beta[ row ]; }
          }
-
-         op->DSApplyAndAdd( krylovBasisVectors[ kry - 1 ], krylovBasisSyBookkeepers[ kry - 1 ],
-                           kry, coefs, states, bookkeepers,
-                           mpsTemp, bkTemp,
-                           scheme );
-
-         delete[] coefs;
-         delete[] states;
-         delete[] bookkeepers;
-
-      } else {
-         op->DSApply( krylovBasisVectors[ kry - 1 ], krylovBasisSyBookkeepers[ kry - 1 ], mpsTemp, bkTemp, scheme );
-      }
-
-      normalize( L, mpsTemp );
-      krylovBasisVectors[ kry ]       = mpsTemp;
-      krylovBasisSyBookkeepers[ kry ] = bkTemp;
-
-      for ( int i = 0; i <= kry; i++ ) {
-         overlaps[ i + kry * krylovSpaceDimension ]          = overlap( krylovBasisVectors[ i ], krylovBasisVectors[ kry ] );
-         overlaps[ kry + i * krylovSpaceDimension ]          = std::conj( overlaps[ i + kry * krylovSpaceDimension ] );
-         krylovHamiltonian[ i + kry * krylovSpaceDimension ] = op->Overlap( krylovBasisVectors[ i ], krylovBasisSyBookkeepers[ i ], krylovBasisVectors[ kry ], krylovBasisSyBookkeepers[ kry ] );
-         krylovHamiltonian[ kry + i * krylovSpaceDimension ] = std::conj( krylovHamiltonian[ i + kry * krylovSpaceDimension ] );
+         zheev_( &jobz, &uplo, &dim, U, &dim, evals, work, &lwork, rwork, &info );
+         assert( info == 0 );
+         for ( int row = 0; row < dim; row++ ) {
+            coef[ row ] = 0.0;
+            for ( int eig = 0; eig < dim; eig++ ) {
+               coef[ row ] += U[ row + dim * eig ] * std::exp( step * evals[ eig ] ) * std::conj( U[ 0 + dim * eig ] );
+            }
+         }
+         delete[] U;
+         delete[] work;
+         delete[] evals;
+         delete[] rwork;
       }
+      errorEstimate = normIn * beta[ dim ] * time_step * std::abs( coef[ dim - 1 ] );
 
       gettimeofday( &end, NULL );
       const double elapsed = ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
+      std::cout << "      alpha = " << alpha[ kry ] << " beta = " << beta[ dim ] << " error estimate = " << errorEstimate << " time elapsed: " << elapsed << " seconds\n";
 
-      std::cout << "      i = " << kry << " ";
-      std::cout << "MPS dimensions:";
-      for (int i = 0; i <= prob->gL(); i++){
-         std::cout << " " << krylovBasisSyBookkeepers[ kry ]->gTotDimAtBound( i );
+      const bool converged = ( errorEstimate < threshold ) || ( dim == kry_size ) || ( beta[ dim ] < 1e-14 );
+      if ( converged ) {
+         for ( int site = 0; site < L; site++ ) {
+            delete mpsTemp[ site ];
+         }
+         delete[] mpsTemp;
+         delete bkTemp;
+         break;
       }
-      std::cout << " time elapsed: " << elapsed << " seconds" << " vector norm: " << std::abs( overlaps[ kry + kry * krylovSpaceDimension ] ) << "\n";
-      
-   }
-   std::cout << "\n";
 
-   //////////////////////////////////////////////////////////////////////////////////////
-   //
-   // Building S and H
-   //
-   //////////////////////////////////////////////////////////////////////////////////////
-
-   // dcomplex * krylovHamiltonian = new dcomplex[ krylovSpaceDimension * krylovSpaceDimension ];
-   // dcomplex * overlaps          = new dcomplex[ krylovSpaceDimension * krylovSpaceDimension ];
-
-   // for ( int irow = 0; irow < krylovSpaceDimension; irow++ ) {
-   //    for( int icol = irow; icol < krylovSpaceDimension; icol++ ) {
-   //       overlaps[ irow + icol * krylovSpaceDimension ]          = overlap( krylovBasisVectors[ irow ], krylovBasisVectors[ icol ] );
-   //       overlaps[ icol + irow * krylovSpaceDimension ]          = std::conj( overlaps[ irow + icol * krylovSpaceDimension ] );
-   //       krylovHamiltonian[ irow + icol * krylovSpaceDimension ] = op->Overlap( krylovBasisVectors[ irow ], krylovBasisSyBookkeepers[ irow ], krylovBasisVectors[ icol ], krylovBasisSyBookkeepers[ icol ] );
-   //       krylovHamiltonian[ icol + irow * krylovSpaceDimension ] = std::conj( krylovHamiltonian[ irow + icol * krylovSpaceDimension ] );
-   //    }
-   // }
-
-   for ( int irow = 0; irow < krylovSpaceDimension; irow++ ){
-      for ( int icol = 0; icol < krylovSpaceDimension; icol++ ){
-         std::cout << krylovHamiltonian[ irow +  icol * krylovSpaceDimension ] << " ";
-      }
-      std::cout << std::endl;
-   }
+      // Only rescale the last site, so that the boundary operators of the fit above remain valid
+      mpsTemp[ L - 1 ]->scale( 1.0 / normTemp );
+      krylovBasisVectors[ dim ]       = mpsTemp;
+      krylovBasisSyBookkeepers[ dim ] = bkTemp;
+      scales[ dim ]                   = 1.0;
 
-   for ( int irow = 0; irow < krylovSpaceDimension; irow++ ){
-      for ( int icol = 0; icol < krylovSpaceDimension; icol++ ){
-         std::cout << overlaps[ irow +  icol * krylovSpaceDimension ] << " ";
+      std::cout << "      i = " << dim << " ";
+      std::cout << "MPS dimensions:";
+      for (int i = 0; i <= L; i++){
+         std::cout << " " << krylovBasisSyBookkeepers[ dim ]->gTotDimAtBound( i );
       }
       std::cout << std::endl;
    }
-
-   //////////////////////////////////////////////////////////////////////////////////////
-   //
-   // Calculate S^-0.5
-   //
-   //////////////////////////////////////////////////////////////////////////////////////
-
-   dcomplex* Oinvsqr = new dcomplex[ krylovSpaceDimension * krylovSpaceDimension ];
-
-   {
-      char jobz = 'V';
-      char uplo = 'U';
-      int inc = 1;
-      int N = krylovSpaceDimension * krylovSpaceDimension;
-      int lwork = 2 * N - 1;
-      int info;
-
-      dcomplex * U = new dcomplex[ krylovSpaceDimension * krylovSpaceDimension ];
-      dcomplex* work = new dcomplex[ lwork ];
-      double* evals = new double[ krylovSpaceDimension ];
-      double* rwork = new double[ 3 * N - 2 ];
-
-      zcopy_( &N, overlaps, &inc, U, &inc );
-      zheev_( &jobz, &uplo, &krylovSpaceDimension, U, &krylovSpaceDimension, evals, work, &lwork, rwork, &info );
-      assert( info == 0 );
-
-      dcomplex one = 1.0;
-      dcomplex zero = 0.0;
-      dcomplex* tmp = new dcomplex[ krylovSpaceDimension * krylovSpaceDimension ];
-      dcomplex* diag = new dcomplex[ krylovSpaceDimension * krylovSpaceDimension ];
-
-      for( int i = 0; i < krylovSpaceDimension; i++ ){
-         for(int j = 0; j < krylovSpaceDimension; j++) {
-            diag[ i + j * krylovSpaceDimension ] = 0;   
-         }
-         diag[ i + i * krylovSpaceDimension ] = std::pow( evals[ i ], -0.5 );
-      }
-
-      delete[] work;
-      delete[] evals;
-      delete[] rwork;
-
-      zgemm_( &notrans, &notrans, &krylovSpaceDimension, &krylovSpaceDimension, &krylovSpaceDimension, &one, U, &krylovSpaceDimension, diag, &krylovSpaceDimension, &zero, tmp, &krylovSpaceDimension );
-      zgemm_( &notrans, &trans, &krylovSpaceDimension, &krylovSpaceDimension, &krylovSpaceDimension, &one, tmp, &krylovSpaceDimension, U, &krylovSpaceDimension, &zero, Oinvsqr, &krylovSpaceDimension );
-
-      delete[] tmp;
-      delete[] diag;
-      delete[] U;
-   }
-
-   //////////////////////////////////////////////////////////////////////////////////////
-   //
-   // Calculate S^-0.5 H S^-0.5
-   //
-   //////////////////////////////////////////////////////////////////////////////////////
-
-   dcomplex* Hortho = new dcomplex[ krylovSpaceDimension * krylovSpaceDimension ];
-
-   {
-      dcomplex one = 1.0;
-      dcomplex zero = 0.0;
-
-      dcomplex* tmp3 = new dcomplex[ krylovSpaceDimension * krylovSpaceDimension ];   
-
-      zgemm_( &notrans, &notrans, &krylovSpaceDimension, &krylovSpaceDimension, &krylovSpaceDimension, &one, Oinvsqr, &krylovSpaceDimension, krylovHamiltonian, &krylovSpaceDimension, &zero, tmp3, &krylovSpaceDimension );
-      zgemm_( &notrans, &notrans, &krylovSpaceDimension, &krylovSpaceDimension, &krylovSpaceDimension, &step, tmp3, &krylovSpaceDimension, Oinvsqr, &krylovSpaceDimension, &zero, Hortho, &krylovSpaceDimension );
-
-      delete[] tmp3;
-   }
+   std::cout << "\n";
 
    ////////////////////////////////////////////////////////////////////////////////////////
    ////
-   //// Calculate the matrix exponential
+   //// Sum the MPS: mpsOut = norm( mpsIn ) sum_j coef_j | j >
    ////
    ////////////////////////////////////////////////////////////////////////////////////////
 
-   dcomplex * theExp = new dcomplex[ krylovSpaceDimension * krylovSpaceDimension ];
-
-   {
-      int deg        = 10;
-      double bla     = 1.0;
-      int lwsp       = 4 * krylovSpaceDimension * krylovSpaceDimension + deg + 1;
-      dcomplex * wsp = new dcomplex[ lwsp ];
-      int * ipiv     = new int[ krylovSpaceDimension ];
-      int iexph      = 0;
-      int ns         = 0;
-      int info;
-      zgpadm_( &deg, &krylovSpaceDimension, &bla, Hortho, &krylovSpaceDimension,
-               wsp, &lwsp, ipiv, &iexph, &ns, &info );
-      assert( info == 0 );
-
-      int inc = 1;
-      int dim = krylovSpaceDimension * krylovSpaceDimension;
-      zcopy_( &dim, &wsp[ iexph - 1 ], &inc, theExp, &inc );
-
-      delete[] ipiv; 
-      delete[] wsp;
+   for ( int vec = 0; vec < dim; vec++ ) {
+      coef[ vec ] *= normIn * scales[ vec ];
    }
+   op->DSSum( dim, coef, &krylovBasisVectors[ 0 ], &krylovBasisSyBookkeepers[ 0 ], mpsOut, bkOut, scheme );
 
    ////////////////////////////////////////////////////////////////////////////////////////
    ////
-   //// Test new coefficients and sum MPS
+   //// Delete all the allocated stuff
    ////
    ////////////////////////////////////////////////////////////////////////////////////////
 
-   dcomplex * result = new dcomplex[ krylovSpaceDimension ];
-   for ( int beta = 0; beta < krylovSpaceDimension; beta++ ) {
-      result[ beta ] = 0.0;
-      for( int i = 0; i < krylovSpaceDimension; i++ ){
-         for( int j = 0; j < krylovSpaceDimension; j++ ){
-            for( int a = 0; a < krylovSpaceDimension; a++ ){
-               result[ beta ] += theExp[ i + krylovSpaceDimension * j ] * std::conj( Oinvsqr[ a + krylovSpaceDimension * j ] ) * Oinvsqr[ beta + krylovSpaceDimension * i ] * overlaps[ a + krylovSpaceDimension * 0 ];
-            }
-         }
+   for ( int cnt = 1; cnt < dim; cnt++ ) {
+      for ( int site = 0; site < L; site++ ) {
+         delete krylovBasisVectors[ cnt ][ site ];
       }
+      delete[] krylovBasisVectors[ cnt ];
+      delete krylovBasisSyBookkeepers[ cnt ];
    }
+   delete[] krylovBasisVectors;
+   delete[] krylovBasisSyBookkeepers;
+   delete[] alpha;
+   delete[] beta;
+   delete[] scales;
+   delete[] coef;
 
-   dcomplex tobeone = 0.0;
-   for( int i = 0; i < krylovSpaceDimension; i++ ){
-      for( int j = 0; j < krylovSpaceDimension; j++ ){
-         tobeone += std::conj( result[ i ] ) * result[ j ] * overlaps[ i + krylovSpaceDimension * j ];
-      }   
-   }
+   return errorEstimate;
+}
 
-   if ( ( std::abs( tobeone - overlaps[ 0 ] ) > 1e-9 ) ) {
-      std::cout << "CHEMPS2::TIME WARNING: "
-                << " Numerical Problem with non-orthonormal Krylov basis. Is your state close to an energy eigenstate?\n";
-      std::cout << "CHEMPS2::TIME WARNING: "
-                << " Norm will be off by " << std::abs( tobeone - overlaps[ 0 ] ) << " due to Krylov evolution. Should be 0.0\n";
-   }
+void CheMPS2::TimeEvolution::measure( const double t, const double elapsed, const double offset, Problem * probMeasure, const double expectation,
+                                      CTensorT ** mpsInit, CTensorT ** mps, SyBookkeeper * bk, const hid_t outputID,
+                                      const int nWeights, const int * nHoles, const int * nParticles, const int * hfState, double * weights,
+                                      const bool doDumpFCI, long long * fciTotal, const bool doDump2RDM, std::ostream & report ) {
+   const hsize_t dimarray1 = 1;
 
-   op->DSSum( krylovSpaceDimension, result, &krylovBasisVectors[ 0 ], &krylovBasisSyBookkeepers[ 0 ], mpsOut, bkOut, scheme );
+   int * actdims          = new int[ L + 1 ];
+   for ( int i = 0; i < L + 1; i++ ) { actdims[ i ] = bk->gTotDimAtBound( i ); }
+   const double normOfMPS = norm( mps );
+   const double energy    = expectation - offset * normOfMPS * normOfMPS;
+   const dcomplex oInit   = overlap( mpsInit, mps );
+   const double reoInit   = std::real( oInit );
+   const double imoInit   = std::imag( oInit );
+   COneDM * theodm        = new COneDM( mps, bk, probMeasure );
+   double * oedmre        = new double[ L * L ];
+   double * oedmim        = new double[ L * L ];
+   double * oedmdmrgre    = new double[ L * L ];
+   double * oedmdmrgim    = new double[ L * L ];
+   theodm->gOEDMReHamil( oedmre );
+   theodm->gOEDMImHamil( oedmim );
+   theodm->gOEDMReDMRG( oedmdmrgre );
+   theodm->gOEDMImDMRG( oedmdmrgim );
+
+   report << "   Norm      = " << normOfMPS               << "\n";
+   report << "   Energy    = " << energy                  << "\n";
+   report << "   Re(OInit) = " << reoInit                 << "\n";
+   report << "   Im(OInit) = " << imoInit                 << "\n";
+   report                                                 << "\n";
+   report << "  occupation numbers of molecular orbitals:\n";
+   report << "   ";
+   for ( int i = 0; i < L; i++ ) { report << std::setw( 20 ) << std::fixed << std::setprecision( 15 ) << oedmre[ i + L * i ]; }
+   report                                                 << "\n";
+   report                                                 << "\n";
+
+   const hsize_t Lposize[ 2 ] = { 1, ( hsize_t ) L + 1 };
+   const hsize_t Lsq[ 3 ]     = { 1, ( hsize_t ) L, ( hsize_t ) L };
+   HDF5_APPEND_DATASET( outputID, "chrono",         1, &dimarray1, H5T_NATIVE_DOUBLE, &elapsed   );
+   HDF5_APPEND_DATASET( outputID, "t",              1, &dimarray1, H5T_NATIVE_DOUBLE, &t         );
+   HDF5_APPEND_DATASET( outputID, "MPSDims",        2, Lposize,    H5T_STD_I32LE,     actdims    );
+   HDF5_APPEND_DATASET( outputID, "Norm",           1, &dimarray1, H5T_NATIVE_DOUBLE, &normOfMPS );
+   HDF5_APPEND_DATASET( outputID, "Energy",         1, &dimarray1, H5T_NATIVE_DOUBLE, &energy    );
+   HDF5_APPEND_DATASET( outputID, "ReOInit",        1, &dimarray1, H5T_NATIVE_DOUBLE, &reoInit   );
+   HDF5_APPEND_DATASET( outputID, "ImOInit",        1, &dimarray1, H5T_NATIVE_DOUBLE, &imoInit   );
+   HDF5_APPEND_DATASET( outputID, "OEDM_REAL",      3, Lsq,        H5T_NATIVE_DOUBLE, oedmre     );
+   HDF5_APPEND_DATASET( outputID, "OEDM_IMAG",      3, Lsq,        H5T_NATIVE_DOUBLE, oedmim     );
+   HDF5_APPEND_DATASET( outputID, "OEDM_DMRG_REAL", 3, Lsq,        H5T_NATIVE_DOUBLE, oedmdmrgre );
+   HDF5_APPEND_DATASET( outputID, "OEDM_DMRG_IMAG", 3, Lsq,        H5T_NATIVE_DOUBLE, oedmdmrgim );
+
+   delete[] actdims;
+   delete[] oedmre;
+   delete[] oedmim;
+   delete[] oedmdmrgre;
+   delete[] oedmdmrgim;
+
+   delete theodm;
+
+   if ( nWeights > 0 ){
+      calcWeights( nWeights, nHoles, nParticles, probMeasure, mps, bk, hfState, weights );
+
+      report << "  The lowest " << nWeights << " CI weights are:\n";
+      for( int iWeight = 0; iWeight < nWeights; iWeight++ ){
+         report << "  " << nHoles[ iWeight ] <<  "h" << nParticles[ iWeight] << "p-weight  = " << weights[ iWeight ] << "\n";
+      }
+      report                                                 << "\n";
 
-   ////////////////////////////////////////////////////////////////////////////////////////
-   ////
-   //// Delete all the allocated stuff
-   ////
-   ////////////////////////////////////////////////////////////////////////////////////////
+      const hsize_t weightSze[ 2 ] = { 1, ( hsize_t ) nWeights };
+      HDF5_APPEND_DATASET( outputID, "weights", 2, weightSze, H5T_NATIVE_DOUBLE, weights );
+   }
 
-   delete[] result;
-   delete[] theExp;
-   delete[] overlaps;
-   delete[] Oinvsqr;
-   delete[] krylovHamiltonian;
-   delete[] Hortho;
+   if ( doDumpFCI ) {
+      std::vector< std::vector< int > > alphasOut;
+      std::vector< std::vector< int > > betasOut;
+      std::vector< double > coefsRealOut;
+      std::vector< double > coefsImagOut;
+      getFCITensor( probMeasure, mps, alphasOut, betasOut, coefsRealOut, coefsImagOut );
+
+      // The coefficients of all data points are concatenated, those of this data point start at FCI_OFFSET
+      const hsize_t numDets = alphasOut.size();
+      unsigned long long * alphaStrings = new unsigned long long[ numDets ];
+      unsigned long long * betaStrings  = new unsigned long long[ numDets ];
+      for ( hsize_t l = 0; l < numDets; l++ ) {
+         alphaStrings[ l ] = 0;
+         betaStrings[ l ]  = 0;
+         for ( int orb = 0; orb < L; orb++ ) {
+            if ( alphasOut[ l ][ orb ] ) { alphaStrings[ l ] |= ( 1ULL << orb ); }
+            if ( betasOut[ l ][ orb ] )  { betaStrings[ l ]  |= ( 1ULL << orb ); }
+         }
+      }
+      const long long numDetsOut = numDets;
+      HDF5_APPEND_DATASET( outputID, "FCI_OFFSET", 1, &dimarray1, H5T_STD_I64LE,     fciTotal     );
+      HDF5_APPEND_DATASET( outputID, "FCI_COUNT",  1, &dimarray1, H5T_STD_I64LE,     &numDetsOut  );
+      HDF5_APPEND_DATASET( outputID, "FCI_ALPHAS", 1, &numDets,   H5T_STD_U64LE,     alphaStrings );
+      HDF5_APPEND_DATASET( outputID, "FCI_BETAS",  1, &numDets,   H5T_STD_U64LE,     betaStrings  );
+      HDF5_APPEND_DATASET( outputID, "FCI_REAL",   1, &numDets,   H5T_NATIVE_DOUBLE, ( numDets > 0 ) ? &coefsRealOut[ 0 ] : NULL );
+      HDF5_APPEND_DATASET( outputID, "FCI_IMAG",   1, &numDets,   H5T_NATIVE_DOUBLE, ( numDets > 0 ) ? &coefsImagOut[ 0 ] : NULL );
+      fciTotal[ 0 ] += numDetsOut;
+
+      delete[] alphaStrings;
+      delete[] betaStrings;
+   }
 
-   for ( int cnt = 1; cnt < krylovSpaceDimension; cnt++ ) {
-      for ( int site = 0; site < L; site++ ) {
-         delete krylovBasisVectors[ cnt ][ site ];
+   if ( doDump2RDM ) {
+      const hsize_t Lsize[ 2 ] = { 1, ( hsize_t ) L * L * L * L };
+
+      CTwoDM * thetdm = new CTwoDM( bk, probMeasure );
+      CTwoDMBuilder * thetdmbuilder = new CTwoDMBuilder( probMeasure, mps, bk );
+      thetdmbuilder->Build2RDM( thetdm );
+      double * tedm_real  = new double[ L * L * L * L ];
+      double * tedm_imag  = new double[ L * L * L * L ];
+      for( int idxA = 0; idxA < L; idxA++ ){
+         for( int idxB = 0; idxB < L; idxB++ ){
+            for( int idxC = 0; idxC < L; idxC++ ){
+               for( int idxD = 0; idxD < L; idxD++ ){
+                  tedm_real[ idxA + L * ( idxB + L * ( idxC + L * idxD ) ) ] = std::real( thetdm->getTwoDMA_HAM( idxA, idxB, idxC, idxD ) );
+                  tedm_imag[ idxA + L * ( idxB + L * ( idxC + L * idxD ) ) ] = (-1.0) * std::imag( thetdm->getTwoDMA_HAM( idxA, idxB, idxC, idxD ) );
+               }
+            }
+         }
       }
-      delete[] krylovBasisVectors[ cnt ];
-      delete krylovBasisSyBookkeepers[ cnt ];
+
+      HDF5_APPEND_DATASET( outputID, "TEDM_REAL", 2, Lsize, H5T_NATIVE_DOUBLE, tedm_real );
+      HDF5_APPEND_DATASET( outputID, "TEDM_IMAG", 2, Lsize, H5T_NATIVE_DOUBLE, tedm_imag );
+
+      delete[] tedm_real;
+      delete[] tedm_imag;
+      delete thetdmbuilder;
+      delete thetdm;
    }
-   delete[] krylovBasisVectors;
-   delete[] krylovBasisSyBookkeepers;
+}
 
-   delete op;
+void CheMPS2::TimeEvolution::profile( const double t, const double stepTime, const double measureTime, HamiltonianOperator * op, const hid_t outputID ) {
+   const double * timings     = op->gTimings();
+   const long long * counters = op->gCounters();
+   const double * discarded   = op->gDiscardedWeights();
+   const int * kept           = op->gKeptDimensions();
+   const double budget        = op->gDiscardedBudget();
+
+   std::ostringstream text;
+   text << std::setprecision( 6 );
+   text << "   Profile of the step from t = " << t << ":\n";
+   text << "     Elapsed wall time         = " << stepTime << " seconds ( measurement " << measureTime << " seconds )\n";
+   text << "       |--> H_eff applications = " << timings[ CHEMPS2_CTIME_HEFF ] << " seconds for " << counters[ CHEMPS2_CCOUNT_HEFF ]
+        << " applications with " << counters[ CHEMPS2_CCOUNT_HEFF_BLOCKS ] << " blocks\n";
+   text << "       |      diagrams local / left / right / both / overlap = "
+        << timings[ CHEMPS2_CTIME_HEFF_LOCAL ] << " / " << timings[ CHEMPS2_CTIME_HEFF_LEFT ] << " / " << timings[ CHEMPS2_CTIME_HEFF_RIGHT ] << " / "
+        << timings[ CHEMPS2_CTIME_HEFF_BOTH ] << " / " << timings[ CHEMPS2_CTIME_HEFF_OVERLAP ] << " thread seconds\n";
+   text << "       |--> boundary operators = " << timings[ CHEMPS2_CTIME_ENV ] << " seconds for " << counters[ CHEMPS2_CCOUNT_ENV_BUILD ]
+        << " updates, " << counters[ CHEMPS2_CCOUNT_ENV_REUSE ] << " reused\n";
+   text << "       |      L / F,S / A,B,C,D / Q / X,O = "
+        << timings[ CHEMPS2_CTIME_ENV_L ] << " / " << timings[ CHEMPS2_CTIME_ENV_FS ] << " / " << timings[ CHEMPS2_CTIME_ENV_ABCD ] << " / "
+        << timings[ CHEMPS2_CTIME_ENV_Q ] << " / " << timings[ CHEMPS2_CTIME_ENV_XO ] << " thread seconds\n";
+   text << "       |--> allocation         = " << timings[ CHEMPS2_CTIME_ENV_ALLOC ] << " seconds for " << 1e-6 * counters[ CHEMPS2_CCOUNT_ENV_BYTES ] << " MB\n";
+   text << "       |--> SVD                = " << timings[ CHEMPS2_CTIME_SPLIT ] << " seconds for " << counters[ CHEMPS2_CCOUNT_SPLIT ] << " splits\n";
+   text << "     Truncation error budget   = " << budget << " for " << counters[ CHEMPS2_CCOUNT_FITS ]
+        << " fits with " << counters[ CHEMPS2_CCOUNT_SWEEPS ] << " sweeps\n";
+   text << "       largest discarded weight and kept dimension per boundary:\n";
+   text << "     ";
+   for ( int i = 0; i < L + 1; i++ ) { text << std::setw( 12 ) << i; }
+   text << "\n";
+   text << "     ";
+   for ( int i = 0; i < L + 1; i++ ) { text << std::setw( 12 ) << std::scientific << std::setprecision( 2 ) << discarded[ i ]; }
+   text << "\n";
+   text << "     ";
+   for ( int i = 0; i < L + 1; i++ ) { text << std::setw( 12 ) << kept[ i ]; }
+   text << "\n";
+   std::cout << text.str() << hashline;
+
+   // One row per step, which belongs to the data point t of the other series
+   const hsize_t dimarray1     = 1;
+   const hsize_t timeSze[ 2 ]  = { 1, CHEMPS2_CTIME_VECLENGTH };
+   const hsize_t countSze[ 2 ] = { 1, CHEMPS2_CCOUNT_VECLENGTH };
+   const hsize_t boundSze[ 2 ] = { 1, ( hsize_t ) L + 1 };
+   HDF5_APPEND_DATASET( outputID, "ProfileStep",     1, &dimarray1, H5T_NATIVE_DOUBLE, &stepTime    );
+   HDF5_APPEND_DATASET( outputID, "ProfileMeasure",  1, &dimarray1, H5T_NATIVE_DOUBLE, &measureTime );
+   HDF5_APPEND_DATASET( outputID, "ProfileTimings",  2, timeSze,    H5T_NATIVE_DOUBLE, timings      );
+   HDF5_APPEND_DATASET( outputID, "ProfileCounters", 2, countSze,   H5T_STD_I64LE,     counters     );
+   HDF5_APPEND_DATASET( outputID, "TruncDiscarded",  2, boundSze,   H5T_NATIVE_DOUBLE, discarded    );
+   HDF5_APPEND_DATASET( outputID, "TruncKept",       2, boundSze,   H5T_STD_I32LE,     kept         );
+   HDF5_APPEND_DATASET( outputID, "TruncBudget",     1, &dimarray1, H5T_NATIVE_DOUBLE, &budget      );
 }
 
-void CheMPS2::TimeEvolution::Propagate( const char time_type, const double time_step_major, 
+bool CheMPS2::TimeEvolution::Propagate( const char time_type, const double time_step_major, 
                                         const double time_step_minor, const double time_final, 
                                         CTensorT ** mpsIn, SyBookkeeper * bkIn, 
                                         const int kry_size,
                                         const bool backwards, const double offset,
                                         const bool do_ortho, const bool doDumpFCI, 
                                         const bool doDump2RDM, const int nWeights,
-                                        const int * hfState ) {
+                                        const int * hfState, const double tolerance,
+                                        const std::string checkpoint, const bool restart, const char apply ) {
+   // The determinants are stored as bit strings of the occupied orbitals ( in Hamiltonian order ) in one 64-bit integer per spin
+   if ( ( doDumpFCI ) && ( L > 64 ) ) {
+      std::cerr << "TimeEvolution::Propagate : the FCI coefficients can only be dumped for at most 64 orbitals!" << std::endl;
+      return false;
+   }
+
+   // A restart should repeat the interrupted run, which is checked before its output is touched
+   if ( ( restart ) && ( checkpoint.length() > 0 ) && ( checkpointMatches( checkpoint, time_type, time_step_major, time_step_minor, bkIn ) == false ) ) {
+      return false;
+   }
+
    std::cout << "\n";
    std::cout << "   Starting to propagate MPS\n";
    std::cout << "\n";
 
-   const hid_t outputID    = HDF5FILEID != H5_CHEMPS2_TIME_NO_H5OUT ? H5Gcreate( HDF5FILEID, "/Output", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT ) : H5_CHEMPS2_TIME_NO_H5OUT;
+   // When restarting, the output of the interrupted run is continued
+   const bool continued    = ( HDF5FILEID != H5_CHEMPS2_TIME_NO_H5OUT ) && ( H5Lexists( HDF5FILEID, "/Output", H5P_DEFAULT ) > 0 );
+   const hid_t outputID    = HDF5FILEID != H5_CHEMPS2_TIME_NO_H5OUT ? ( continued ? H5Gopen( HDF5FILEID, "/Output", H5P_DEFAULT ) : H5Gcreate( HDF5FILEID, "/Output", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT ) ) : H5_CHEMPS2_TIME_NO_H5OUT;
    const hsize_t dimarray1 = 1;
 
+   /* The run parameters are written once. Each observable is appended to its own chunked dataset with the data points along
+      the first, unlimited dimension, e.g. OEDM_REAL has shape ( number of data points, L, L ). */
+   const hsize_t numInst = scheme->get_number();
+   int * MaxMs           = new int[ numInst ];
+   int * CutOs           = new int[ numInst ];
+   int * NSwes           = new int[ numInst ];
+   double * FitTs        = new double[ numInst ];
+   for ( int inst = 0; inst < numInst; inst++ ) {
+      MaxMs[ inst ] = scheme->get_D( inst );
+      CutOs[ inst ] = scheme->get_cut_off( inst );
+      NSwes[ inst ] = scheme->get_max_sweeps( inst );
+      FitTs[ inst ] = scheme->get_fit_tolerance( inst );
+   }
+   if ( continued == false ) {
+      HDF5_MAKE_DATASET( outputID, "Tmax",    1, &dimarray1, H5T_NATIVE_DOUBLE, &time_final      );
+      HDF5_MAKE_DATASET( outputID, "dtmajor", 1, &dimarray1, H5T_NATIVE_DOUBLE, &time_step_major );
+      HDF5_MAKE_DATASET( outputID, "dtminor", 1, &dimarray1, H5T_NATIVE_DOUBLE, &time_step_minor );
+      HDF5_MAKE_DATASET( outputID, "KryS",    1, &dimarray1, H5T_STD_I32LE,     &kry_size        );
+      HDF5_MAKE_DATASET( outputID, "TolDt",   1, &dimarray1, H5T_NATIVE_DOUBLE, &tolerance       );
+      HDF5_MAKE_DATASET( outputID, "MaxMs",   1, &numInst,   H5T_STD_I32LE,     MaxMs            );
+      HDF5_MAKE_DATASET( outputID, "CutOs",   1, &numInst,   H5T_STD_I32LE,     CutOs            );
+      HDF5_MAKE_DATASET( outputID, "NSwes",   1, &numInst,   H5T_STD_I32LE,     NSwes            );
+      HDF5_MAKE_DATASET( outputID, "FitTs",   1, &numInst,   H5T_NATIVE_DOUBLE, FitTs            );
+   } else {
+      // The restarted run may extend the final time of the interrupted one
+      const hid_t tmaxID = H5Dopen( outputID, "Tmax", H5P_DEFAULT );
+      H5Dwrite( tmaxID, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, &time_final );
+      H5Dclose( tmaxID );
+   }
+
+   int * nHoles     = NULL;
+   int * nParticles = NULL;
+   double * weights = NULL;
+   if ( nWeights > 0 ) {
+      int nElecHF = 0; for ( int index = 0; index < prob->gL(); index++ ) { nElecHF += hfState[ index ]; }
+      const int deltaN = nElecHF - prob->gN();
+
+      nHoles     = new int[ nWeights ];
+      nParticles = new int[ nWeights ];
+      weights    = new double[ nWeights ];
+      for ( int iWeight = 0; iWeight < nWeights; iWeight++ ) {
+         nHoles[ iWeight ]     = iWeight + deltaN;
+         nParticles[ iWeight ] = iWeight;
+      }
+      const hsize_t weightSze = nWeights;
+      if ( continued == false ) {
+         HDF5_MAKE_DATASET( outputID, "nHoles",     1, &weightSze, H5T_STD_I32LE, nHoles     );
+         HDF5_MAKE_DATASET( outputID, "nParticles", 1, &weightSze, H5T_STD_I32LE, nParticles );
+      }
+   }
+
+   long long fciTotal = 0;
+
    struct timeval start;
    gettimeofday( &start, NULL );
 
-   HamiltonianOperator * hamOp = new HamiltonianOperator( prob );
+   // A single operator for the whole propagation, so that its boundary operators can be reused across steps
+   HamiltonianOperator * hamOp = new HamiltonianOperator( prob, offset );
 
    CheMPS2::SyBookkeeper * MPSBK  = new CheMPS2::SyBookkeeper( *bkIn );
    CheMPS2::CTensorT    ** MPS    = new CheMPS2::CTensorT *[ prob->gL() ];
 
    for ( int index = 0; index < prob->gL(); index++ ) {
-      MPS[ index ] = new CheMPS2::CTensorT( mpsIn[ index ] );
+      MPS[ index ] = new CheMPS2::CTensorT( index, MPSBK );
+      mpsIn[ index ]->zcopy( MPS[ index ] );
    }
 
-   double first_energy;
-
-   for ( double t = 0.0; t < time_final; t += time_step_major ) {
-
-      int * actdims          = new int[ L + 1 ];
-      const hsize_t numInst  = scheme->get_number();
-      int * MaxMs            = new int[ numInst ];
-      int * CutOs            = new int[ numInst ];
-      int * NSwes            = new int[ numInst ];
-      const double normOfMPS = norm( MPS );
-      const double energy    = std::real( hamOp->ExpectationValue( MPS, MPSBK ) );
-      const dcomplex oInit   = overlap( mpsIn, MPS );
-      const double reoInit   = std::real( oInit );
-      const double imoInit   = std::imag( oInit );
-      COneDM * theodm        = new COneDM( MPS, MPSBK, prob );
-      double * oedmre        = new double[ L * L ];
-      double * oedmim        = new double[ L * L ];
-      double * oedmdmrgre    = new double[ L * L ];
-      double * oedmdmrgim    = new double[ L * L ];
-      theodm->gOEDMReHamil( oedmre );
-      theodm->gOEDMImHamil( oedmim );
-      theodm->gOEDMReDMRG( oedmdmrgre );
-      theodm->gOEDMImDMRG( oedmdmrgim );
-
-      if ( t == 0.0 ){
-         first_energy = energy;
-      }
+   /* The observables of a data point are evaluated on a snapshot of the MPS, concurrently with the propagation towards the
+      next data point. Both sections get half of the threads for their nested parallel regions. The HDF5 output is only
+      written from the measurement section, which is joined before the next snapshot, so the series remain in order.
+      With Cholesky vectors, the time step moves the window of matrix elements in prob, so the measurement gets a copy. */
+   Problem * measureProb = ( prob->gNumCholesky() > 0 ) ? new Problem( *prob ) : prob;
+#ifdef _OPENMP
+   const int numThreads = omp_get_max_threads();
+   const int maxLevels  = omp_get_max_active_levels();
+   omp_set_max_active_levels( std::max( maxLevels, 2 ) );
+#endif
+
+   // The minor step of the adaptive integrators starts at time_step_minor and is carried over to the next data points
+   double time_step_adaptive      = time_step_minor;
+   const double time_step_minimal = 1e-6 * time_step_minor;
+
+   /* A restart continues with the step after the checkpointed data point, which is already in the output. The checkpoint is
+      written by the measurement section from the snapshot, concurrently with the propagation towards the next data point. */
+   double t_start  = 0.0;
+   double chrono   = 0.0;
+   bool restarted  = false;
+   if ( restart && ( checkpoint.length() > 0 ) ) {
+      restarted = readCheckpoint( checkpoint, &t_start, &chrono, &time_step_adaptive, &fciTotal, outputID, MPS, MPSBK );
+      if ( restarted ) { std::cout << "   Restarted from the checkpoint " << checkpoint << " at t = " << t_start << "\n"; }
+   }
+
+   for ( double t = t_start; t < time_final; t += time_step_major ) {
 
       struct timeval end;
       gettimeofday( &end, NULL );
-      const double elapsed = ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
+      const double elapsed = chrono + ( end.tv_sec - start.tv_sec ) + 1e-6 * ( end.tv_usec - start.tv_usec );
+      const bool doMeasure = ( restarted == false ) || ( t > t_start );
+      const double dtNow   = time_step_adaptive;
 
-      std::cout << hashline;
-      std::cout                                                 << "\n";
-      std::cout << "   MPS time step"                           << "\n";
-      std::cout                                                 << "\n";
-      std::cout << "   Duration since start " << elapsed << " seconds\n";
-      std::cout                                                 << "\n";
-      std::cout << "   t        = " << t                            << "\n";
-      std::cout << "   Tmax     = " << time_final                   << "\n";
-      std::cout << "   dt major = " << time_step_major              << "\n";
-      std::cout << "   dt minor = " << time_step_minor              << "\n";
-      std::cout << "   KryS     = " << kry_size                     << "\n";
-      std::cout                                                 << "\n";
-      std::cout << "   matrix product state dimensions:             \n";
-      std::cout << "   ";
-      for ( int i = 0; i < L + 1; i++ ) { std::cout << std::setw( 5 ) << i; }
-      std::cout                                                 << "\n";
-      std::cout << "   ";
-      for ( int i = 0; i < L + 1; i++ ) { actdims[ i ] = MPSBK->gTotDimAtBound( i ); std::cout << std::setw( 5 ) << actdims[ i ]; }
-      std::cout                                                 << "\n";
-      std::cout                                                 << "\n";
-      std::cout << "   MaxM = ";
-      for ( int inst = 0; inst < numInst; inst++ ) { MaxMs[ inst ] = scheme->get_D( inst ); std::cout << MaxMs[ inst ] << " "; }
-      std::cout                                                 << "\n";
-      std::cout << "   CutO = ";
-      for ( int inst = 0; inst < numInst; inst++ ) { CutOs[ inst ] = scheme->get_cut_off( inst ); std::cout << CutOs[ inst ] << " "; }
-      std::cout                                                 << "\n";
-      std::cout << "   NSwes = ";
-      for ( int inst = 0; inst < numInst; inst++ ) { NSwes[ inst ] = scheme->get_max_sweeps( inst ); std::cout << NSwes[ inst ] << " "; }
-      std::cout                                                 << "\n";
-      std::cout                                                 << "\n";
-      std::cout << "   Norm      = " << normOfMPS               << "\n";
-      std::cout << "   Energy    = " << energy                  << "\n";
-      std::cout << "   Re(OInit) = " << reoInit                 << "\n";
-      std::cout << "   Im(OInit) = " << imoInit                 << "\n";
-      std::cout                                                 << "\n";
-      std::cout << "  occupation numbers of molecular orbitals:\n";
-      std::cout << "   ";
-      for ( int i = 0; i < L; i++ ) { std::cout << std::setw( 20 ) << std::fixed << std::setprecision( 15 ) << oedmre[ i + L * i ]; }
-      std::cout                                                 << "\n";
-      std::cout                                                 << "\n";
-
-      char dataPointname[ 1024 ];
-      sprintf( dataPointname, "/Output/DataPoint%.5f", t );
-      const hid_t dataPointID = HDF5FILEID != H5_CHEMPS2_TIME_NO_H5OUT ? H5Gcreate( HDF5FILEID, dataPointname, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT ) : H5_CHEMPS2_TIME_NO_H5OUT;
-      const hsize_t Lposize = L + 1;
-      hsize_t Lsq[ 2 ]; Lsq[ 0 ] = L; Lsq[ 1 ] = L;
-      hsize_t weightSze = nWeights;
-      HDF5_MAKE_DATASET( dataPointID, "chrono",         1, &dimarray1, H5T_NATIVE_DOUBLE,  &elapsed         );
-      HDF5_MAKE_DATASET( dataPointID, "t",              1, &dimarray1, H5T_NATIVE_DOUBLE,  &t               );
-      HDF5_MAKE_DATASET( dataPointID, "Tmax",           1, &dimarray1, H5T_NATIVE_DOUBLE,  &time_final      );
-      HDF5_MAKE_DATASET( dataPointID, "dtmajor",        1, &dimarray1, H5T_NATIVE_DOUBLE,  &time_step_major );
-      HDF5_MAKE_DATASET( dataPointID, "dtminor",        1, &dimarray1, H5T_NATIVE_DOUBLE,  &time_step_minor );
-      HDF5_MAKE_DATASET( dataPointID, "KryS",           1, &dimarray1, H5T_STD_I32LE,      &kry_size        );
-      HDF5_MAKE_DATASET( dataPointID, "MPSDims",        1, &Lposize,   H5T_STD_I32LE,      actdims          );
-      HDF5_MAKE_DATASET( dataPointID, "MaxMs",          1, &numInst,   H5T_STD_I32LE,      MaxMs            );
-      HDF5_MAKE_DATASET( dataPointID, "CutOs",          1, &numInst,   H5T_STD_I32LE,      CutOs            );
-      HDF5_MAKE_DATASET( dataPointID, "NSwes",          1, &numInst,   H5T_STD_I32LE,      NSwes            );
-      HDF5_MAKE_DATASET( dataPointID, "Norm",           1, &dimarray1, H5T_NATIVE_DOUBLE,  &normOfMPS       );
-      HDF5_MAKE_DATASET( dataPointID, "Energy",         1, &dimarray1, H5T_NATIVE_DOUBLE,  &energy          );
-      HDF5_MAKE_DATASET( dataPointID, "ReOInit",        1, &dimarray1, H5T_NATIVE_DOUBLE,  &reoInit         );
-      HDF5_MAKE_DATASET( dataPointID, "ImOInit",        1, &dimarray1, H5T_NATIVE_DOUBLE,  &imoInit         );
-      HDF5_MAKE_DATASET( dataPointID, "OEDM_REAL",      2, Lsq,        H5T_NATIVE_DOUBLE,  oedmre           );
-      HDF5_MAKE_DATASET( dataPointID, "OEDM_IMAG",      2, Lsq,        H5T_NATIVE_DOUBLE,  oedmim           );
-      HDF5_MAKE_DATASET( dataPointID, "OEDM_DMRG_REAL", 2, Lsq,        H5T_NATIVE_DOUBLE,  oedmdmrgre       );
-      HDF5_MAKE_DATASET( dataPointID, "OEDM_DMRG_IMAG", 2, Lsq,        H5T_NATIVE_DOUBLE,  oedmdmrgim       );
-
-      delete[] actdims;
-      delete[] MaxMs;
-      delete[] CutOs;
-      delete[] NSwes;
-      delete[] oedmre;
-      delete[] oedmim;
-      delete[] oedmdmrgre;
-      delete[] oedmdmrgim;
-
-      delete theodm;
-
-      if ( nWeights > 0 ){
-         int deltaN  = 0;
-         int nElecHF = 0; for ( int index = 0; index < prob->gL(); index++ ) { nElecHF += hfState[ index ]; }
-         deltaN      = nElecHF - prob->gN();
-
-         int*     nHoles =    new int[ nWeights ];
-         int* nParticles =    new int[ nWeights ];
-         double* weights = new double[ nWeights ];
-
-         for( int iWeight = 0; iWeight < nWeights; iWeight++ ){
-            nHoles[ iWeight ]     = iWeight + deltaN;
-            nParticles[ iWeight ] = iWeight;
-            weights[ iWeight ]    =  calcWieght( iWeight + deltaN, iWeight, prob, MPS, MPSBK, hfState );
-         }
-
-         std::cout << "  The lowest " << nWeights << " CI weights are:\n";
-         for( int iWeight = 0; iWeight < nWeights; iWeight++ ){
-            std::cout << "  " << nHoles[ iWeight ] <<  "h" << nParticles[ iWeight] << "p-weight  = " << weights[ iWeight ] << "\n";
-         }
-         std::cout                                                 << "\n";
-
-         HDF5_MAKE_DATASET( dataPointID, "nHoles",     1, &weightSze, H5T_STD_I32LE,      nHoles     );
-         HDF5_MAKE_DATASET( dataPointID, "nParticles", 1, &weightSze, H5T_STD_I32LE,      nParticles );
-         HDF5_MAKE_DATASET( dataPointID, "weights",    1, &weightSze, H5T_NATIVE_DOUBLE,  weights    );
-
-         delete[] nHoles;
-         delete[] nParticles;
-         delete[] weights;
+      SyBookkeeper * snapshotBK = new SyBookkeeper( *MPSBK );
+      CTensorT ** snapshot      = new CTensorT *[ L ];
+      for ( int index = 0; index < L; index++ ) {
+         snapshot[ index ] = new CTensorT( index, snapshotBK );
+         MPS[ index ]->zcopy( snapshot[ index ] );
       }
 
-      if ( doDumpFCI ) {
-         std::vector< std::vector< int > > alphasOut;
-         std::vector< std::vector< int > > betasOut;
-         std::vector< double > coefsRealOut;
-         std::vector< double > coefsImagOut;
-         const hsize_t Lsize = L;
-         getFCITensor( prob, MPS, alphasOut, betasOut, coefsRealOut, coefsImagOut );
-
-         char dataFCIName[ 1024 ];
-         sprintf( dataFCIName, "%s/FCICOEF", dataPointname );
-         const hid_t FCIID = HDF5FILEID != H5_CHEMPS2_TIME_NO_H5OUT ? H5Gcreate( HDF5FILEID, dataFCIName, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT ) : H5_CHEMPS2_TIME_NO_H5OUT;
-
-         for ( int l = 0; l < alphasOut.size(); l++ ) {
-            char dataFCINameN[ 1024 ];
-            sprintf( dataFCINameN, "%s/FCICOEF/%i", dataPointname, l );
-            const hid_t FCIID = HDF5FILEID != H5_CHEMPS2_TIME_NO_H5OUT ? H5Gcreate( HDF5FILEID, dataFCINameN, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT ) : H5_CHEMPS2_TIME_NO_H5OUT;
-            HDF5_MAKE_DATASET( FCIID, "FCI_ALPHAS", 1, &Lsize,     H5T_NATIVE_INT,    &alphasOut   [ l ][ 0 ] );
-            HDF5_MAKE_DATASET( FCIID, "FCI_BETAS",  1, &Lsize,     H5T_NATIVE_INT,    &betasOut    [ l ][ 0 ] );
-            HDF5_MAKE_DATASET( FCIID, "FCI_REAL",   1, &dimarray1, H5T_NATIVE_DOUBLE, &coefsRealOut[ l ]      );
-            HDF5_MAKE_DATASET( FCIID, "FCI_IMAG",   1, &dimarray1, H5T_NATIVE_DOUBLE, &coefsImagOut[ l ]      );
-         }
+      std::ostringstream report;
+      report << hashline;
+      report                                                 << "\n";
+      report << "   MPS time step"                           << "\n";
+      report                                                 << "\n";
+      report << "   Duration since start " << elapsed << " seconds\n";
+      report                                                 << "\n";
+      report << "   t        = " << t                            << "\n";
+      report << "   Tmax     = " << time_final                   << "\n";
+      report << "   dt major = " << time_step_major              << "\n";
+      report << "   dt minor = " << time_step_minor              << "\n";
+      report << "   KryS     = " << kry_size                     << "\n";
+      report                                                 << "\n";
+      report << "   matrix product state dimensions:             \n";
+      report << "   ";
+      for ( int i = 0; i < L + 1; i++ ) { report << std::setw( 5 ) << i; }
+      report                                                 << "\n";
+      report << "   ";
+      for ( int i = 0; i < L + 1; i++ ) { report << std::setw( 5 ) << snapshotBK->gTotDimAtBound( i ); }
+      report                                                 << "\n";
+      report                                                 << "\n";
+      report << "   MaxM = ";
+      for ( int inst = 0; inst < numInst; inst++ ) { report << MaxMs[ inst ] << " "; }
+      report                                                 << "\n";
+      report << "   CutO = ";
+      for ( int inst = 0; inst < numInst; inst++ ) { report << CutOs[ inst ] << " "; }
+      report                                                 << "\n";
+      report << "   NSwes = ";
+      for ( int inst = 0; inst < numInst; inst++ ) { report << NSwes[ inst ] << " "; }
+      report                                                 << "\n";
+      report << "   FitT = ";
+      for ( int inst = 0; inst < numInst; inst++ ) { report << FitTs[ inst ] << " "; }
+      report                                                 << "\n";
+      report                                                 << "\n";
+
+      const bool doStep = ( t + time_step_major < time_final );
+      double stepTime    = 0.0;
+      double measureTime = 0.0;
+
+      /* The energy is evaluated with the operator of the propagation, on the MPS itself rather than on the snapshot, before
+         the step: the first Lanczos matrix element < MPS | H | MPS > of the Krylov step, and the initial right-to-left pass
+         of the TDVP step, then reuse its boundary operators. Its time counts towards the measurement. */
+      hamOp->ClearProfile();
+      double expectation = 0.0;
+      if ( doMeasure ) {
+         struct timeval begin, finish;
+         gettimeofday( &begin, NULL );
+         expectation = std::real( hamOp->ExpectationValue( MPS, MPSBK ) );
+         gettimeofday( &finish, NULL );
+         measureTime = ( finish.tv_sec - begin.tv_sec ) + 1e-6 * ( finish.tv_usec - begin.tv_usec );
       }
 
-      if ( doDump2RDM ) {
-         const hsize_t Lsize =  L * L * L * L;
-
-         CTwoDM * thetdm = new CTwoDM( MPSBK, prob );
-         CTwoDMBuilder * thetdmbuilder = new CTwoDMBuilder( prob, MPS, MPSBK );
-         thetdmbuilder->Build2RDM( thetdm );
-         double * tedm_real  = new double[ L * L * L * L ];
-         double * tedm_imag  = new double[ L * L * L * L ];
-         for( int idxA = 0; idxA < L; idxA++ ){
-            for( int idxB = 0; idxB < L; idxB++ ){
-               for( int idxC = 0; idxC < L; idxC++ ){
-                  for( int idxD = 0; idxD < L; idxD++ ){
-                     tedm_real[ idxA + L * ( idxB + L * ( idxC + L * idxD ) ) ] = std::real( thetdm->getTwoDMA_HAM( idxA, idxB, idxC, idxD ) );
-                     tedm_imag[ idxA + L * ( idxB + L * ( idxC + L * idxD ) ) ] = (-1.0) * std::imag( thetdm->getTwoDMA_HAM( idxA, idxB, idxC, idxD ) );
-                  }
+#pragma omp parallel sections num_threads( 2 )
+      {
+#pragma omp section
+         {
+#ifdef _OPENMP
+            omp_set_num_threads( std::max( 1, numThreads / 2 ) );
+#endif
+            struct timeval begin, finish;
+            gettimeofday( &begin, NULL );
+            if ( doMeasure ) {
+               measure( t, elapsed, offset, measureProb, expectation, mpsIn, snapshot, snapshotBK, outputID,
+                        nWeights, nHoles, nParticles, hfState, weights, doDumpFCI, &fciTotal, doDump2RDM, report );
+               if ( checkpoint.length() > 0 ) {
+                  writeCheckpoint( checkpoint, time_type, time_step_major, time_step_minor, t, elapsed, dtNow, fciTotal, outputID, snapshot, snapshotBK );
                }
             }
+            gettimeofday( &finish, NULL );
+            measureTime += ( finish.tv_sec - begin.tv_sec ) + 1e-6 * ( finish.tv_usec - begin.tv_usec );
          }
+#pragma omp section
+         {
+#ifdef _OPENMP
+            omp_set_num_threads( std::max( 1, numThreads - numThreads / 2 ) );
+#endif
+            struct timeval begin, finish;
+            gettimeofday( &begin, NULL );
+            if ( doStep ) {
+               /* The minor steps never cross the next data point: the last one is shortened instead. With a tolerance, the Krylov and
+                  Runge-Kutta steps are rejected when their error estimate exceeds it, and the next step is scaled with the usual
+                  controller ( tolerance / error )^( 1 / ( order + 1 ) ). A shortened last step does not shrink the proposed step. */
+               const bool adaptive = ( tolerance > 0.0 ) && ( ( time_type == 'K' ) || ( time_type == 'R' ) );
+               const double order  = ( time_type == 'K' ) ? std::max( kry_size - 1, 1 ) : 4.0;
+               double t_minor      = 0.0;
+               while ( time_step_major - t_minor > 1e-10 * time_step_major ) {
+                  const double dt = std::min( time_step_adaptive, time_step_major - t_minor );
+
+                  if ( ( time_type == 'T' ) || ( time_type == 'O' ) ) {
+                     doStep_tdvp( dt, kry_size, hamOp, backwards, time_type == 'T', tolerance, MPS, MPSBK );
+                     t_minor += dt;
+                     continue;
+                  }
 
-         HDF5_MAKE_DATASET( dataPointID, "TEDM_REAL", 1, &Lsize, H5T_NATIVE_DOUBLE, tedm_real );
-         HDF5_MAKE_DATASET( dataPointID, "TEDM_IMAG", 1, &Lsize, H5T_NATIVE_DOUBLE, tedm_imag );
-
-         delete[] tedm_real;
-         delete[] tedm_imag;
-         delete thetdmbuilder;
-         delete thetdm;
-      }      
-
-      if ( t + time_step_major < time_final ) {
-         for( double t_minor = 0.0; (time_step_major - t_minor) > 1e-6; t_minor+=time_step_minor ) {
+                  SyBookkeeper * MPSBKDT = new SyBookkeeper( *MPSBK );
+                  CTensorT ** MPSDT      = new CTensorT *[ L ];
+                  for ( int index = 0; index < L; index++ ) {
+                     MPSDT[ index ] = new CTensorT( index, MPSBKDT );
+                     MPSDT[ index ]->random();
+                  }
+                  normalize( L, MPSDT );
+
+                  double errorEstimate = 0.0;
+                  if( time_type == 'K' ){
+                     errorEstimate = doStep_arnoldi( dt, kry_size, hamOp, backwards, do_ortho, tolerance, apply, MPS, MPSBK, MPSDT, MPSBKDT );
+                  } else if ( time_type == 'R' ){
+                     errorEstimate = doStep_runge_kutta( dt, kry_size, hamOp, backwards, apply, MPS, MPSBK, MPSDT, MPSBKDT );
+                  } else if ( time_type == 'E' ){
+                     doStep_euler( dt, kry_size, hamOp, backwards, MPS, MPSBK, MPSDT, MPSBKDT );
+                  }
 
-            SyBookkeeper * MPSBKDT = new SyBookkeeper( *MPSBK );
-            CTensorT ** MPSDT      = new CTensorT *[ L ];
-            for ( int index = 0; index < L; index++ ) {
-               MPSDT[ index ] = new CTensorT( index, MPSBKDT );
-               MPSDT[ index ]->random();
-            }
-            normalize( L, MPSDT );
-
-            if( time_type == 'K' ){
-               doStep_arnoldi( time_step_minor, kry_size, offset, backwards, do_ortho, MPS, MPSBK, MPSDT, MPSBKDT );
-            } else if ( time_type == 'R' ){
-               doStep_runge_kutta( time_step_minor, kry_size, offset, backwards, MPS, MPSBK, MPSDT, MPSBKDT );
-            } else if ( time_type == 'E' ){
-               doStep_euler( time_step_minor, kry_size, offset, backwards, MPS, MPSBK, MPSDT, MPSBKDT );
-            }
+                  bool accept = true;
+                  if ( adaptive ) {
+                     const double factor = ( errorEstimate > 0.0 ) ? 0.9 * pow( tolerance / errorEstimate, 1.0 / ( order + 1.0 ) ) : 5.0;
+                     const double dtNext = std::max( time_step_minimal, dt * std::min( 5.0, std::max( 0.2, factor ) ) );
+                     accept = ( errorEstimate <= tolerance ) || ( dt <= time_step_minimal );
+                     std::cout << "   adaptive step: dt = " << dt << ", error estimate = " << errorEstimate
+                               << ( accept ? ", accepted" : ", rejected" ) << ", next dt = " << dtNext << "\n";
+                     time_step_adaptive = ( accept && ( dt < time_step_adaptive ) ) ? std::max( time_step_adaptive, dtNext ) : dtNext;
+                  }
 
-            for ( int site = 0; site < L; site++ ) {
-               delete MPS[ site ];
+                  if ( accept ) {
+                     for ( int site = 0; site < L; site++ ) {
+                        delete MPS[ site ];
+                     }
+                     delete[] MPS;
+                     delete MPSBK;
+
+                     MPS      = MPSDT;
+                     MPSBK    = MPSBKDT;
+                     t_minor += dt;
+                  } else {
+                     for ( int site = 0; site < L; site++ ) {
+                        delete MPSDT[ site ];
+                     }
+                     delete[] MPSDT;
+                     delete MPSBKDT;
+                  }
+               }
             }
-            delete[] MPS;
-            delete MPSBK;
-
-            MPS   = MPSDT;
-            MPSBK = MPSBKDT;
+            gettimeofday( &finish, NULL );
+            stepTime = ( finish.tv_sec - begin.tv_sec ) + 1e-6 * ( finish.tv_usec - begin.tv_usec );
          }
       }
 
-      std::cout << hashline;
+      if ( doMeasure ) {
+         std::cout << report.str();
+         std::cout << hashline;
+      }
+      if ( doStep ) { profile( t, stepTime, measureTime, hamOp, outputID ); }
+
+      for ( int site = 0; site < L; site++ ) {
+         delete snapshot[ site ];
+      }
+      delete[] snapshot;
+      delete snapshotBK;
    }
 
+#ifdef _OPENMP
+   omp_set_max_active_levels( maxLevels );
+#endif
+   if ( measureProb != prob ) { delete measureProb; }
+
    for ( int site = 0; site < L; site++ ) {
       delete MPS[ site ];
    }
    delete[] MPS;
    delete MPSBK;
    delete hamOp;
+
+   delete[] MaxMs;
+   delete[] CutOs;
+   delete[] NSwes;
+   delete[] FitTs;
+   if ( nWeights > 0 ) {
+      delete[] nHoles;
+      delete[] nParticles;
+      delete[] weights;
+   }
+   if ( outputID != H5_CHEMPS2_TIME_NO_H5OUT ) { H5Gclose( outputID ); }
+   return true;
 }
\ No newline at end of file
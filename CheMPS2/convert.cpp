@@ -37,6 +37,7 @@
 #include "EdmistonRuedenberg.h"
 #include "TimeEvolution.h"
 #include "CFCI.h"
+#include "CMPSio.h"
 #include "CTensorT.h"
 #include "TensorT.h"
 #include "CSobject.h"
@@ -48,117 +49,6 @@
 using namespace std;
 
 
-void saveMPS(const std::string name, CheMPS2::CTensorT ** MPSlocation, CheMPS2::SyBookkeeper * BKlocation) {
- 
-   //The hdf5 file
-   hid_t file_id = H5Fcreate(name.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
-
-   //The current virtual dimensions
-   for( int bound = 0; bound <= BKlocation->gL(); bound++ ){
-      for( int N = BKlocation->gNmin( bound ); N <= BKlocation->gNmax( bound ); N++ ){
-         for( int TwoS = BKlocation->gTwoSmin( bound, N ); TwoS <= BKlocation->gTwoSmax( bound, N ); TwoS += 2 ){
-            for( int Irrep = 0; Irrep < BKlocation->getNumberOfIrreps(); Irrep++ ){
-   
-               std::stringstream sstream;
-               sstream << "/VirtDim_" << bound << "_" << N << "_" << TwoS << "_" << Irrep;
-               hid_t group_id2 = H5Gcreate( file_id, sstream.str().c_str(), H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT );
-               
-               hsize_t dimarray2     = 1; //One integer
-               hid_t dataspace_id2   = H5Screate_simple( 1, &dimarray2, NULL );
-               hid_t dataset_id2     = H5Dcreate( group_id2, "Value", H5T_STD_I32LE, dataspace_id2, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT );
-               int toWrite2 = BKlocation->gCurrentDim( bound, N, TwoS, Irrep );
-               H5Dwrite( dataset_id2, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, &toWrite2 );
-            
-               H5Dclose( dataset_id2 );
-               H5Sclose( dataspace_id2 );
-
-               H5Gclose( group_id2 );
-               
-            }
-         }
-      }
-   }
-      
-   //The MPS
-   for (int site = 0; site < BKlocation->gL(); site++ ){
-      
-      std::stringstream sstream;
-      sstream << "/MPS_" << site;
-      hid_t group_id3 = H5Gcreate( file_id, sstream.str().c_str(), H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT );
-      
-      hsize_t dimarray3     = 2 * MPSlocation[ site ]->gKappa2index( MPSlocation[ site ]->gNKappa() ); //An array of doubles
-      hid_t dataspace_id3   = H5Screate_simple( 1, &dimarray3, NULL );
-      hid_t dataset_id3     = H5Dcreate( group_id3, "Values", H5T_IEEE_F64LE, dataspace_id3, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT );
-      H5Dwrite( dataset_id3, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, MPSlocation[ site ]->gStorage() );
-   
-      H5Dclose( dataset_id3 );
-      H5Sclose( dataspace_id3 );
-
-      H5Gclose( group_id3 );
-      
-   }
-      
-   H5Fclose( file_id );
-
-}
-
-void loadDIM(const std::string name, CheMPS2::SyBookkeeper * BKlocation){
-
-   //The hdf5 file
-   hid_t file_id = H5Fopen(name.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
-      
-      //The current virtual dimensions
-      for (int bound=0; bound<=BKlocation->gL(); bound++){
-         for (int N=BKlocation->gNmin(bound); N<=BKlocation->gNmax(bound); N++){
-            for (int TwoS=BKlocation->gTwoSmin(bound,N); TwoS<=BKlocation->gTwoSmax(bound,N); TwoS+=2){
-               for (int Irrep=0; Irrep<BKlocation->getNumberOfIrreps(); Irrep++){
-     
-                  std::stringstream sstream;
-                  sstream << "/VirtDim_" << bound << "_" << N << "_" << TwoS << "_" << Irrep;
-                  hid_t group_id2 = H5Gopen(file_id, sstream.str().c_str(), H5P_DEFAULT);
-                  
-                     hid_t dataset_id2 = H5Dopen(group_id2, "Value", H5P_DEFAULT);
-                     int toRead;
-                     H5Dread(dataset_id2, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, &toRead);
-                     BKlocation->SetDim(bound, N, TwoS, Irrep, toRead);
-                     H5Dclose(dataset_id2);
-                  
-                  H5Gclose(group_id2);
-                  
-               }
-            }
-         }
-      }
-      
-   H5Fclose(file_id);
-
-}
-
-void loadMPS( const std::string name, const int L, CheMPS2::CTensorT ** MPSlocation ){
-
-   //The hdf5 file
-   hid_t file_id = H5Fopen( name.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT );
-      
-   //The MPS
-   for (int site = 0; site < L; site++){
-      
-      std::stringstream sstream;
-      sstream << "/MPS_" << site;
-      hid_t group_id3 = H5Gopen( file_id, sstream.str().c_str(), H5P_DEFAULT );
-      
-      hid_t dataset_id3     = H5Dopen( group_id3, "Values", H5P_DEFAULT );
-      H5Dread( dataset_id3, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, MPSlocation[ site ]->gStorage() );
-      H5Dclose( dataset_id3 );
-
-      H5Gclose( group_id3 );
-      
-   }
-      
-   H5Fclose( file_id );
-
-}
-
-
 void loadMPS( const std::string name, const int L, CheMPS2::TensorT ** MPSlocation ){
 
    //The hdf5 file
@@ -590,7 +480,7 @@ int main( int argc, char ** argv ){
    ********************/
 
    CheMPS2::SyBookkeeper * bkIn  = new CheMPS2::SyBookkeeper( prob, 1 );
-   loadDIM( inputfile, bkIn );
+   CheMPS2::loadDIM( inputfile, bkIn );
 
    CheMPS2::TensorT  ** mpsIn    = new  CheMPS2::TensorT *[ fcidump_norb ];
    CheMPS2::CTensorT ** mpsOut   = new CheMPS2::CTensorT *[ fcidump_norb ];
@@ -610,7 +500,7 @@ int main( int argc, char ** argv ){
       }
    }
 
-   saveMPS( outputfile, mpsOut, bkIn );
+   CheMPS2::saveMPS( outputfile, mpsOut, bkIn );
    cout << "The converted state has been successfully stored to " << outputfile << " .\n";
 
    for ( int site = 0; site < fcidump_norb; site++ ) {
@@ -35,66 +35,11 @@
 #include "EdmistonRuedenberg.h"
 #include "TimeEvolution.h"
 #include "CFCI.h"
+#include "CMPSio.h"
 #include "Irreps.h"
 
 using namespace std;
 
-void loadDIM(const std::string name, CheMPS2::SyBookkeeper * BKlocation){
-
-   //The hdf5 file
-   hid_t file_id = H5Fopen(name.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
-      
-      //The current virtual dimensions
-      for (int bound=0; bound<=BKlocation->gL(); bound++){
-         for (int N=BKlocation->gNmin(bound); N<=BKlocation->gNmax(bound); N++){
-            for (int TwoS=BKlocation->gTwoSmin(bound,N); TwoS<=BKlocation->gTwoSmax(bound,N); TwoS+=2){
-               for (int Irrep=0; Irrep<BKlocation->getNumberOfIrreps(); Irrep++){
-     
-                  std::stringstream sstream;
-                  sstream << "/VirtDim_" << bound << "_" << N << "_" << TwoS << "_" << Irrep;
-                  hid_t group_id2 = H5Gopen(file_id, sstream.str().c_str(), H5P_DEFAULT);
-                  
-                     hid_t dataset_id2 = H5Dopen(group_id2, "Value", H5P_DEFAULT);
-                     int toRead;
-                     H5Dread(dataset_id2, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, &toRead);
-                     BKlocation->SetDim(bound, N, TwoS, Irrep, toRead);
-                     H5Dclose(dataset_id2);
-                  
-                  H5Gclose(group_id2);
-                  
-               }
-            }
-         }
-      }
-      
-   H5Fclose(file_id);
-
-}
-
-void loadMPS( const std::string name, const int L, CheMPS2::CTensorT ** MPSlocation ){
-
-   //The hdf5 file
-   hid_t file_id = H5Fopen( name.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT );
-      
-   //The MPS
-   for (int site = 0; site < L; site++){
-      
-      std::stringstream sstream;
-      sstream << "/MPS_" << site;
-      hid_t group_id3 = H5Gopen( file_id, sstream.str().c_str(), H5P_DEFAULT );
-      
-      hid_t dataset_id3     = H5Dopen( group_id3, "Values", H5P_DEFAULT );
-      H5Dread( dataset_id3, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, MPSlocation[ site ]->gStorage() );
-      H5Dclose( dataset_id3 );
-
-      H5Gclose( group_id3 );
-      
-   }
-      
-   H5Fclose( file_id );
-
-}
-
 void fetch_ints( const string rawdata, int * result, const int num ){
 
    int pos  = 0;
@@ -367,6 +312,9 @@ cout << "\n"
 "       SWEEP_CUTOFF = flt, flt, flt\n"
 "              Set the cut off parameter for the Krylov space generation (positive floats).\n"
 "\n"
+"       SWEEP_FIT_TOL = flt, flt, flt\n"
+"              Set the fit tolerances for the successive sweep instructions (positive floats; default 0.0). An instruction of the fits of H | psi > and of sums of MPS stops early when the norm of the fitted MPS changes relatively less than its tolerance between two sweeps. The value 0.0 always performs SWEEP_MAX_SWEEPS sweeps.\n"
+"\n"
 "       REORDER_FIEDLER = bool\n"
 "              When all orbitals are active orbitals, switch on orbital reordering based on the Fiedler vector of the exchange matrix (TRUE or FALSE; default FALSE).\n"
 "\n"
@@ -374,13 +322,23 @@ cout << "\n"
 "              When all orbitals are active orbitals, provide a custom orbital reordering (default unspecified). When specified, this option takes precedence over REORDER_ORDER.\n"
 "\n"
 "       TIME_TYPE = char\n"
-"              Set the type of time evolution calculation to be performed. Options are (K) for Krylov (default), (R) for Runge-Kutta, (E) for Euler, and (F) for FCI.\n"
+"              Set the type of time evolution calculation to be performed. Options are (K) for Krylov (default), (R) for Runge-Kutta, (E) for Euler, (T) for two-site TDVP, (O) for one-site TDVP, and (F) for FCI. The one-site TDVP keeps the virtual dimensions of the initial MPS fixed.\n"
+"\n"
+"       TIME_APPLY = char\n"
+"              Set how H | psi > is fitted for TIME_TYPE = K or R. Options are (F) for the sweeps of the whole SWEEP_* scheme from a random guess (default), (S) for a single sweep with the last SWEEP_STATES and SWEEP_CUTOFF, starting from psi itself, and (W) for the whole scheme starting from psi.\n"
 "\n"
 "       TIME_STEP_MAJOR = flt\n"
 "              Set the time step (DT) for wave function analysis (positive float).\n"
 "\n"
 "       TIME_STEP_MINOR = flt\n"
-"              Set the time step (DT) for the time evolution calculation (positive float).\n"
+"              Set the time step (DT) for the time evolution calculation (positive float). TIME_STEP_MAJOR does not need to be a multiple of it: the last step before every data point is shortened instead. With TIME_TOLERANCE, it is the initial time step.\n"
+"\n"
+"       TIME_TOLERANCE = flt\n"
+"              Set the tolerance of the time integrator (default 0.0). Its meaning depends on TIME_TYPE, and one value serves both the time step and the Lanczos recursions:\n"
+"                - K : the tolerance on the estimated error of a time step, which also stops the Lanczos recursion of the step early.\n"
+"                - R : the tolerance on the estimated error of a time step.\n"
+"                - T or O : the tolerance of the Lanczos recursions of the local exponentials (1e-12 when not positive); the time step is not adapted.\n"
+"              For K and R, a positive tolerance adapts the time step: steps with a larger error estimate are repeated with a smaller time step, and quiet stretches are integrated with larger ones. The data points remain at multiples of TIME_STEP_MAJOR.\n"
 "\n"
 "       TIME_FINAL = flt\n"
 "              Set the final time for the time evolution calculation (positive float). \n"
@@ -410,16 +368,25 @@ cout << "\n"
 "              Set the minimum number of electrons for all sites in Hamiltonian order ( default 0, 0, 0, .... ).\n"
 "\n"
 "       TIME_KRYSIZE = int\n"
-"              Set the maximum Krylov space dimension of a time propagation step.\n"
+"              Set the maximum Krylov space dimension of a time propagation step. For TDVP, the maximum number of Lanczos vectors of the local exponentials.\n"
 "\n"
 "       TIME_HDF5OUTPUT = /path/to/hdf5/destination\n"
 "              Set the file path for the HDF5 output when specified (default unspecified).\n"
 "\n"
+"       TIME_CHECKPOINT = /path/to/checkpoint\n"
+"              Set the file path for a checkpoint of the MPS, which is replaced atomically at every data point (default unspecified).\n"
+"\n"
+"       TIME_RESTART = bool\n"
+"              Resume from TIME_CHECKPOINT when it exists, and continue the series in TIME_HDF5OUTPUT. TIME_TYPE, the time steps and the convergence scheme should be the same as in the interrupted run, otherwise the restart is refused (TRUE or FALSE; default FALSE).\n"
+"\n"
+"       TIME_HDF5DEFLATE = int\n"
+"              Set the gzip compression level of the time series in the HDF5 output; 0 disables the compression (0 to 9; default 0).\n"
+"\n"
 "       TIME_BACKWARD = bool\n"
 "              Set if the time evolution is forward or backward (default FALSE).\n"
 "\n"
 "       TIME_DUMPFCI = bool\n"
-"              Set if the FCI coefficients are dumped into the HDF5 file. Only has affect if TIME_HDF5OUTPUT is specified (TRUE or FALSE; default FALSE).\n"
+"              Set if the FCI coefficients are dumped into the HDF5 file. Only has affect if TIME_HDF5OUTPUT is specified, and only possible for at most 64 orbitals (TRUE or FALSE; default FALSE).\n"
 "\n"
 "       TIME_DUMP2RDM = bool\n"
 "              Set if the 2RDM is dumped into the HDF5 file. Only has affect if TIME_HDF5OUTPUT is specified (TRUE or FALSE; default FALSE).\n"
@@ -427,6 +394,9 @@ cout << "\n"
 "       TIME_ENERGY_OFFSET = double\n"
 "              Set the energy offset used for the dynamics calculation. (default 0.0).\n"
 "\n"
+"       TIME_CHOLESKY = flt\n"
+"              Represent the two-electron integrals by pivoted Cholesky vectors instead of a table with L^4 elements. The decomposition stops when the largest residual diagonal integral drops below this threshold. Useful for large active spaces of localized orbitals (positive float; default 0.0 keeps the full table).\n"
+"\n"
 " " << endl;
 
 }
@@ -449,11 +419,13 @@ int main( int argc, char ** argv ){
    string sweep_maxit   = "";
    string sweep_noise   = "";
    string sweep_cutoff = "";
+   string sweep_fittol = "";
 
    bool   reorder_fiedler   = false;
    string reorder_order     = "";
 
    char   time_type          = 'K';
+   char   time_apply         = 'F';
    double time_step_major    = 0.0;
    double time_step_minor    = 0.0;
    double time_final         = 0.0;
@@ -465,13 +437,18 @@ int main( int argc, char ** argv ){
    string time_n_min         = "";
    string time_n_max         = "";
    string time_hdf5output    = "";
+   string time_checkpoint    = "";
    int    time_n_weights     = 0; 
    int    time_krysize       = 0;
+   int    time_hdf5deflate   = 0;
    bool   time_backward      = false;
    bool   time_ortho         = false;
    bool   time_dumpfci       = false;
    bool   time_dump2rdm      = false;
+   bool   time_restart       = false;
    double time_energy_offset = 0.0;
+   double time_tolerance     = 0.0;
+   double time_cholesky      = 0.0;
 
    struct option long_options[] =
    {
@@ -532,19 +509,29 @@ int main( int argc, char ** argv ){
          time_hdf5output.erase( remove( time_hdf5output.begin(), time_hdf5output.end(), ' ' ), time_hdf5output.end() );
       }
 
+      if ( line.find( "TIME_CHECKPOINT" ) != string::npos ){
+         const int pos   = line.find( "=" ) + 1;
+         time_checkpoint = line.substr( pos, line.length() - pos );
+         time_checkpoint.erase( remove( time_checkpoint.begin(), time_checkpoint.end(), ' ' ), time_checkpoint.end() );
+      }
+
       if ( find_integer( &group,        line, "GROUP",        true, 0, true,   7 ) == false ){ return -1; }
       if ( find_integer( &multiplicity, line, "MULTIPLICITY", true, 1, false, -1 ) == false ){ return -1; }
       if ( find_integer( &nelectrons,   line, "NELECTRONS",   true, 2, false, -1 ) == false ){ return -1; }
       if ( find_integer( &irrep,        line, "IRREP",        true, 0, true,   7 ) == false ){ return -1; }
 
-      char options1[] = { 'K', 'R', 'E', 'F' };
-      if ( find_character( &time_type,        line, "TIME_TYPE",        options1, 4 ) == false ){ return -1; }
+      char options1[] = { 'K', 'R', 'E', 'T', 'O', 'F' };
+      if ( find_character( &time_type,        line, "TIME_TYPE",        options1, 6 ) == false ){ return -1; }
+
+      char options2[] = { 'F', 'S', 'W' };
+      if ( find_character( &time_apply,       line, "TIME_APPLY",       options2, 3 ) == false ){ return -1; }
 
       if ( find_boolean( &reorder_fiedler,  line, "REORDER_FIEDLER"   ) == false ){ return -1; }
       if ( find_boolean( &time_backward,    line, "TIME_BACKWARD"     ) == false ){ return -1; }
       if ( find_boolean( &time_ortho,       line, "TIME_ORTHO"        ) == false ){ return -1; }
       if ( find_boolean( &time_dumpfci,     line, "TIME_DUMPFCI"      ) == false ){ return -1; }
       if ( find_boolean( &time_dump2rdm,    line, "TIME_DUMP2RDM"     ) == false ){ return -1; }
+      if ( find_boolean( &time_restart,     line, "TIME_RESTART"      ) == false ){ return -1; }
 
       if ( find_double( &time_energy_offset, line, "TIME_ENERGY_OFFSET", false, 0.0 ) == false ){ return -1; }
 
@@ -568,6 +555,11 @@ int main( int argc, char ** argv ){
          sweep_cutoff = line.substr( pos, line.length() - pos );
       }
 
+      if ( line.find( "SWEEP_FIT_TOL" ) != string::npos ){
+         const int pos = line.find( "=" ) + 1;
+         sweep_fittol = line.substr( pos, line.length() - pos );
+      }
+
       if ( line.find( "REORDER_ORDER" ) != string::npos ){
          const int pos = line.find( "=" ) + 1;
          reorder_order = line.substr( pos, line.length() - pos );
@@ -585,6 +577,14 @@ int main( int argc, char ** argv ){
          find_double( &time_final, line, "TIME_FINAL", true, 0.0 );
       }
 
+      if ( line.find( "TIME_TOLERANCE" ) != string::npos ){
+         if ( find_double( &time_tolerance, line, "TIME_TOLERANCE", true, 0.0 ) == false ){ return -1; }
+      }
+
+      if ( line.find( "TIME_CHOLESKY" ) != string::npos ){
+         if ( find_double( &time_cholesky, line, "TIME_CHOLESKY", true, 0.0 ) == false ){ return -1; }
+      }
+
       if ( line.find( "TIME_NINIT" ) != string::npos ){
          const int pos = line.find( "=" ) + 1;
          time_ninit = line.substr( pos, line.length() - pos );
@@ -622,6 +622,10 @@ int main( int argc, char ** argv ){
       if ( line.find( "TIME_N_WEIGHTS" ) != string::npos ){
          find_integer( &time_n_weights, line, "TIME_N_WEIGHTS", true, 1, false, -1 );
       }
+
+      if ( line.find( "TIME_HDF5DEFLATE" ) != string::npos ){
+         if ( find_integer( &time_hdf5deflate, line, "TIME_HDF5DEFLATE", true, 0, true, 9 ) == false ){ return -1; }
+      }
    }
    input.close();
 
@@ -676,6 +680,11 @@ int main( int argc, char ** argv ){
    if ( nelectrons   == -1 ){   nelectrons = fcidump_nelec;     }
    if ( irrep        == -1 ){        irrep = fcidump_irrep;     }
 
+   if ( ( time_dumpfci ) && ( fcidump_norb > 64 ) ){
+      cerr << "TIME_DUMPFCI is only possible for at most 64 orbitals!" << endl;
+      return -1;
+   }
+
    /*********************************
    *  Check the sweep instructions  *
    **********************************/
@@ -689,8 +698,9 @@ int main( int argc, char ** argv ){
    const int ni_maxit  = count( sweep_maxit.begin(),  sweep_maxit.end(),  ',' ) + 1;
    const int ni_noise  = count( sweep_noise.begin(),  sweep_noise.end(),  ',' ) + 1;
    const int ni_cutoff = count( sweep_cutoff.begin(), sweep_cutoff.end(), ',' ) + 1;
+   const int ni_fittol = ( sweep_fittol.length() > 0 ) ? count( sweep_fittol.begin(), sweep_fittol.end(), ',' ) + 1 : ni_d;
 
-   bool num_eq  = (( ni_d == ni_maxit ) && ( ni_d == ni_noise ) && ( ni_d == ni_cutoff ));
+   bool num_eq  = (( ni_d == ni_maxit ) && ( ni_d == ni_noise ) && ( ni_d == ni_cutoff ) && ( ni_d == ni_fittol ));
 
    if ( num_eq == false ){
       cerr << "The number of instructions in SWEEP_* should be equal!" << endl;
@@ -701,6 +711,9 @@ int main( int argc, char ** argv ){
    int    * value_maxit      = new int   [ ni_d ];    fetch_ints( sweep_maxit,  value_maxit,  ni_d );
    double * value_noise      = new double[ ni_d ]; fetch_doubles( sweep_noise,  value_noise,  ni_d );
    double * value_cutoff     = new double[ ni_d ]; fetch_doubles( sweep_cutoff, value_cutoff, ni_d );
+   double * value_fittol     = new double[ ni_d ];
+   if ( sweep_fittol.length() > 0 ){ fetch_doubles( sweep_fittol, value_fittol, ni_d ); }
+   else { for ( int cnt = 0; cnt < ni_d; cnt++ ){ value_fittol[ cnt ] = 0.0; } }
 
 
    /*********************************
@@ -740,11 +753,6 @@ int main( int argc, char ** argv ){
       return -1;
    }
 
-   if( std::abs( ( time_step_major / time_step_minor ) - round( time_step_major / time_step_minor ) ) > 1e-6 ){
-      cerr << "TIME_STEP_MAJOR must be N*TIME_STEP_MINOR !" << endl;
-      return -1;
-   }
-
    if ( time_final <= 0 ){
       cerr << "TIME_FINAL should be greater than zero !" << endl;
       return -1;
@@ -760,8 +768,13 @@ int main( int argc, char ** argv ){
       return -1;
    }
 
-   if ( time_type == 'K' && time_krysize <= 0 ){
-      cerr << "TIME_KRYSIZE should be greater than zero if TIME_TYPE = K!" << endl;
+   if ( ( time_restart ) && ( time_checkpoint.length() == 0 ) ){
+      cerr << "TIME_RESTART requires TIME_CHECKPOINT !" << endl;
+      return -1;
+   }
+
+   if ( ( time_type == 'K' || time_type == 'T' || time_type == 'O' ) && time_krysize <= 0 ){
+      cerr << "TIME_KRYSIZE should be greater than zero if TIME_TYPE = K, T or O!" << endl;
       return -1;
    }
 
@@ -909,15 +922,18 @@ int main( int argc, char ** argv ){
    cout << "   SWEEP_MAX_SWEEPS   = [ " << value_maxit [ 0 ]; for ( int cnt = 1; cnt < ni_d; cnt++ ){ cout << " ; " << value_maxit [ cnt ]; } cout << " ]" << endl;
    cout << "   SWEEP_NOISE_PREFAC = [ " << value_noise [ 0 ]; for ( int cnt = 1; cnt < ni_d; cnt++ ){ cout << " ; " << value_noise [ cnt ]; } cout << " ]" << endl;
    cout << "   SWEEP_CUTOFF       = [ " << value_cutoff[ 0 ]; for ( int cnt = 1; cnt < ni_d; cnt++ ){ cout << " ; " << value_cutoff[ cnt ]; } cout << " ]" << endl;
+   cout << "   SWEEP_FIT_TOL      = [ " << value_fittol[ 0 ]; for ( int cnt = 1; cnt < ni_d; cnt++ ){ cout << " ; " << value_fittol[ cnt ]; } cout << " ]" << endl;
    if ( reorder_order.length() > 0 ){
       cout << "   REORDER_ORDER      = [ " << dmrg2ham[ 0 ]; for ( int cnt = 1; cnt < fcidump_norb; cnt++ ){ cout << " ; " << dmrg2ham[ cnt ]; } cout << " ]" << endl;
    } else {
       cout << "   REORDER_FIEDLER    = " << (( reorder_fiedler ) ? "TRUE" : "FALSE" ) << endl;
    }   
    cout << "   TIME_TYPE          = " << time_type << endl;
+   cout << "   TIME_APPLY         = " << time_apply << endl;
    cout << "   TIME_STEP_MAJOR    = " << time_step_major << endl;
    cout << "   TIME_STEP_MINOR    = " << time_step_minor << endl;
    cout << "   TIME_FINAL         = " << time_final << endl;
+   cout << "   TIME_TOLERANCE     = " << time_tolerance << endl;
    if ( ( time_ninit.length() > 0  ) && ( time_2_ninit.length() > 0 ) ){
       cout << "   TIME_NINIT         = [ " << time_ninit_parsed[ 0 ]; for ( int cnt = 1; cnt < fcidump_norb; cnt++ ){ cout << " ; " << time_ninit_parsed[ cnt ]; } cout << " ]" << endl;
       cout << "   TIME_2_NINIT       = [ " << time_2_ninit_parsed[ 0 ]; for ( int cnt = 1; cnt < fcidump_norb; cnt++ ){ cout << " ; " << time_2_ninit_parsed[ cnt ]; } cout << " ]" << endl;
@@ -933,11 +949,15 @@ int main( int argc, char ** argv ){
    }
    cout << "   TIME_KRYSIZE       = " << time_krysize << endl;
    cout << "   TIME_HDF5OUTPUT    = " << time_hdf5output << endl;
+   cout << "   TIME_HDF5DEFLATE   = " << time_hdf5deflate << endl;
+   cout << "   TIME_CHECKPOINT    = " << time_checkpoint << endl;
+   cout << "   TIME_RESTART       = " << (( time_restart    ) ? "TRUE" : "FALSE" ) << endl;
    cout << "   TIME_BACKWARD      = " << (( time_backward   ) ? "TRUE" : "FALSE" ) << endl;
    cout << "   TIME_ORTHO         = " << (( time_ortho      ) ? "TRUE" : "FALSE" ) << endl;
    cout << "   TIME_DUMPFCI       = " << (( time_dumpfci    ) ? "TRUE" : "FALSE" ) << endl;
    cout << "   TIME_DUMP2RDM      = " << (( time_dump2rdm   ) ? "TRUE" : "FALSE" ) << endl;
    cout << "   TIME_ENERGY_OFFSET = " << time_energy_offset                        << endl;
+   cout << "   TIME_CHOLESKY      = " << time_cholesky                             << endl;
    cout << " " << endl;
 
    /********************************
@@ -952,16 +972,19 @@ int main( int argc, char ** argv ){
                                           value_cutoff[ count ],
                                           value_maxit [ count ],
                                           value_noise [ count ]);
+      opt_scheme->set_fit_tolerance( count, value_fittol[ count ] );
    }
 
    delete [] value_states;
    delete [] value_cutoff;
+   delete [] value_fittol;
    delete [] value_maxit;
    delete [] value_noise;
 
    CheMPS2::Problem * prob = new CheMPS2::Problem( ham, multiplicity - 1, nelectrons, irrep );
    if( time_n_max.length() > 0 ) { prob->setup_occu_max( time_n_max_parsed ); }
    if( time_n_min.length() > 0 ) { prob->setup_occu_min( time_n_min_parsed ); }
+   if( time_cholesky > 0.0 ) { prob->set_cholesky_threshold( time_cholesky ); }
 
    /***********************************
    *  Reorder the orbitals if desired *
@@ -1043,13 +1066,13 @@ int main( int argc, char ** argv ){
       normalize( prob->gL(),  mpsIn );
    } else {
       bkIn  = new CheMPS2::SyBookkeeper( prob, 1 );
-      loadDIM( time_init, bkIn );
+      CheMPS2::loadDIM( time_init, bkIn );
 
       mpsIn    = new CheMPS2::CTensorT *[ prob->gL() ];
       for ( int index = 0; index < prob->gL(); index++ ) {
          mpsIn[ index ] = new CheMPS2::CTensorT( index, bkIn );
       }
-      loadMPS( time_init, prob->gL(), mpsIn );
+      CheMPS2::loadMPS( time_init, prob->gL(), mpsIn );
 
       normalize( prob->gL(), mpsIn );
    }
@@ -1058,17 +1081,30 @@ int main( int argc, char ** argv ){
    *  Do the time evolution *
    *************************/
 
-   if ( time_type == 'K' || time_type == 'R' || time_type == 'E' ){
+   if ( time_type == 'K' || time_type == 'R' || time_type == 'E' || time_type == 'T' || time_type == 'O' ){
+      /* A restart resumes from the checkpoint and continues the output of the interrupted run. Without that output, the
+         series before the checkpoint would be lost, so the restart is refused rather than starting a new output file. */
+      struct stat file_info;
+      const bool resume       = ( time_restart ) && ( stat( time_checkpoint.c_str(), &file_info ) == 0 );
+      const bool output_found = ( time_hdf5output.length() > 0 ) && ( stat( time_hdf5output.c_str(), &file_info ) == 0 );
+      if ( ( resume ) && ( time_hdf5output.length() > 0 ) && ( output_found == false ) ){
+         cerr << "TIME_RESTART : the checkpoint " << time_checkpoint << " exists, but the output " << time_hdf5output << " of the interrupted run does not !" << endl;
+         return -1;
+      }
       hid_t fileID = H5_CHEMPS2_TIME_NO_H5OUT;
-      if ( time_hdf5output.length() > 0){ fileID = H5Fcreate( time_hdf5output.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT ); }
+      if ( time_hdf5output.length() > 0){
+         fileID = ( resume ) ? H5Fopen( time_hdf5output.c_str(), H5F_ACC_RDWR, H5P_DEFAULT ) : H5Fcreate( time_hdf5output.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT );
+      }
 
-      CheMPS2::TimeEvolution * taylor = new CheMPS2::TimeEvolution( prob, opt_scheme, fileID );
-      taylor->Propagate( time_type, time_step_major, time_step_minor, time_final, mpsIn, bkIn,
-                         time_krysize, time_backward, time_energy_offset, time_ortho, time_dumpfci, time_dump2rdm, time_n_weights, time_hf_state_parsed );
+      CheMPS2::TimeEvolution * taylor = new CheMPS2::TimeEvolution( prob, opt_scheme, fileID, time_hdf5deflate );
+      const bool propagated = taylor->Propagate( time_type, time_step_major, time_step_minor, time_final, mpsIn, bkIn,
+                                                 time_krysize, time_backward, time_energy_offset, time_ortho, time_dumpfci, time_dump2rdm, time_n_weights, time_hf_state_parsed, time_tolerance,
+                                                 time_checkpoint, resume, time_apply );
 
       if ( fileID != H5_CHEMPS2_TIME_NO_H5OUT){ H5Fclose( fileID ); }
 
       delete taylor;
+      if ( propagated == false ){ return -1; }
    } else {
       cerr << " Your TIME_TYPE is not implemented yet" << std::endl;
       return -1;
@@ -326,6 +326,9 @@ cout << "\n"
 "       TIME_KRYSIZE = int\n"
 "              Set the maximum Krylov space dimension of a time propagation step.\n"
 "\n"
+"       TIME_KRYTOL = flt\n"
+"              Set the tolerance on the a posteriori error estimate of a Lanczos time step (default 1e-10). The Krylov space dimension is chosen per step, up to TIME_KRYSIZE.\n"
+"\n"
 "       TIME_HDF5OUTPUT = /path/to/hdf5/destination\n"
 "              Set the file path for the HDF5 output when specified (default unspecified).\n"
 "\n"
@@ -335,12 +338,22 @@ cout << "\n"
 "       TIME_DUMP2RDM = bool\n"
 "              Set if the 2RDM is dumped into the HDF5 file. Only has affect if TIME_HDF5OUTPUT is specified (TRUE or FALSE; default FALSE).\n"
 "\n"
+"       TIME_ONTHEFLY = bool\n"
+"              Set if the excitation signs and addresses are computed on the fly from the Slater determinant bitstrings instead of being stored in lookup tables. Saves 4 L^2 integers per alpha and beta Slater determinant at a small cost in the matrix-vector product (TRUE or FALSE; default FALSE).\n"
+"\n"
 " " << endl;
 
 }
 
 int main( int argc, char ** argv ){
 
+   #ifdef CHEMPS2_MPI_COMPILATION
+      CheMPS2::MPIchemps2::mpi_init();
+      const bool am_i_master = ( CheMPS2::MPIchemps2::mpi_rank() == MPI_CHEMPS2_MASTER );
+   #else
+      const bool am_i_master = true;
+   #endif
+
    /************************
    *  Read in the options  *
    *************************/
@@ -362,11 +375,13 @@ int main( int argc, char ** argv ){
    string time_hdf5output = "";
    string time_hf_state   = "";
    int    time_krysize    = 0;
+   double time_krytol     = 1e-10;
    int    time_c_i_gs     = -1;
    int    time_n_weights  = 0; 
    bool   time_backward   = false;   
    bool   time_dumpfci    = false;
    bool   time_dump2rdm   = false;
+   bool   time_onthefly   = false;
 
    struct option long_options[] =
    {
@@ -382,23 +397,23 @@ int main( int argc, char ** argv ){
       switch( c ){
          case 'h':
          case '?':
-            print_help();
-            return 0;
+            if ( am_i_master ){ print_help(); }
+            return clean_exit( 0 );
             break;
          case 'v':
-            cout << "chemps2 version " << CHEMPS2_VERSION << endl;
-            return 0;
+            if ( am_i_master ){ cout << "chemps2 version " << CHEMPS2_VERSION << endl; }
+            return clean_exit( 0 );
             break;
          case 'f':
             inputfile = optarg;
-            if ( file_exists( inputfile, "--file" ) == false ){ return -1; }
+            if ( file_exists( inputfile, "--file" ) == false ){ return clean_exit( -1 ); }
             break;
       }
    }
 
    if ( inputfile.length() == 0 ){
       cerr << "The input file should be specified!" << endl;
-      return -1;
+      return clean_exit( -1 );
    }
 
    ifstream input( inputfile.c_str() );
@@ -411,7 +426,7 @@ int main( int argc, char ** argv ){
          const int pos = line.find( "=" ) + 1;
          fcidump = line.substr( pos, line.length() - pos );
          fcidump.erase( remove( fcidump.begin(), fcidump.end(), ' ' ), fcidump.end() );
-         if ( file_exists( fcidump, "FCIDUMP" ) == false ){ return -1; }
+         if ( file_exists( fcidump, "FCIDUMP" ) == false ){ return clean_exit( -1 ); }
       }
 
       if ( line.find( "TIME_HDF5OUTPUT" ) != string::npos ){
@@ -420,17 +435,18 @@ int main( int argc, char ** argv ){
          time_hdf5output.erase( remove( time_hdf5output.begin(), time_hdf5output.end(), ' ' ), time_hdf5output.end() );
       }
 
-      if ( find_integer( &group,        line, "GROUP",        true, 0, true,   7 ) == false ){ return -1; }
-      if ( find_integer( &multiplicity, line, "MULTIPLICITY", true, 1, false, -1 ) == false ){ return -1; }
-      if ( find_integer( &nelectrons,   line, "NELECTRONS",   true, 2, false, -1 ) == false ){ return -1; }
-      if ( find_integer( &irrep,        line, "IRREP",        true, 0, true,   7 ) == false ){ return -1; }
+      if ( find_integer( &group,        line, "GROUP",        true, 0, true,   7 ) == false ){ return clean_exit( -1 ); }
+      if ( find_integer( &multiplicity, line, "MULTIPLICITY", true, 1, false, -1 ) == false ){ return clean_exit( -1 ); }
+      if ( find_integer( &nelectrons,   line, "NELECTRONS",   true, 2, false, -1 ) == false ){ return clean_exit( -1 ); }
+      if ( find_integer( &irrep,        line, "IRREP",        true, 0, true,   7 ) == false ){ return clean_exit( -1 ); }
 
       char options1[] = { 'K', 'R', 'E', 'F' };
-      if ( find_character( &time_type,        line, "TIME_TYPE",        options1, 4 ) == false ){ return -1; }
+      if ( find_character( &time_type,        line, "TIME_TYPE",        options1, 4 ) == false ){ return clean_exit( -1 ); }
 
-      if ( find_boolean( &time_backward,    line, "TIME_BACKWARD"    ) == false ){ return -1; }
-      if ( find_boolean( &time_dumpfci,     line, "TIME_DUMPFCI"     ) == false ){ return -1; }
-      if ( find_boolean( &time_dump2rdm,    line, "TIME_DUMP2RDM"    ) == false ){ return -1; }
+      if ( find_boolean( &time_backward,    line, "TIME_BACKWARD"    ) == false ){ return clean_exit( -1 ); }
+      if ( find_boolean( &time_dumpfci,     line, "TIME_DUMPFCI"     ) == false ){ return clean_exit( -1 ); }
+      if ( find_boolean( &time_dump2rdm,    line, "TIME_DUMP2RDM"    ) == false ){ return clean_exit( -1 ); }
+      if ( find_boolean( &time_onthefly,    line, "TIME_ONTHEFLY"    ) == false ){ return clean_exit( -1 ); }
 
       if ( line.find( "TIME_STEP_MAJOR" ) != string::npos ){
          find_double( &time_step_major, line, "TIME_STEP_MAJOR", true, 0.0 );
@@ -454,12 +470,16 @@ int main( int argc, char ** argv ){
          time_beta = line.substr( pos, line.length() - pos );
       }
 
-      if ( find_integer( &time_c_i_gs, line, "TIME_C_I_GS", true, 0, false, -1 ) == false ){ return -1; }
+      if ( find_integer( &time_c_i_gs, line, "TIME_C_I_GS", true, 0, false, -1 ) == false ){ return clean_exit( -1 ); }
 
       if ( line.find( "TIME_KRYSIZE" ) != string::npos ){
          find_integer( &time_krysize, line, "TIME_KRYSIZE", true, 1, false, -1 );
       }
 
+      if ( line.find( "TIME_KRYTOL" ) != string::npos ){
+         find_double( &time_krytol, line, "TIME_KRYTOL", true, 0.0 );
+      }
+
       if ( line.find( "TIME_N_WEIGHTS" ) != string::npos ){
          find_integer( &time_n_weights, line, "TIME_N_WEIGHTS", true, 1, false, -1 );
       }
@@ -478,7 +498,7 @@ int main( int argc, char ** argv ){
 
    if ( group == -1 ){
       cerr << "GROUP is a mandatory option!" << endl; 
-      return -1;
+      return clean_exit( -1 );
    }
    CheMPS2::Irreps Symmhelper( group );
    const int num_irreps = Symmhelper.getNumberOfIrreps();
@@ -495,7 +515,7 @@ int main( int argc, char ** argv ){
       pos = line.find( "FCI" );
       if ( pos == string::npos ){
          cerr << "The file " << fcidump << " is not a fcidump file!" << endl; 
-         return -1;
+         return clean_exit( -1 );
       }
       pos = line.find( "NORB"  ); pos = line.find( "=", pos ); pos2 = line.find( ",", pos );
       fcidump_norb = atoi( line.substr( pos+1, pos2-pos-1 ).c_str() );
@@ -515,7 +535,7 @@ int main( int argc, char ** argv ){
       }
       if ( fcidump_irrep == -1 ){
          cerr << "Could not find the molpro wavefunction symmetry (ISYM) in the fcidump file!" << endl; 
-         return -1;
+         return clean_exit( -1 );
       }
       delete [] psi2molpro;
    }
@@ -533,42 +553,42 @@ int main( int argc, char ** argv ){
    
    if ( time_step_major <= 0.0 ){
       cerr << "TIME_STEP_MAJOR should be greater than zero !" << endl;
-      return -1;
+      return clean_exit( -1 );
    }
 
    if ( time_step_minor <= 0.0 ){
       cerr << "TIME_STEP_MINOR should be greater than zero !" << endl;
-      return -1;
+      return clean_exit( -1 );
    }
 
    if( std::abs( ( time_step_major / time_step_minor ) - round( time_step_major / time_step_minor ) ) > 1e-6 ){
       cerr << "TIME_STEP_MAJOR must be N*TIME_STEP_MINOR !" << endl;
-      return -1;
+      return clean_exit( -1 );
    }
 
    if ( time_final <= 0.0 ){
       cerr << "TIME_FINAL should be greater than zero !" << endl;
-      return -1;
+      return clean_exit( -1 );
    }
 
    if ( time_alpha.length() == 0 ){
       cerr << "TIME_ALPHA is mandatory !" << endl;
-      return -1;
+      return clean_exit( -1 );
    }
 
    if ( time_beta.length() == 0 ){
       cerr << "TIME_BETA is mandatory !" << endl;
-      return -1;
+      return clean_exit( -1 );
    }
 
    if( time_c_i_gs > fcidump_norb ){
       cerr << "If given, TIME_C_I_GS must be within 0 and L - 1 !" << endl;
-      return -1;
+      return clean_exit( -1 );
    }
 
    if ( time_type == 'K' && time_krysize <= 0 ){
       cerr << "TIME_KRYSIZE should be greater than zero if TIME_TYPE = K!" << endl;
-      return -1;
+      return clean_exit( -1 );
    }
 
    const int ni_ini_alpha  = count( time_alpha.begin(), time_alpha.end(), ',' ) + 1;
@@ -577,7 +597,7 @@ int main( int argc, char ** argv ){
 
    if ( init_ok == false ){
       cerr << "There should be " << fcidump_norb << " numbers in TIME_ALPHA and TIME_BETA !" << endl;
-      return -1;
+      return clean_exit( -1 );
    }
 
    fetch_ints( time_alpha, time_alpha_parsed, fcidump_norb );
@@ -586,14 +606,14 @@ int main( int argc, char ** argv ){
    for ( int cnt = 0; cnt < fcidump_norb; cnt ++ ){
       if ( ( time_alpha_parsed[ cnt ] < 0 ) || ( time_alpha_parsed[ cnt ] > 1 ) ){
          cerr << "The occupation number in TIME_ALPHA has to be 0 or 1 !" << endl;
-         return -1;
+         return clean_exit( -1 );
       }
    }
 
    for ( int cnt = 0; cnt < fcidump_norb; cnt ++ ){
       if ( ( time_beta_parsed[ cnt ] < 0 ) || ( time_beta_parsed[ cnt ] > 1 ) ){
          cerr << "The occupation number in TIME_BETA has to be 0 or 1 !" << endl;
-         return -1;
+         return clean_exit( -1 );
       }
    }
 
@@ -601,7 +621,7 @@ int main( int argc, char ** argv ){
    int elec_sum = 0; for ( int cnt = 0; cnt < fcidump_norb; cnt++ ) { elec_sum += time_alpha_parsed[ cnt ] + time_beta_parsed[ cnt ];  }
    if ( elec_sum != nelectrons ){
       cerr << "There should be " << nelectrons << " distributed over the molecular orbitals in TIME_ALPHA and TIME_BETA !" << endl;
-      return -1;
+      return clean_exit( -1 );
    }
 
    if( time_n_weights > 0 ){
@@ -610,7 +630,7 @@ int main( int argc, char ** argv ){
 
       if ( hf_ok == false ){
          cerr << "There should be " << fcidump_norb << " numbers in TIME_HF_STATE  !" << endl;
-         return -1;
+         return clean_exit( -1 );
       }
 
       time_hf_state_parsed = new int[ fcidump_norb ];
@@ -619,7 +639,7 @@ int main( int argc, char ** argv ){
       for ( int cnt = 0; cnt < fcidump_norb; cnt ++ ){
          if ( !(time_hf_state_parsed[ cnt ] == 0 || time_hf_state_parsed[ cnt ] == 2 ) ){
             cerr << "The occupation number in TIME_HF_STATE has to be 0 or 2 (closed shell) !" << endl;
-            return -1;
+            return clean_exit( -1 );
          }
       }
    }
@@ -628,25 +648,29 @@ int main( int argc, char ** argv ){
    *  Print the options  *
    ***********************/
 
-   cout << "\nRunning chemps2 version " << CHEMPS2_VERSION << " with the following options:\n" << endl;
-   cout << "   FCIDUMP            = " << fcidump << endl;
-   cout << "   GROUP              = " << Symmhelper.getGroupName() << endl;
-   cout << "   MULTIPLICITY       = " << multiplicity << endl;
-   cout << "   NELECTRONS         = " << nelectrons << endl;
-   cout << "   IRREP              = " << Symmhelper.getIrrepName( irrep ) << endl;
-   cout << "   TIME_TYPE          = " << time_type << endl;
-   cout << "   TIME_STEP_MAJOR    = " << time_step_major << endl;
-   cout << "   TIME_STEP_MINOR    = " << time_step_minor << endl;
-   cout << "   TIME_FINAL         = " << time_final << endl;
-   cout << "   TIME_BACKWARD      = " << time_backward << endl;
-   cout << "   TIME_ALPHA         = [ " << time_alpha_parsed[ 0 ]; for ( int cnt = 1; cnt < fcidump_norb; cnt++ ){ cout << " ; " << time_alpha_parsed[ cnt ]; } cout << " ]" << endl;
-   cout << "   TIME_BETA          = [ " <<  time_beta_parsed[ 0 ]; for ( int cnt = 1; cnt < fcidump_norb; cnt++ ){ cout << " ; " <<  time_beta_parsed[ cnt ]; } cout << " ]" << endl;
-   cout << "   TIME_C_I_GS        = " << time_c_i_gs  << endl;
-   cout << "   TIME_KRYSIZE       = " << time_krysize << endl;
-   cout << "   TIME_HDF5OUTPUT    = " << time_hdf5output << endl;
-   cout << "   TIME_DUMPFCI       = " << (( time_dumpfci    ) ? "TRUE" : "FALSE" ) << endl;
-   cout << "   TIME_DUMP2RDM      = " << (( time_dump2rdm   ) ? "TRUE" : "FALSE" ) << endl;
-   cout << " " << endl;
+   if ( am_i_master ){
+      cout << "\nRunning chemps2 version " << CHEMPS2_VERSION << " with the following options:\n" << endl;
+      cout << "   FCIDUMP            = " << fcidump << endl;
+      cout << "   GROUP              = " << Symmhelper.getGroupName() << endl;
+      cout << "   MULTIPLICITY       = " << multiplicity << endl;
+      cout << "   NELECTRONS         = " << nelectrons << endl;
+      cout << "   IRREP              = " << Symmhelper.getIrrepName( irrep ) << endl;
+      cout << "   TIME_TYPE          = " << time_type << endl;
+      cout << "   TIME_STEP_MAJOR    = " << time_step_major << endl;
+      cout << "   TIME_STEP_MINOR    = " << time_step_minor << endl;
+      cout << "   TIME_FINAL         = " << time_final << endl;
+      cout << "   TIME_BACKWARD      = " << time_backward << endl;
+      cout << "   TIME_ALPHA         = [ " << time_alpha_parsed[ 0 ]; for ( int cnt = 1; cnt < fcidump_norb; cnt++ ){ cout << " ; " << time_alpha_parsed[ cnt ]; } cout << " ]" << endl;
+      cout << "   TIME_BETA          = [ " <<  time_beta_parsed[ 0 ]; for ( int cnt = 1; cnt < fcidump_norb; cnt++ ){ cout << " ; " <<  time_beta_parsed[ cnt ]; } cout << " ]" << endl;
+      cout << "   TIME_C_I_GS        = " << time_c_i_gs  << endl;
+      cout << "   TIME_KRYSIZE       = " << time_krysize << endl;
+      cout << "   TIME_KRYTOL        = " << time_krytol << endl;
+      cout << "   TIME_HDF5OUTPUT    = " << time_hdf5output << endl;
+      cout << "   TIME_DUMPFCI       = " << (( time_dumpfci    ) ? "TRUE" : "FALSE" ) << endl;
+      cout << "   TIME_DUMP2RDM      = " << (( time_dump2rdm   ) ? "TRUE" : "FALSE" ) << endl;
+      cout << "   TIME_ONTHEFLY      = " << (( time_onthefly   ) ? "TRUE" : "FALSE" ) << endl;
+      cout << " " << endl;
+   }
 
    /*******************************
    *  Running the FCI calculation *
@@ -670,14 +694,14 @@ int main( int argc, char ** argv ){
       prob = new CheMPS2::Problem( ham, multiplicity - 1, nelectrons, irrep );
 
       hid_t fileID = H5_CHEMPS2_TIME_NO_H5OUT;
-      if ( time_hdf5output.length() > 0){ fileID = H5Fcreate( time_hdf5output.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT ); }
+      if (( time_hdf5output.length() > 0 ) && ( am_i_master )){ fileID = H5Fcreate( time_hdf5output.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT ); }
 
-      solver = new CheMPS2::CFCI( ham, sum_up, sum_down, irrep, 100.0, 2, fileID );
+      solver = new CheMPS2::CFCI( ham, sum_up, sum_down, irrep, 100.0, 2, fileID, time_onthefly );
       dcomplex * vectorInit = new dcomplex[ solver->getVecLength( 0 ) ];
       solver->ClearVector(solver->getVecLength( 0 ), vectorInit);
       solver->setFCIcoeff( time_alpha_parsed, time_beta_parsed, 1.0, vectorInit );
 
-      solver->TimeEvolution( time_type, time_step_major, time_step_minor, time_final, time_backward, vectorInit, time_krysize, time_dumpfci, time_dump2rdm, time_n_weights, time_hf_state_parsed );
+      solver->TimeEvolution( time_type, time_step_major, time_step_minor, time_final, time_backward, vectorInit, time_krysize, time_dumpfci, time_dump2rdm, time_n_weights, time_hf_state_parsed, time_krytol );
       delete[] vectorInit;
 
    } else {
@@ -714,9 +738,9 @@ int main( int argc, char ** argv ){
 
       // Do the dynamics calculation
       hid_t fileID = H5_CHEMPS2_TIME_NO_H5OUT;
-      if ( time_hdf5output.length() > 0){ fileID = H5Fcreate( time_hdf5output.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT ); }
+      if (( time_hdf5output.length() > 0 ) && ( am_i_master )){ fileID = H5Fcreate( time_hdf5output.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT ); }
       
-      solver = new CheMPS2::CFCI( ham, sum_up - 1, sum_down, irrep, 100.0, 2, fileID );
+      solver = new CheMPS2::CFCI( ham, sum_up - 1, sum_down, irrep, 100.0, 2, fileID, time_onthefly );
 
       dcomplex * vectorInit = new dcomplex[ solver->getVecLength( 0 ) ];
       
@@ -740,7 +764,7 @@ int main( int argc, char ** argv ){
       zscal_( &length , &factor , vectorInit , &inc );
 
       // do the time evolution
-      solver->TimeEvolution( time_type, time_step_major, time_step_minor, time_final, time_backward, vectorInit, time_krysize, time_dumpfci, time_dump2rdm, time_n_weights, time_hf_state_parsed );
+      solver->TimeEvolution( time_type, time_step_major, time_step_minor, time_final, time_backward, vectorInit, time_krysize, time_dumpfci, time_dump2rdm, time_n_weights, time_hf_state_parsed, time_krytol );
       delete[] vectorInit;
 
    }
@@ -753,5 +777,5 @@ int main( int argc, char ** argv ){
    delete [] time_beta_parsed;
    delete [] time_hf_state_parsed;
 
-   return 0;
+   return clean_exit( 0 );
 }
\ No newline at end of file
@@ -48,8 +48,10 @@ namespace CheMPS2{
              \param Nel_down The number of down (beta) electrons
              \param TargetIrrep The targeted point group irrep
              \param maxMemWorkMB Maximum workspace size in MB to be used for matrix vector product (this does not include the FCI vectors as stored for example in GSDavidson!!)
-             \param FCIverbose The FCI verbose level: 0 print nothing, 1 print start and solution, 2 print everything */
-         CFCI(CheMPS2::Hamiltonian * Ham, const unsigned int Nel_up, const unsigned int Nel_down, const int TargetIrrep, const double maxMemWorkMB=100.0, const int FCIverbose=2, const hid_t HDF5FILEIDIN=H5_CHEMPS2_TIME_NO_H5OUT );
+             \param FCIverbose The FCI verbose level: 0 print nothing, 1 print start and solution, 2 print everything
+             \param HDF5FILEIDIN The HDF5 file to which the output is written
+             \param lookupOnTheFly Whether to compute the excitation signs and counters on the fly from the bitstrings instead of storing the lookup tables (saves 4 * L^2 integers per Slater determinant of each spin projection) */
+         CFCI(CheMPS2::Hamiltonian * Ham, const unsigned int Nel_up, const unsigned int Nel_down, const int TargetIrrep, const double maxMemWorkMB=100.0, const int FCIverbose=2, const hid_t HDF5FILEIDIN=H5_CHEMPS2_TIME_NO_H5OUT, const bool lookupOnTheFly=false );
          
          //! Destructor
          virtual ~CFCI();
@@ -102,7 +104,7 @@ namespace CheMPS2{
          
 //==========> The core routines for users
          
-         void TimeEvolution( const char time_type, const double time_step_major, const double time_step_minor, double finalTime, const bool dobackwards, dcomplex * inital, unsigned int krylovSize, const bool doDumpFCI, const bool doDump2RDM, const int nWeights, const int * hfState );
+         void TimeEvolution( const char time_type, const double time_step_major, const double time_step_minor, double finalTime, const bool dobackwards, dcomplex * inital, unsigned int krylovSize, const bool doDumpFCI, const bool doDump2RDM, const int nWeights, const int * hfState, const double krylovTolerance = 1e-10 );
 
 
 //          //! Calculates the FCI ground state with Davidson's algorithm
@@ -308,7 +310,19 @@ namespace CheMPS2{
              \param vector The FCI vector with getVecLength(0) variables from which a coefficient is desired */
          void setFCIcoeff( const int * bits_up, const int * bits_down, dcomplex value, dcomplex * vector) const;
 
+         //! Weight of the determinants with nHoles holes and nParticles particles with respect to a reference determinant
+         /** \param nHoles The number of holes
+             \param nParticles The number of particles
+             \param state The FCI vector
+             \param hf_state Array of length L with the spatial occupations ( 0, 1 or 2 ) of the reference determinant
+             \return The sum of the squared norms of the corresponding FCI coefficients */
          double calcWieght( int nHoles, int nParticles, dcomplex * state, const int * hf_state );
+         
+         //! Histogram of the weights of all excitation levels with respect to a reference determinant, in one sweep over the FCI vector
+         /** \param state The FCI vector
+             \param hf_state Array of length L with the spatial occupations ( 0, 1 or 2 ) of the reference determinant
+             \param weights Array of length 2 * L + 1 which contains on exit in weights[ p ] the weight of the determinants with p particles ( and p plus the difference in particle number holes ) */
+         void calcWeights( dcomplex * state, const int * hf_state, double * weights ) const;
 
          double calc1h0p( dcomplex * state, const int * hf_state );
          
@@ -321,13 +335,6 @@ namespace CheMPS2{
                             std::vector< std::vector< int > >& betasOut,
                             std::vector< double >& coefsRealOut,
                             std::vector< double >& coefsImagOut);
-
-         void recusion( dcomplex * state, int L,
-                        std::vector< int > alphas, std::vector< int > betas,
-                        std::vector< std::vector< int > > & alphasOut,
-                        std::vector< std::vector< int > > & betasOut,
-                        std::vector< double > & coefsRealOut,
-                        std::vector< double > & coefsImagOut );
 // //==========> Functions involving Hamiltonian matrix elements
          
 //          //! Function which returns the diagonal elements of the FCI Hamiltonian (without Econstant!!) = Slater determinant energies
@@ -392,8 +399,9 @@ namespace CheMPS2{
          /** \param vecLength The vector length
              \param vec1 The first vector
              \param vec2 The second vector
-             \return The inproduct < vec1 | vec2 > */         
-         dcomplex FCIaHb(const unsigned int vecLength, dcomplex * vec1, dcomplex * vec2);
+             \param workspace Scratch vector of length vecLength, to store H | vec2 > in
+             \return The inproduct < vec1 | H | vec2 > */
+         dcomplex FCIaHb(const unsigned int vecLength, dcomplex * vec1, dcomplex * vec2, dcomplex * workspace);
 
          //! Copy a vector
          /** \param vecLength The vector length
@@ -420,7 +428,16 @@ namespace CheMPS2{
              \param vec The vector which has to be rescaled */
          static void FCIdscal(const unsigned int vecLength, const dcomplex alpha, dcomplex * vec);
          
-         void ArnoldiTimeStep( double timeStep, const bool dobackwards, unsigned int krylovSize, dcomplex * input, dcomplex * output);
+         //! One Lanczos exponential time step output = exp( -/+ i timeStep H ) input
+         /** \param timeStep The time step
+             \param dobackwards Whether to propagate backwards in time
+             \param krylovSize The maximum Krylov dimension
+             \param tolerance The Krylov dimension is increased until the a posteriori error estimate drops below tolerance
+             \param input The vector to propagate
+             \param output On exit the propagated vector
+             \param pool Array of at least krylovSize - 1 vectors, NULL or of the length of this process's slice ( getVecLength( 0 ) without MPI ); missing vectors are allocated on demand and have to be deleted by the caller
+             \return The Krylov dimension which was used */
+         int ArnoldiTimeStep( double timeStep, const bool dobackwards, unsigned int krylovSize, const double tolerance, dcomplex * input, dcomplex * output, dcomplex ** pool );
 
 // //==========> Protected functions regarding the Green's functions
          
@@ -552,6 +569,12 @@ namespace CheMPS2{
          //! For irrep "irrep_result" and down (beta) Slater determinant counter "result" lookup_sign_beta[ irrep_result ][ i + L * ( j + L * result ) ] returns the sign s which corresponds to | result > = s * E^{beta}_ij | origin >
          int *** lookup_sign_beta;
          
+         //! Whether the lookup_* tables are replaced by on-the-fly bitstring addressing
+         bool lookupOnTheFly;
+         
+         //! Largest number of up or down Slater determinants within one irrep: the size of the signmap and countmap arrays in on-the-fly mode
+         unsigned int lookup_work_size;
+         
          //! For irrep_center = irrep_creator x irrep_annihilator the number of corresponding excitation pairs E_{creator <= annihilator} is given by irrep_center_num[ irrep_center ]
          unsigned int * irrep_center_num;
          
@@ -567,8 +590,8 @@ namespace CheMPS2{
          //! Number of doubles in each of the HVXworkbig arrays
          unsigned long long HXVsizeWorkspace;
          
-         //! Work space of size L*L*L*L
-         dcomplex * HXVworksmall;
+         //! Work space of size L*L*L*L for the (real) integrals; matvec multiplies them with the interleaved real and imaginary parts of HXVworkbig1 with dgemm
+         double * HXVworksmall;
          
          //! Work space of size HXVsizeWorkspace
          dcomplex * HXVworkbig1;
@@ -591,6 +614,35 @@ namespace CheMPS2{
          //! Initialize a part of the private variables
          void StartupIrrepCenter();
          
+         //! Get the signmap and countmap of E_{crea,anni} for a given spin projection and result irrep, as in the lookup_* tables
+         /** \param alpha Whether the up (alpha) or the down (beta) Slater determinants are excited
+             \param irrep The irrep of the result Slater determinants
+             \param crea The orbital index of the creator
+             \param anni The orbital index of the annihilator
+             \param work In on-the-fly mode, array of size 2 * lookup_work_size in which the maps are computed; unused otherwise
+             \param signmap On exit points to the signs
+             \param countmap On exit points to the counters of the origin Slater determinants */
+         void getLookup( const bool alpha, const int irrep, const unsigned int crea, const unsigned int anni, int * work, int ** signmap, int ** countmap ) const;
+
+         //! The part of the Hamiltonian times vector product ( without Econstant!! ) which is computed by this MPI process; matvec sums the parts of all processes
+         /** \param input The vector of length getVecLength(0) on which the Hamiltonian should act, on all processes
+             \param output Vector of length getVecLength(0) which contains on exit this process's contribution to the Hamiltonian times input */
+         void matvec_partial( dcomplex * input, dcomplex * output ) const;
+
+         //! The start of the slice of the FCI vector which is owned by an MPI process in ArnoldiTimeStep
+         /** The slices consist of whole columns ( all up Slater determinants of one down Slater determinant ) of the irrep blocks.
+             \param rank The MPI rank; for rank == size the length of the FCI vector is returned
+             \param size The number of MPI processes
+             \return The index of the first variable of the slice */
+         unsigned int getSliceStart( const int rank, const int size ) const;
+
+         //! The inproduct of two vectors of which every MPI process holds one slice, summed over the processes
+         /** \param size The length of the slice of this process
+             \param vec1 The slice of the first vector
+             \param vec2 The slice of the second vector
+             \return The inproduct < vec1 | vec2 > of the full vectors */
+         static dcomplex sliceddot( const unsigned int size, dcomplex * vec1, dcomplex * vec2 );
+         
 //          //! Actual routine used by Fill3RDM, Fock4RDM, Diag4RDM
 //          double Driver3RDM(double * vector, double * output, double * three_rdm, double * fock, const unsigned int orbz) const;
 
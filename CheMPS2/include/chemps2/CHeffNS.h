@@ -34,8 +34,9 @@ namespace CheMPS2 {
       /** \param denBKIn The SyBookkeeper to get the dimensions
       \param ProbIn The Problem that contains the Hamiltonian
       \param dvdson_rtol_in The residual tolerance for the DMRG Davidson
-     iterations */
-      CHeffNS( const SyBookkeeper * bk_upIn, const SyBookkeeper * bk_downIn, const Problem * ProbIn, const dcomplex offsetEnergyIn );
+     iterations
+      \param timingsIn If not NULL, the thread times of the diagram classes are added to it, indexed with CHEMPS2_CTIME_HEFF_* */
+      CHeffNS( const SyBookkeeper * bk_upIn, const SyBookkeeper * bk_downIn, const Problem * ProbIn, const dcomplex offsetEnergyIn, double * timingsIn = NULL );
 
       void Apply( CSobject * denS, CSobject * denP, CTensorL *** Ltensors,
                   CTensorLT *** LtensorsT, CTensorOperator **** Atensors,
@@ -72,6 +73,9 @@ namespace CheMPS2 {
 
       const dcomplex offsetEnergy;
 
+      // The timings of the diagram classes
+      double * timings;
+
       void makeHeff( CSobject * denS, CSobject * denP, CTensorL *** Ltensors,
                      CTensorLT *** LtensorsT, CTensorOperator **** Atensors,
                      CTensorOperator **** AtensorsT, CTensorOperator **** Btensors,
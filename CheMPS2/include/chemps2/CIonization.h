@@ -0,0 +1,60 @@
+/*
+   CheMPS2: a spin-adapted implementation of DMRG for ab initio quantum chemistry
+   Copyright (C) 2013-2017 Sebastian Wouters
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+
+#ifndef CIONIZATION_CHEMPS2_H
+#define CIONIZATION_CHEMPS2_H
+
+#include "CTensorT.h"
+#include "Hamiltonian.h"
+#include "Problem.h"
+#include "SyBookkeeper.h"
+
+namespace CheMPS2 {
+
+   /* An ionization moves an electron from the orbitals of an MPS with L sites to a continuum orbital L, which is appended to the chain.
+      The ionized problem has L + 1 orbitals and the particle number, spin and irrep of the MPS, and the continuum orbital holds exactly
+      one electron. The annihilator sum_k coefs[ k ] a_{ positions[ k ] } is represented by the hopping terms between the ionized
+      orbitals and the continuum orbital in the Hamiltonian of the ionized problem. */
+
+   //! The Hamiltonian of an ionization: ham with an extra continuum orbital, and only the hopping terms coefs[ k ] between positions[ k ] and the continuum orbital
+   /** \param ham The Hamiltonian of the MPS, of which only the orbital irreps are used
+       \param group The point group
+       \param numPositions The number of ionized orbitals, which should all have the same irrep
+       \param positions The ionized orbitals ( Hamiltonian indices )
+       \param coefs The coefficients of the annihilators
+       \return The Hamiltonian with L + 1 orbitals; the caller deletes it */
+   Hamiltonian * ionizationHamiltonian( const Hamiltonian * ham, const int group, const int numPositions, const int * positions, const double * coefs );
+
+   //! The ionized problem, in which the continuum orbital of hamION is occupied by exactly one electron
+   /** \return The problem with its matrix elements constructed; the caller deletes it */
+   Problem * ionizationProblem( const Hamiltonian * hamION, const int two_s, const int nelec, const int irrep );
+
+   //! Construct mpsOut = sum_k coefs[ k ] sum_sigma a^+_{L sigma} a_{positions[ k ] sigma} mpsIn exactly, without a variational fit
+   /** \param mpsIn The MPS with L sites, which is only read
+       \param bkIn The bookkeeper of mpsIn, which is only read
+       \param mpsOut The L + 1 site tensors of the ionized state, which are resized to the virtual dimensions of bkOut
+       \param bkOut The bookkeeper of probOut, of which the virtual dimensions are set to those of the exact state
+       \param probOut The ionized problem of ionizationProblem; at least one of its hopping terms should differ from zero
+       \param D When larger than zero, recompress the exact state with SVDs to at most this virtual dimension */
+   void applyAnnihilator( CTensorT ** mpsIn, SyBookkeeper * bkIn, CTensorT ** mpsOut, SyBookkeeper * bkOut, Problem * probOut, const int D = 0 );
+
+}
+
+#endif
@@ -0,0 +1,67 @@
+/*
+   CheMPS2: a spin-adapted implementation of DMRG for ab initio quantum chemistry
+   Copyright (C) 2013-2017 Sebastian Wouters
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License along
+   with this program; if not, write to the Free Software Foundation, Inc.,
+   51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef CMPSIO_CHEMPS2_H
+#define CMPSIO_CHEMPS2_H
+
+#include "CTensorT.h"
+#include "MyHDF5.h"
+#include "SyBookkeeper.h"
+
+#include <string>
+
+namespace CheMPS2 {
+
+   /* The packed MPS format consists of three datasets in one HDF5 group:
+        VirtDims : the virtual dimensions of all ( boundary, N, TwoS, irrep ) sectors, in the loop order of the bookkeeper
+        Offsets  : L + 1 offsets ( in doubles ) of the site tensors in Storage
+        Storage  : the storage of all site tensors after each other, as real and imaginary parts, in the order of kappa2index
+      The older format with one group per virtual dimension and per site tensor can still be loaded. */
+
+   //! Write an MPS in the packed format
+   /** \param groupID The open HDF5 file or group to write to
+       \param mps The site tensors
+       \param bk The bookkeeper of the MPS
+       \param deflate The gzip level ( 0 - 9 ) of the storage, 0 means contiguous and uncompressed */
+   void writePackedMPS( const hid_t groupID, CTensorT ** mps, SyBookkeeper * bk, const int deflate = 0 );
+
+   //! Read the virtual dimensions of a packed MPS into a bookkeeper
+   /** \param groupID The open HDF5 file or group to read from
+       \param bk The bookkeeper to set; it is left untouched when the group holds no packed MPS with its symmetry sectors
+       \return Whether the virtual dimensions were read */
+   bool readPackedDIM( const hid_t groupID, SyBookkeeper * bk );
+
+   //! Read the site tensors of a packed MPS directly into their storage
+   /** \param groupID The open HDF5 file or group to read from
+       \param L The number of sites
+       \param mps The site tensors, allocated with the virtual dimensions of readPackedDIM */
+   void readPackedMPS( const hid_t groupID, const int L, CTensorT ** mps );
+
+   //! Save an MPS to a new HDF5 file in the packed format
+   void saveMPS( const std::string name, CTensorT ** mps, SyBookkeeper * bk, const int deflate = 0 );
+
+   //! Load the virtual dimensions of an MPS file in the packed or the older format
+   void loadDIM( const std::string name, SyBookkeeper * bk );
+
+   //! Load the site tensors of an MPS file in the packed or the older format
+   void loadMPS( const std::string name, const int L, CTensorT ** mps );
+
+}
+
+#endif
@@ -53,11 +53,11 @@ namespace CheMPS2 {
 
       void AddNonExpandedToExpanded( CTensorT * expanded, CTensorT * nonExpanded );
 
-      void decomposeMovingLeft( bool change, int virtualdimensionD, double cut_off,
-                                CTensorT * expandedLeft, SyBookkeeper * expandedLeftBK,
-                                CTensorT * expandedRight, SyBookkeeper * expandedRightBK,
-                                CTensorT * newLeft, SyBookkeeper * newLeftBK,
-                                CTensorT * newRight, SyBookkeeper * newRightBK );
+      double decomposeMovingLeft( bool change, int virtualdimensionD, double cut_off,
+                                  CTensorT * expandedLeft, SyBookkeeper * expandedLeftBK,
+                                  CTensorT * expandedRight, SyBookkeeper * expandedRightBK,
+                                  CTensorT * newLeft, SyBookkeeper * newLeftBK,
+                                  CTensorT * newRight, SyBookkeeper * newRightBK );
 
       // void Apply( CSobject * denS, CSobject * denP,
       //             CTensorL *** Ltensors,
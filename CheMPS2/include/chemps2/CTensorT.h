@@ -209,17 +209,21 @@ namespace CheMPS2 {
 
    void right_normalize( CTensorT * left_mps, CTensorT * right_mps );
 
-   void decomposeMovingLeft( bool change, int virtualdimensionD, double cut_off,
-                             CTensorT * oldLeft, SyBookkeeper * oldLeftBK,
-                             CTensorT * oldRight, SyBookkeeper * oldRightBK,
-                             CTensorT * newLeft, SyBookkeeper * newLeftBK,
-                             CTensorT * newRight, SyBookkeeper * newRightBK );
-
-   void decomposeMovingRight( bool change, int virtualdimensionD, double cut_off,
-                              CTensorT * oldLeft, SyBookkeeper * oldLeftBK,
-                              CTensorT * oldRight, SyBookkeeper * oldRightBK,
-                              CTensorT * newLeft, SyBookkeeper * newLeftBK,
-                              CTensorT * newRight, SyBookkeeper * newRightBK );
+   //! Split the two-site object oldLeft oldRight with an SVD into newLeft and the right-normalized newRight
+   /** \return the discarded weight if change==true ; else 0.0 */
+   double decomposeMovingLeft( bool change, int virtualdimensionD, double cut_off,
+                               CTensorT * oldLeft, SyBookkeeper * oldLeftBK,
+                               CTensorT * oldRight, SyBookkeeper * oldRightBK,
+                               CTensorT * newLeft, SyBookkeeper * newLeftBK,
+                               CTensorT * newRight, SyBookkeeper * newRightBK );
+
+   //! Split the two-site object oldLeft oldRight with an SVD into the left-normalized newLeft and newRight
+   /** \return the discarded weight if change==true ; else 0.0 */
+   double decomposeMovingRight( bool change, int virtualdimensionD, double cut_off,
+                                CTensorT * oldLeft, SyBookkeeper * oldLeftBK,
+                                CTensorT * oldRight, SyBookkeeper * oldRightBK,
+                                CTensorT * newLeft, SyBookkeeper * newLeftBK,
+                                CTensorT * newRight, SyBookkeeper * newRightBK );
 } // namespace CheMPS2
 
 #endif
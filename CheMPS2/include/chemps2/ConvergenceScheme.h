@@ -33,6 +33,7 @@ namespace CheMPS2 {
     (3) the maximum number of iterations, in case the energy changes do not drop below the threshold\n
     (4) the noise prefactor f\n
     (5) the Davidson residual tolerance\n
+    (6) the fit tolerance, below which the relative change of the norm between sweeps ends the instruction early in the fits of HamiltonianOperator\n
     \n
     The noise level which is added to the Sobject is the product of\n
     (1) f\n
@@ -111,6 +112,16 @@ namespace CheMPS2 {
              \return the Davidson residual tolerance for this instruction */
       double get_dvdson_rtol( const int instruction ) const;
 
+      //! Set the fit tolerance for a particular instruction
+      /** \param instruction the number of the instruction
+             \param fit_tol the fit tolerance for that instruction; 0.0 ( default ) always performs the max. number of sweeps */
+      void set_fit_tolerance( const int instruction, const double fit_tol );
+
+      //! Get the fit tolerance for a particular instruction
+      /** \param instruction the number of the instruction
+             \return the fit tolerance for this instruction */
+      double get_fit_tolerance( const int instruction ) const;
+
       private:
       //The number of instructions
       int num_instructions;
@@ -132,6 +143,9 @@ namespace CheMPS2 {
 
       //The Davidson residual tolerance for each instruction
       double * dvdson_rtol;
+
+      //The fit tolerance for each instruction
+      double * fit_tolerance;
    };
 }
 
@@ -20,6 +20,7 @@
 #ifndef HAMILTONIANOPERATOR_CHEMPS2_H
 #define HAMILTONIANOPERATOR_CHEMPS2_H
 
+#include "CSobject.h"
 #include "CTensorF0.h"
 #include "CTensorF0T.h"
 #include "CTensorF1.h"
@@ -37,7 +38,43 @@
 #include "Problem.h"
 #include "ConvergenceScheme.h"
 
+#include <sys/time.h>
+
+// For the timings of the different parts of the complex operator path: wall times in seconds
+#define CHEMPS2_CTIME_HEFF         0
+#define CHEMPS2_CTIME_ENV          1
+#define CHEMPS2_CTIME_ENV_ALLOC    2
+#define CHEMPS2_CTIME_SPLIT        3
+// Summed over the threads: the diagram classes of CHeffNS::Apply
+#define CHEMPS2_CTIME_HEFF_LOCAL   4
+#define CHEMPS2_CTIME_HEFF_LEFT    5
+#define CHEMPS2_CTIME_HEFF_RIGHT   6
+#define CHEMPS2_CTIME_HEFF_BOTH    7
+#define CHEMPS2_CTIME_HEFF_OVERLAP 8
+// Summed over the threads: the boundary operator families
+#define CHEMPS2_CTIME_ENV_L        9
+#define CHEMPS2_CTIME_ENV_FS       10
+#define CHEMPS2_CTIME_ENV_ABCD     11
+#define CHEMPS2_CTIME_ENV_Q        12
+#define CHEMPS2_CTIME_ENV_XO       13
+#define CHEMPS2_CTIME_VECLENGTH    14
+
+// For the counters of the complex operator path
+#define CHEMPS2_CCOUNT_HEFF        0
+#define CHEMPS2_CCOUNT_HEFF_BLOCKS 1
+#define CHEMPS2_CCOUNT_ENV_BUILD   2
+#define CHEMPS2_CCOUNT_ENV_REUSE   3
+#define CHEMPS2_CCOUNT_ENV_BYTES   4
+#define CHEMPS2_CCOUNT_SPLIT       5
+#define CHEMPS2_CCOUNT_FITS        6
+#define CHEMPS2_CCOUNT_SWEEPS      7
+#define CHEMPS2_CCOUNT_VECLENGTH   8
+
 namespace CheMPS2 {
+
+   //! Add the wall time since start to elapsed ( in seconds ), and restart the clock; used for the CHEMPS2_CTIME_* timings
+   void lap( struct timeval & start, double & elapsed );
+
    /** HamiltonianOperator class.
     \author Lars-Hendrik Frahm
     \date February 22, 2018
@@ -76,6 +113,12 @@ namespace CheMPS2 {
                             ConvergenceScheme * scheme );
 
       // Double Site functions
+      //! Fit mpsOut to H mpsA + sum_st factors[ st ] states[ st ] with two-site sweeps
+      /** \param method ( F ) sweeps the whole scheme from the guess in mpsOut. ( S ) seeds mpsOut with a copy of mpsA, whose
+                        bases already carry most of H mpsA, and does a single sweep with the last instruction of the scheme,
+                        truncating the bonds with its virtual dimension and cut-off. ( W ) seeds mpsOut in the same way and then
+                        sweeps the whole scheme. With S and W, bkOut is given the virtual dimensions of bkA. An instruction
+                        ends early when the norm of mpsOut changes relatively less than scheme->get_fit_tolerance between sweeps. */
       void DSApplyAndAdd( CTensorT ** mpsA, SyBookkeeper * bkA,
                           int statesToAdd,
                           dcomplex * factors,
@@ -83,13 +126,15 @@ namespace CheMPS2 {
                           SyBookkeeper ** bookkeepers,
                           CTensorT ** mpsOut, SyBookkeeper * bkOut,
                           ConvergenceScheme * scheme,
-                          const double dimensionFactor = 1.0 );
+                          const double dimensionFactor = 1.0,
+                          const char method = 'F' );
 
       // Double Site functions
       void DSApply( CTensorT ** mpsA, SyBookkeeper * bkA,
                     CTensorT ** mpsOut, SyBookkeeper * bkOut,
                     ConvergenceScheme * scheme,
-                    const double dimensionFactor = 1.0 );
+                    const double dimensionFactor = 1.0,
+                    const char method = 'F' );
 
       void DSSum( int statesToAdd,
                   dcomplex * factors, CTensorT *** states, SyBookkeeper ** bookkeepers,
@@ -97,6 +142,46 @@ namespace CheMPS2 {
                   ConvergenceScheme * scheme,
                   const double dimensionFactor = 1.0 );
 
+      // Time-dependent variational principle
+      //! One symmetric ( second order ) TDVP sweep: mps <-- exp( step * H ) mps, in place
+      /** \param step The complex time step, e.g. -i dt for real time evolution
+             \param twoSite Whether to use the two-site ( bond dimension can grow ) or the one-site ( fixed bond dimension ) integrator
+             \param mps The MPS which is evolved
+             \param bk The SyBookkeeper of mps, which is changed when twoSite
+             \param scheme The virtual dimension and cut-off of its last instruction are used for the two-site splits
+             \param krylovSize Maximum number of Lanczos vectors for the local exponentials
+             \param tolerance The Lanczos recursions of the local exponentials stop once their error estimate drops below tolerance ( 1e-12 when not positive ) */
+      void TDVP( const dcomplex step, const bool twoSite,
+                 CTensorT ** mps, SyBookkeeper * bk,
+                 ConvergenceScheme * scheme, const int krylovSize,
+                 const double tolerance = 0.0 );
+
+      //! Set all timings and counters to zero
+      void ClearProfile();
+
+      //! Delete all boundary operators, so that they are all rebuilt on their next use
+      void ClearBoundaryOperators();
+
+      //! Get the timings, indexed with CHEMPS2_CTIME_*
+      /** \return The array of CHEMPS2_CTIME_VECLENGTH timings ( seconds ) since the last ClearProfile */
+      const double * gTimings() const { return timings; }
+
+      //! Get the counters, indexed with CHEMPS2_CCOUNT_*
+      /** \return The array of CHEMPS2_CCOUNT_VECLENGTH counters since the last ClearProfile */
+      const long long * gCounters() const { return counters; }
+
+      //! Get the largest discarded weight of the splits at each virtual boundary
+      /** \return The array of L + 1 discarded weights since the last ClearProfile */
+      const double * gDiscardedWeights() const { return boundDiscarded; }
+
+      //! Get the largest kept virtual dimension of the splits at each virtual boundary
+      /** \return The array of L + 1 total virtual dimensions since the last ClearProfile */
+      const int * gKeptDimensions() const { return boundKept; }
+
+      //! Get the truncation error budget
+      /** \return The sum over the fits since the last ClearProfile of the largest discarded weight in their last sweep */
+      double gDiscardedBudget() const { return fitDiscarded; }
+
       private:
       void updateMovingLeftSafe( const int cnt, CTensorT ** mpsUp, SyBookkeeper * bkUp, CTensorT ** mpsDown, SyBookkeeper * bkDown );
 
@@ -104,6 +189,12 @@ namespace CheMPS2 {
 
       void deleteAllBoundaryOperators();
 
+      bool isUpToDate( const int cnt, const bool movingRight, CTensorT * siteUp, SyBookkeeper * bkUp, CTensorT * siteDown, SyBookkeeper * bkDown ) const;
+
+      void stampBoundary( const int cnt, const bool movingRight, CTensorT * siteUp, SyBookkeeper * bkUp, CTensorT * siteDown, SyBookkeeper * bkDown );
+
+      static unsigned long long fingerprint( CTensorT * tensor );
+
       void updateMovingLeft( const int index, CTensorT ** mpsUp, SyBookkeeper * bkUp, CTensorT ** mpsDown, SyBookkeeper * bkDown );
 
       void updateMovingRight( const int index, CTensorT ** mpsUp, SyBookkeeper * bkUp, CTensorT ** mpsDown, SyBookkeeper * bkDown );
@@ -112,6 +203,18 @@ namespace CheMPS2 {
 
       void deleteTensors( const int index, const bool movingRight );
 
+      long long boundaryBytes( const int index, const bool movingRight ) const;
+
+      void recordSplit( const int bound, const double discarded, SyBookkeeper * bk, double & sweepDiscarded );
+
+      void recordFit( const int sweeps, const double lastSweepDiscarded );
+
+      bool fitConverged( CTensorT ** mps, const double tolerance, double & previousNorm ) const;
+
+      void localExponential( const dcomplex step, const int krylovSize, const double threshold, CTensorT * tensor, CSobject * sobject, CTensorT * projector, const bool movingRight );
+
+      void applyEffective( CTensorT * in, CTensorT * out, CSobject * sin, CSobject * sout, CTensorT * projector, const bool movingRight );
+
       void orthogonalize( int pos, const int numStates, CTensorT *mpsMain, SyBookkeeper * bkMain, CTensorT **os, SyBookkeeper **bks, CTensorT * mpsOut, SyBookkeeper *bkOut, bool movingRight );
 
       const Problem * prob;
@@ -123,6 +226,32 @@ namespace CheMPS2 {
       // Whether or not allocated
       int * isAllocated;
 
+      // Fingerprints of the site tensors which were absorbed into the boundary operators when they were last built
+      unsigned long long * stampUp;
+      unsigned long long * stampDown;
+
+      // Ids of the bookkeepers with which the boundary operators were last built
+      unsigned long long * stampBkUp;
+      unsigned long long * stampBkDown;
+
+      // Build counter of each boundary and of the neighbouring boundary it was built from
+      unsigned long long * buildCount;
+      unsigned long long * buildCountNeighbour;
+      unsigned long long buildCounter;
+
+      // Fingerprints of the site tensors which the last TDVP sweep left right-normalized, and the id of its bookkeeper
+      unsigned long long * stampCanonical;
+      unsigned long long stampCanonicalBk;
+
+      // Performance counters
+      double timings[ CHEMPS2_CTIME_VECLENGTH ];
+      long long counters[ CHEMPS2_CCOUNT_VECLENGTH ];
+
+      // Truncation telemetry: per virtual boundary the largest discarded weight and kept dimension, and the summed budget of the fits
+      double * boundDiscarded;
+      int * boundKept;
+      double fitDiscarded;
+
       // TensorL's
       CTensorL *** Ltensors;
       CTensorLT *** LtensorsT;
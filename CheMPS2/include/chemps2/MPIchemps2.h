@@ -314,6 +314,39 @@ namespace CheMPS2{
             MPI_Allreduce(vec_in, vec_out, size, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
          }
          #endif
+         
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Add arrays of all processes in place and give everyone the result
+         /** \param vec The array which should be added, and where the result is stored
+             \param size The size of the array, which is reduced in chunks as MPI counts are int */
+         static void allreduce_array_double_inplace(double * vec, long long size){
+            const long long chunk = 1LL << 30;
+            for ( long long start = 0; start < size; start += chunk ){
+               const int count = ( int )(( size - start < chunk ) ? size - start : chunk );
+               MPI_Allreduce(MPI_IN_PLACE, vec + start, count, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+            }
+         }
+         #endif
+
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Add arrays of complex numbers of all processes and give every process its slice of the result
+         /** \param vec_in The array of interleaved real and imaginary parts which should be added
+             \param vec_out The array where the slice of this process of the result should be stored
+             \param counts The number of complex numbers in the slice of each process; the slices are consecutive */
+         static void reduce_scatter_array_complex(double * vec_in, double * vec_out, int * counts){
+            MPI_Reduce_scatter(vec_in, vec_out, counts, MPI_C_DOUBLE_COMPLEX, MPI_SUM, MPI_COMM_WORLD);
+         }
+         #endif
+
+         #ifdef CHEMPS2_MPI_COMPILATION
+         //! Gather the slices of all processes of an array of complex numbers in place
+         /** \param vec The array of interleaved real and imaginary parts, which contains the slice of this process on entry and the full array on exit
+             \param counts The number of complex numbers in the slice of each process
+             \param starts The index of the first complex number of the slice of each process */
+         static void allgather_array_complex_inplace(double * vec, int * counts, int * starts){
+            MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, vec, counts, starts, MPI_C_DOUBLE_COMPLEX, MPI_COMM_WORLD);
+         }
+         #endif
 
    };
 }
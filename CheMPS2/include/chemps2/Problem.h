@@ -50,6 +50,10 @@ namespace CheMPS2 {
              \param DtIn The time step for time evoulution */
       Problem( const Hamiltonian * Hamin, const int TwoSin, const int Nin, const int Irrepin, const int InitialIn = INIT_RANDOM );
 
+      //! Copy constructor
+      /** \param tocopy The Problem to be copied, including its reordering, occupation bounds and matrix elements; the window of set_mxelem_window is not copied */
+      Problem( const Problem & tocopy );
+
       //! Destructor
       virtual ~Problem();
 
@@ -96,7 +100,7 @@ namespace CheMPS2 {
              \return \f$ h_{\alpha \beta ; \gamma \delta} = \left(\alpha \beta \mid V \mid \gamma \delta \right) + \frac{1}{N-1} \left( \left( \alpha \mid T \mid \gamma \right) \delta_{\beta \delta} + \delta_{\alpha \gamma} \left( \beta \mid T \mid \delta \right) \right) \f$ */
       double gMxElement( const int alpha, const int beta, const int gamma, const int delta ) const;
 
-      //! Set the matrix elements: Note that each time you create a DMRG object, they will be overwritten with the eightfold permutation symmetric Hamiltonian again!!!
+      //! Set the matrix elements: Note that each time you create a DMRG object, they will be overwritten with the eightfold permutation symmetric Hamiltonian again!!! Not possible with Cholesky vectors.
       /** \param alpha The first index (0 <= alpha < L)
              \param beta The second index
              \param gamma The third index
@@ -107,6 +111,25 @@ namespace CheMPS2 {
       //! Construct a table with the h-matrix elements (two-body augmented with one-body). Remember to recall this function each time you change the Hamiltonian!
       void construct_mxelem();
 
+      //! Let construct_mxelem represent the two-body matrix elements by pivoted Cholesky vectors instead of a table with L^4 elements
+      /** \param threshold The largest diagonal element of the residual two-body supermatrix ( alpha gamma | beta delta ) which is left out; 0.0 (default) constructs the full table */
+      void set_cholesky_threshold( const double threshold );
+
+      //! Get the number of Cholesky vectors of the two-body matrix elements
+      /** \return The number of Cholesky vectors; 0 if construct_mxelem constructed the full table */
+      int gNumCholesky() const { return num_cholesky; }
+
+      //! With Cholesky vectors, tabulate all matrix elements with an index on orb1 or orb2, so that gMxElement reads them from a table instead of contracting the vectors
+      /** The table holds ( 4 L - 4 ) x L^2 elements and is only rebuilt when orb1 or orb2 is not in the current window. It has to be set outside of parallel regions, before
+          the boundary operators or effective Hamiltonian around orb1 and orb2 are built or applied. Without Cholesky vectors nothing is done.
+
+          Thread safety: although the function is const, it rebuilds the mutable window which gMxElement reads. Concurrent calls of gMxElement are safe, but no call of
+          gMxElement on the same object may run concurrently with set_mxelem_window, from any thread. Two tasks which work on different windows at the same time, such as
+          a measurement next to the propagation, each need their own copy of the Problem, which starts without a window.
+             \param orb1 The first orbital of the window
+             \param orb2 The second orbital of the window; pass orb1 for a window with a single orbital */
+      void set_mxelem_window( const int orb1, const int orb2 ) const;
+
       //! Check whether the given parameters L, N, and TwoS are not inconsistent and whether 0<=Irrep<nIrreps. A more thorough test will be done when the FCI virtual dimensions are constructed.
       /** \return True if consistent, else false */
       bool checkConsistency() const;
@@ -188,6 +211,43 @@ namespace CheMPS2 {
 
       //Matrix element table
       double * mx_elem;
+
+      //Threshold for the Cholesky decomposition of the two-body matrix elements; 0.0 means the full table
+      double cholesky_threshold;
+
+      //Number of Cholesky vectors
+      int num_cholesky;
+
+      //Cholesky vectors: ( alpha gamma | beta delta ) = sum_vec cholesky[ vec + num_cholesky * ( alpha + L * gamma ) ] * cholesky[ vec + num_cholesky * ( beta + L * delta ) ]
+      double * cholesky;
+
+      //The Cholesky vectors are sorted by the irrep of the pairs ( alpha, gamma ) on which they differ from zero: irrep I has cholesky_start[ I ] <= vec < cholesky_start[ I + 1 ]
+      int * cholesky_start;
+
+      //One-body part 1/(N-1) T of the matrix elements, which is added to the Cholesky representation
+      double * mx_onebody;
+
+      //The orbitals of the current window of set_mxelem_window; -1 if there is none
+      mutable int window_orb1;
+      mutable int window_orb2;
+
+      //Number of orbital pairs in the window
+      mutable int num_window;
+
+      //window_slot[ alpha + L * gamma ] is the slot of the pair ( alpha, gamma ) in window_table, or -1 if it is not in the window
+      mutable int * window_slot;
+
+      //Matrix elements of the window: window_table[ slot + num_window * ( beta + L * delta ) ] for the pair ( alpha, gamma ) in slot
+      mutable double * window_table;
+
+      //Construct the Cholesky vectors and the one-body part
+      void construct_cholesky();
+
+      //Forget the window of set_mxelem_window
+      void clear_window() const;
+
+      //Not assignable: the copy constructor allocates the owned arrays, an implicit assignment would share and double free them
+      Problem & operator=( const Problem & tocopy );
    };
 }
 
@@ -59,6 +59,10 @@ namespace CheMPS2 {
       /** \return The Problem of the SyBookkeeper */
       const Problem * gProb() const;
 
+      //! Get the unique id of the SyBookkeeper
+      /** \return A number which is different for every SyBookkeeper ever constructed ( copies included ), and increases with the construction order */
+      inline unsigned long long gId() const { return id; }
+
       //! Get the number of orbitals
       /** \return The number of orbitals */
       inline int gL() const { return Prob->gL(); }
@@ -163,6 +167,12 @@ namespace CheMPS2 {
       // Pointer to the Problem --> constructed and destructed outside of this class
       const Problem * Prob;
 
+      // The unique id of this SyBookkeeper
+      unsigned long long id;
+
+      // Hand out the next unique id
+      static unsigned long long next_id();
+
       // The number of irreps
       int num_irreps;
 
@@ -3,61 +3,111 @@
 
 #include "CTensorT.h"
 #include "ConvergenceScheme.h"
+#include "HamiltonianOperator.h"
 #include "Logger.h"
 #include "MyHDF5.h"
 #include "Problem.h"
 #include "SyBookkeeper.h"
 #include "hdf5_hl.h"
 #include <ctime>
+#include <string>
 
 namespace CheMPS2 {
 
    class TimeEvolution {
       public:
       //! Constructor
-      /** \param Problem to problem to be solved*/
-      TimeEvolution( Problem * probIn, ConvergenceScheme * schemeIn, hid_t HDF5FILEIDIN );
+      /** \param Problem to problem to be solved
+          \param deflateIn The gzip level ( 0 - 9 ) of the chunked output series, 0 means uncompressed */
+      TimeEvolution( Problem * probIn, ConvergenceScheme * schemeIn, hid_t HDF5FILEIDIN, const int deflateIn = 0 );
 
       ~TimeEvolution();
 
-      void Propagate( const char time_type, const double time_step_major, 
+      //! Propagate the MPS from mpsIn over [ 0, time_final ] and write its observables to the HDF5 output
+      /** \param doDumpFCI Dump the FCI coefficients, which is only possible for at most 64 orbitals
+          \return Whether the propagation could be started: false if doDumpFCI is requested for more than 64 orbitals,
+                  or if a restart is requested from the checkpoint of a run with other input */
+      bool Propagate( const char time_type, const double time_step_major, 
                       const double time_step_minor, const double time_final, 
                       CTensorT ** mpsIn, SyBookkeeper * bkIn, 
                       const int kry_size, 
                       const bool backwards, const double offset,
                       const bool do_ortho, const bool doDumpFCI, 
                       const bool doDump2RDM, const int nWeights = 0,
-                      const int * hfState = NULL );
+                      const int * hfState = NULL,
+                      const double tolerance = 0.0,
+                      const std::string checkpoint = "",
+                      const bool restart = false,
+                      const char apply = 'F' );
 
       private:
       void HDF5_MAKE_DATASET( hid_t setID, const char * name, int rank,
                               const hsize_t * dims, hid_t typeID, const void * data );
 
-      double calcWieght( int nHoles, int nParticles, Problem * probState, CTensorT ** mpsState, SyBookkeeper * bkState, const int * hf_state );
+      //! Append dims[ 0 ] rows to an extendible, chunked dataset along its first ( unlimited ) dimension; the dataset is created on first use
+      void HDF5_APPEND_DATASET( hid_t setID, const char * name, int rank,
+                                const hsize_t * dims, hid_t typeID, const void * data );
 
-      double calc1h0p( Problem * probState, CTensorT ** mpsState, SyBookkeeper * bkState, const int * hf_state );
+      //! All excitation class weights with respect to hf_state in a single sweep over the MPS
+      void calcWeights( const int nWeights, const int * nHoles, const int * nParticles, Problem * probState, CTensorT ** mpsState, SyBookkeeper * bkState, const int * hf_state, double * weights );
 
-      double calc2h1p( Problem * probState, CTensorT ** mpsState, SyBookkeeper * bkState, const int * hf_state );
+      //! Evaluate the observables of mps at time t with the matrix elements of probMeasure, append them to the HDF5 output and write their summary to report
+      /** expectation is the real part of < mps | H + offset | mps >, evaluated by the caller with the operator of the propagation. */
+      void measure( const double t, const double elapsed, const double offset, Problem * probMeasure, const double expectation,
+                    CTensorT ** mpsInit, CTensorT ** mps, SyBookkeeper * bk, const hid_t outputID,
+                    const int nWeights, const int * nHoles, const int * nParticles, const int * hfState, double * weights,
+                    const bool doDumpFCI, long long * fciTotal, const bool doDump2RDM, std::ostream & report );
+
+      //! Print the timings, counters and truncation telemetry of op for the step from t, and append them with the wall times of the step and of the measurement to the HDF5 output
+      /** The truncation error budget of the step is the sum over its fits of the largest discarded weight in their last sweep. */
+      void profile( const double t, const double stepTime, const double measureTime, HamiltonianOperator * op, const hid_t outputID );
+
+      //! Atomically replace the checkpoint file with the run parameters, the MPS at time t, the minor time step and the lengths of the output series
+      void writeCheckpoint( const std::string filename, const char time_type, const double time_step_major, const double time_step_minor,
+                            const double t, const double chrono, const double time_step,
+                            const long long fciTotal, const hid_t outputID, CTensorT ** mps, SyBookkeeper * bk );
+
+      //! Whether the checkpoint file, if it exists, was written by a run of the same problem with the same TIME_TYPE, time steps and convergence scheme
+      bool checkpointMatches( const std::string filename, const char time_type, const double time_step_major, const double time_step_minor,
+                              SyBookkeeper * bk ) const;
+
+      //! Restore the MPS and the integrator state from the checkpoint file, and cut the output series back to their lengths at the checkpoint
+      /** The checkpoint should have passed checkpointMatches.
+          \return Whether a checkpoint was found; if not, mps and bk are left untouched */
+      bool readCheckpoint( const std::string filename, double * t, double * chrono, double * time_step,
+                           long long * fciTotal, const hid_t outputID, CTensorT ** mps, SyBookkeeper * bk );
 
       void doStep_euler( const double time_step, const int kry_size, 
-                         dcomplex offset, const bool backwards, 
+                         HamiltonianOperator * op, const bool backwards, 
                          CTensorT ** mpsIn, SyBookkeeper * bkIn, 
                          CTensorT ** mpsOut, SyBookkeeper * bkOut );
 
-      void doStep_arnoldi( const double time_step, 
-                           const int kry_size, 
-                           dcomplex offset, 
-                           const bool backwards, 
-                           const bool do_ortho,
-                           CTensorT ** mpsIn, 
-                           SyBookkeeper * bkIn, 
-                           CTensorT ** mpsOut, 
-                           SyBookkeeper * bkOut );
-
-      void doStep_runge_kutta( const double time_step, const int kry_size, 
-                               dcomplex offset, const bool backwards, 
-                               CTensorT ** mpsIn, SyBookkeeper * bkIn, 
-                               CTensorT ** mpsOut, SyBookkeeper * bkOut );
+      //! Lanczos approximation of exp( -i time_step H ) | mpsIn > with at most kry_size vectors, which stops early once the error estimate is below tolerance
+      /** \param apply The method of HamiltonianOperator::DSApplyAndAdd for the Lanczos vectors
+          \return The a-posteriori error estimate of the Lanczos approximation */
+      double doStep_arnoldi( const double time_step, 
+                             const int kry_size, 
+                             HamiltonianOperator * op, 
+                             const bool backwards, 
+                             const bool do_ortho,
+                             const double tolerance,
+                             const char apply,
+                             CTensorT ** mpsIn, 
+                             SyBookkeeper * bkIn, 
+                             CTensorT ** mpsOut, 
+                             SyBookkeeper * bkOut );
+
+      //! \return Norm of the difference with the embedded third order solution, which estimates the error
+      double doStep_runge_kutta( const double time_step, const int kry_size, 
+                                 HamiltonianOperator * op, const bool backwards, 
+                                 const char apply,
+                                 CTensorT ** mpsIn, SyBookkeeper * bkIn, 
+                                 CTensorT ** mpsOut, SyBookkeeper * bkOut );
+
+      void doStep_tdvp( const double time_step, const int kry_size, 
+                        HamiltonianOperator * op, const bool backwards, 
+                        const bool twoSite, const double tolerance,
+                        CTensorT ** mps, SyBookkeeper * bk );
 
       const int L;
 
@@ -67,6 +117,8 @@ namespace CheMPS2 {
 
       hid_t HDF5FILEID;
 
+      const int deflate;
+
       std::time_t start;
    };
 } // namespace CheMPS2
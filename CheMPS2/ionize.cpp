@@ -26,6 +26,9 @@
 #include <sys/stat.h>
 #include <assert.h>
 #include <sstream>
+#ifdef _OPENMP
+   #include <omp.h>
+#endif
 
 #include "Initialize.h"
 #include "COneDM.h"
@@ -37,123 +40,46 @@
 #include "EdmistonRuedenberg.h"
 #include "TimeEvolution.h"
 #include "CFCI.h"
+#include "CIonization.h"
+#include "CMPSio.h"
 #include "CTensorT.h"
 #include "CSobject.h"
 #include "Lapack.h"
-#include "HamiltonianOperator.h"
 
 #include "Irreps.h"
 
 using namespace std;
 
 
-void saveMPS(const std::string name, CheMPS2::CTensorT ** MPSlocation, CheMPS2::SyBookkeeper * BKlocation) {
- 
-   //The hdf5 file
-   hid_t file_id = H5Fcreate(name.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
-
-   //The current virtual dimensions
-   for( int bound = 0; bound <= BKlocation->gL(); bound++ ){
-      for( int N = BKlocation->gNmin( bound ); N <= BKlocation->gNmax( bound ); N++ ){
-         for( int TwoS = BKlocation->gTwoSmin( bound, N ); TwoS <= BKlocation->gTwoSmax( bound, N ); TwoS += 2 ){
-            for( int Irrep = 0; Irrep < BKlocation->getNumberOfIrreps(); Irrep++ ){
-   
-               std::stringstream sstream;
-               sstream << "/VirtDim_" << bound << "_" << N << "_" << TwoS << "_" << Irrep;
-               hid_t group_id2 = H5Gcreate( file_id, sstream.str().c_str(), H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT );
-               
-               hsize_t dimarray2     = 1; //One integer
-               hid_t dataspace_id2   = H5Screate_simple( 1, &dimarray2, NULL );
-               hid_t dataset_id2     = H5Dcreate( group_id2, "Value", H5T_STD_I32LE, dataspace_id2, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT );
-               int toWrite2 = BKlocation->gCurrentDim( bound, N, TwoS, Irrep );
-               H5Dwrite( dataset_id2, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, &toWrite2 );
-            
-               H5Dclose( dataset_id2 );
-               H5Sclose( dataspace_id2 );
-
-               H5Gclose( group_id2 );
-               
-            }
-         }
-      }
-   }
-      
-   //The MPS
-   for (int site = 0; site < BKlocation->gL(); site++ ){
-      
-      std::stringstream sstream;
-      sstream << "/MPS_" << site;
-      hid_t group_id3 = H5Gcreate( file_id, sstream.str().c_str(), H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT );
-      
-      hsize_t dimarray3     = 2 * MPSlocation[ site ]->gKappa2index( MPSlocation[ site ]->gNKappa() ); //An array of doubles
-      hid_t dataspace_id3   = H5Screate_simple( 1, &dimarray3, NULL );
-      hid_t dataset_id3     = H5Dcreate( group_id3, "Values", H5T_IEEE_F64LE, dataspace_id3, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT );
-      H5Dwrite( dataset_id3, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, MPSlocation[ site ]->gStorage() );
-   
-      H5Dclose( dataset_id3 );
-      H5Sclose( dataspace_id3 );
-
-      H5Gclose( group_id3 );
-      
-   }
-      
-   H5Fclose( file_id );
+int count_entries( const string rawdata ){
+
+   return std::count( rawdata.begin(), rawdata.end(), ',' ) + 1;
 
 }
 
-void loadDIM(const std::string name, CheMPS2::SyBookkeeper * BKlocation){
-
-   //The hdf5 file
-   hid_t file_id = H5Fopen(name.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
-      
-      //The current virtual dimensions
-      for (int bound=0; bound<=BKlocation->gL(); bound++){
-         for (int N=BKlocation->gNmin(bound); N<=BKlocation->gNmax(bound); N++){
-            for (int TwoS=BKlocation->gTwoSmin(bound,N); TwoS<=BKlocation->gTwoSmax(bound,N); TwoS+=2){
-               for (int Irrep=0; Irrep<BKlocation->getNumberOfIrreps(); Irrep++){
-     
-                  std::stringstream sstream;
-                  sstream << "/VirtDim_" << bound << "_" << N << "_" << TwoS << "_" << Irrep;
-                  hid_t group_id2 = H5Gopen(file_id, sstream.str().c_str(), H5P_DEFAULT);
-                  
-                     hid_t dataset_id2 = H5Dopen(group_id2, "Value", H5P_DEFAULT);
-                     int toRead;
-                     H5Dread(dataset_id2, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, &toRead);
-                     BKlocation->SetDim(bound, N, TwoS, Irrep, toRead);
-                     H5Dclose(dataset_id2);
-                  
-                  H5Gclose(group_id2);
-                  
-               }
-            }
-         }
-      }
-      
-   H5Fclose(file_id);
+void fetch_ints( const string rawdata, int * result, const int num ){
+
+   int pos  = 0;
+   int pos2 = 0;
+   for ( int no = 0; no < num; no++ ){
+      pos2 = rawdata.find( ",", pos );
+      if ( pos2 == string::npos ){ pos2 = rawdata.length(); }
+      result[ no ] = atoi( rawdata.substr( pos, pos2-pos ).c_str() );
+      pos = pos2 + 1;
+   }
 
 }
 
-void loadMPS( const std::string name, const int L, CheMPS2::CTensorT ** MPSlocation ){
-
-   //The hdf5 file
-   hid_t file_id = H5Fopen( name.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT );
-      
-   //The MPS
-   for (int site = 0; site < L; site++){
-      
-      std::stringstream sstream;
-      sstream << "/MPS_" << site;
-      hid_t group_id3 = H5Gopen( file_id, sstream.str().c_str(), H5P_DEFAULT );
-      
-      hid_t dataset_id3     = H5Dopen( group_id3, "Values", H5P_DEFAULT );
-      H5Dread( dataset_id3, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, MPSlocation[ site ]->gStorage() );
-      H5Dclose( dataset_id3 );
-
-      H5Gclose( group_id3 );
-      
+void fetch_doubles( const string rawdata, double * result, const int num ){
+
+   int pos  = 0;
+   int pos2 = 0;
+   for ( int no = 0; no < num; no++ ){
+      pos2 = rawdata.find( ",", pos );
+      if ( pos2 == string::npos ){ pos2 = rawdata.length(); }
+      result[ no ] = atof( rawdata.substr( pos, pos2-pos ).c_str() );
+      pos = pos2 + 1;
    }
-      
-   H5Fclose( file_id );
 
 }
 
@@ -175,87 +101,33 @@ bool file_exists( const string filename, const string tag ){
 
 }
 
-void applyAnnihilator( const int pos, CheMPS2::CTensorT** mpsIn, CheMPS2::SyBookkeeper* bkIn, CheMPS2::CTensorT** mpsOut, CheMPS2::SyBookkeeper *bkOut, CheMPS2::Problem *probOut ){
-
-   const int L = bkIn->gL();
-   assert( pos < L );
-   assert( ( L + 1 ) == bkOut->gL() );
-
-   CheMPS2::Problem * probTemp = new CheMPS2::Problem( probOut->gHamil(), probOut->gTwoS(), probOut->gN(), probOut->gIrrep() );
-   probTemp->construct_mxelem();
-
-   CheMPS2::SyBookkeeper* bkTemp = new CheMPS2::SyBookkeeper( probTemp, 1 );
-  
-   for( int site = 0; site < L; site++ ){
-      bkTemp->allToZeroAtLink( site );
-      bkTemp->allToZeroAtLink( site + 1 );
-      for ( int NL = bkIn->gNmin( site ); NL <= bkIn->gNmax( site ); NL++ ) {
-         for ( int TwoSL = bkIn->gTwoSmin( site, NL ); TwoSL <= bkIn->gTwoSmax( site, NL ); TwoSL += 2 ) {
-            for ( int IL = 0; IL < bkIn->getNumberOfIrreps(); IL++ ) {
-               const int dimL = bkIn->gCurrentDim( site, NL, TwoSL, IL );
-               bkTemp->SetDim( site, NL, TwoSL, IL, dimL );
-               if ( dimL > 0 ) {
-                  for ( int NR = NL; NR <= NL + 2; NR++ ) {
-                     const int TwoJ = ( ( NR == NL + 1 ) ? 1 : 0 );
-                     for ( int TwoSR = TwoSL - TwoJ; TwoSR <= TwoSL + TwoJ; TwoSR += 2 ) {
-                        if ( TwoSR >= 0 ) {
-                           int IR         = ( ( NR == NL + 1 ) ? CheMPS2::Irreps::directProd( IL, bkIn->gIrrep( site ) ) : IL );
-                           const int dimR = bkIn->gCurrentDim( site + 1, NR, TwoSR, IR );
-                           bkTemp->SetDim( site + 1, NR, TwoSR, IR, dimR );
-                        }
-                     }
-                  }
+// The FCIDUMP of the ionized problem: the integrals of ham, with a decoupled continuum orbital
+void writeIonizedFCIDUMP( const string filename, CheMPS2::Hamiltonian * ham, CheMPS2::Hamiltonian * hamION, const int nelec, const int two_s, const int irrep ){
+
+   const int L = ham->getL();
+
+   for( int i = 0; i < L; i++ ){
+      if ( hamION->getOrbitalIrrep( i ) == hamION->getOrbitalIrrep( L ) ){ hamION->setTmat( i, L, 0.0 ); }
+   }
+   for( int i = 0; i < L; i++ ){
+      for( int j = 0; j < L; j++ ){
+         if( std::abs( ham->getTmat( i, j ) ) > 0 ){
+            hamION->setTmat( i, j, ham->getTmat( i, j ) );
+         }
+         for( int k = 0; k < L; k++ ){
+            for( int l = 0; l < L; l++ ){
+               if( std::abs( ham->getVmat( i, j, k, l ) ) > 0 ){
+                  hamION->setVmat( i, j, k, l, ham->getVmat( i, j, k, l ) );
                }
             }
          }
       }
    }
-
-   CheMPS2::CTensorT ** mpsTemp = new CheMPS2::CTensorT *[ bkTemp->gL() ];
-   for ( int index = 0; index < L + 1; index++ ) {
-      mpsTemp[ index ] = new CheMPS2::CTensorT( index, bkTemp );
-   }
-
-  for( int site = 0; site < L; site++ ){
-      for( int ikappa = 0; ikappa < mpsIn[ site ]->gNKappa(); ikappa++ ){
-         const int NL    = mpsIn[ site ]->gNL( ikappa );
-         const int TwoSL = mpsIn[ site ]->gTwoSL( ikappa );
-         const int IL    = mpsIn[ site ]->gIL( ikappa );
-
-         const int NR    = mpsIn[ site ]->gNR( ikappa );
-         const int TwoSR = mpsIn[ site ]->gTwoSR( ikappa );
-         const int IR    = mpsIn[ site ]->gIR( ikappa );
-
-         int dimL = bkIn->gCurrentDim( site,     NL, TwoSL, IL );
-         int dimR = bkIn->gCurrentDim( site + 1, NR, TwoSR, IR );
-
-         int dimLxdimR = dimL * dimR;
-         int inc = 1;
-         zcopy_( &dimLxdimR, mpsIn[ site ]->gStorage( NL, TwoSL, IL, NR, TwoSR, IR ), &inc, mpsTemp[ site ]->gStorage( NL, TwoSL, IL, NR, TwoSR, IR ), &inc );
-      }
-   }
-   assert( mpsTemp[ L ]->gNKappa() == 1 );
-   mpsTemp[ L ]->gStorage( )[ 0 ] = 1.0;
-
-   CheMPS2::ConvergenceScheme * opt_scheme = new CheMPS2::ConvergenceScheme( 1 );
-   opt_scheme->set_instruction( 0, 500, 0.0, 5, 0.0 );
-
-   CheMPS2::HamiltonianOperator * op = new CheMPS2::HamiltonianOperator( probOut, 0.0 );
-   op->DSApply( mpsTemp, bkTemp, mpsOut, bkOut, opt_scheme );
-
-   delete op;
-   delete opt_scheme;
-
-   for ( int site = 0; site < L + 1; site++ ) {
-      delete mpsTemp[ site ];
-   }
-   delete[] mpsTemp;
-   delete bkTemp;
-   delete probTemp;
+   hamION->setEconst( ham->getEconst() );
+   hamION->writeFCIDUMP( filename, nelec, two_s, irrep );
 
 }
 
-
 void print_help(){
 
 cout << "\n"
@@ -295,8 +167,20 @@ cout << "\n"
 "       -f, --group=int\n"
 "              Specify the symmetry type of the MPS.\n"
 "\n"
-"       -f, --position=int\n"
-"              Specify the orbital from which an electron is excited.\n"
+"       -p, --position=int,int,...\n"
+"              Specify the orbital from which an electron is excited. For a comma-separated list of orbitals, the ionized\n"
+"              states are constructed concurrently and stored to CheMPS2_CMPS_ION_<orbital>.h5 and CheMPS2_FCI_ION_<orbital>.fcidump.\n"
+"\n"
+"       -c, --coefficients=flt,flt,...\n"
+"              Instead of one state per orbital, excite with the linear combination of annihilators with these coefficients,\n"
+"              one per orbital in --position. The orbitals should have the same irrep.\n"
+"\n"
+"       -d, --dimension=int\n"
+"              The ionized states are constructed exactly. Optionally recompress them with SVDs to at most this virtual\n"
+"              dimension (default: no recompression).\n"
+"\n"
+"       -z, --deflate=int\n"
+"              Compress the stored MPS with this gzip level [0-9] (default 0: uncompressed).\n"
 "\n"
 "       -v, --version\n"
 "              Print the version of chemps2.\n"
@@ -318,8 +202,11 @@ int main( int argc, char ** argv ){
    string    outputfile = "CheMPS2_CMPS_ION.h5";
    string fcioutputfile = "CheMPS2_FCI_ION.fcidump";
 
-   int group    = -1;
-   int position = -1;
+   int group          = -1;
+   string positions   = "";
+   string coefficients = "";
+   int dimension       = 0;
+   int deflate         = 0;
 
    /*******************************
    *  Process the call parameter  *
@@ -331,6 +218,9 @@ int main( int argc, char ** argv ){
       {"fci",      required_argument, 0, 'f'},
       {"group",    required_argument, 0, 'g'},
       {"position", required_argument, 0, 'p'},
+      {"coefficients", required_argument, 0, 'c'},
+      {"dimension", required_argument, 0, 'd'},
+      {"deflate",  required_argument, 0, 'z'},
       {"version",  no_argument,       0, 'v'},
       {"help",     no_argument,       0, 'h'},
       {0, 0, 0, 0}
@@ -338,7 +228,7 @@ int main( int argc, char ** argv ){
 
    int option_index = 0;
    int c;
-   while (( c = getopt_long( argc, argv, "ifogpvh:", long_options, &option_index )) != -1 ){
+   while (( c = getopt_long( argc, argv, "i:f:g:p:c:d:z:vh", long_options, &option_index )) != -1 ){
       switch( c ){
          case 'h':
          case '?':
@@ -361,7 +251,20 @@ int main( int argc, char ** argv ){
             group = atoi( optarg );
             break;
          case 'p':
-            position = atoi( optarg );
+            positions = optarg;
+            break;
+         case 'c':
+            coefficients = optarg;
+            break;
+         case 'd':
+            dimension = atoi( optarg );
+            break;
+         case 'z':
+            deflate = atoi( optarg );
+            if ( ( deflate < 0 ) || ( deflate > 9 ) ){
+               cerr << "Invalid option for --deflate!" << endl;
+               return -1;
+            }
             break;
 
       }
@@ -424,82 +327,117 @@ int main( int argc, char ** argv ){
    ***************************/
 
    CheMPS2::SyBookkeeper * bkIn  = new CheMPS2::SyBookkeeper( prob, 1 );
-   loadDIM( inputfile, bkIn );
+   CheMPS2::loadDIM( inputfile, bkIn );
 
    CheMPS2::CTensorT ** mpsIn    = new CheMPS2::CTensorT *[ fcidump_norb ];
    for ( int index = 0; index < fcidump_norb; index++ ) {
       mpsIn[ index ] = new CheMPS2::CTensorT( index, bkIn );
    }
-   loadMPS( inputfile, fcidump_norb, mpsIn );
-
-   /******************************
-   *  Prepare the ionized state  *
-   ******************************/
-
-   vector<int> irrepsparsed;
-   for( int i = 0; i < fcidump_norb; i++ ) { irrepsparsed.push_back( ham->getOrbitalIrrep( i ) ); }
-   irrepsparsed.push_back( irrepsparsed[ position ] );
+   CheMPS2::loadMPS( inputfile, fcidump_norb, mpsIn );
 
-   CheMPS2::Hamiltonian* hamION = new CheMPS2::Hamiltonian( fcidump_norb + 1, group, &irrepsparsed[ 0 ] );
-   hamION->setTmat( position, fcidump_norb, 1.0 );
-   CheMPS2::Problem probION( hamION, fcidump_two_s, fcidump_nelec, CheMPS2::Irreps::directProd( fcidump_irrep, irrepsparsed[ position ] ) );
-   probION.construct_mxelem();
+   /*******************************
+   *  Prepare the ionized states  *
+   *******************************/
 
-   int* nmax = new int [ fcidump_norb + 1 ];
-   int* nmin = new int [ fcidump_norb + 1 ];
-   
-   for(int i = 0; i < fcidump_norb; i++)
-   {
-      nmax[ i ] = 2;
-      nmin[ i ] = 0;
+   if ( positions.length() == 0 ){
+      cerr << "The orbital(s) from which an electron is excited should be specified with --position!" << endl;
+      return -1;
+   }
+   const int numPositions = count_entries( positions );
+   int * positionsParsed  = new int[ numPositions ];
+   fetch_ints( positions, positionsParsed, numPositions );
+   for ( int k = 0; k < numPositions; k++ ){
+      if (( positionsParsed[ k ] < 0 ) || ( positionsParsed[ k ] >= fcidump_norb )){
+         cerr << "The positions should be within 0 and L - 1 !" << endl;
+         return -1;
+      }
    }
-   nmax[ fcidump_norb ] = 1;
-   nmin[ fcidump_norb ] = 1;
-
-   probION.setup_occu_max( nmax );
-   probION.setup_occu_min( nmin );
-
-   delete[] nmax;
-   delete[] nmin;
-
-   CheMPS2::SyBookkeeper * bkOut  = new CheMPS2::SyBookkeeper( &probION, 100 );
-   CheMPS2::CTensorT    ** mpsOut = new CheMPS2::CTensorT *[ fcidump_norb + 1 ];
 
-   for ( int index = 0; index < fcidump_norb + 1; index++ ) {
-      mpsOut[ index ] = new CheMPS2::CTensorT( index, bkOut );
-      mpsOut[ index ]->random();
+   double * coefsParsed = new double[ numPositions ];
+   for ( int k = 0; k < numPositions; k++ ){ coefsParsed[ k ] = 1.0; }
+   const bool combination = ( coefficients.length() > 0 );
+   if ( combination ){
+      if ( count_entries( coefficients ) != numPositions ){
+         cerr << "The number of coefficients should be equal to the number of positions!" << endl;
+         return -1;
+      }
+      fetch_doubles( coefficients, coefsParsed, numPositions );
+      bool nonzero = false;
+      for ( int k = 0; k < numPositions; k++ ){ nonzero = nonzero || ( coefsParsed[ k ] != 0.0 ); }
+      if ( nonzero == false ){
+         cerr << "At least one of the coefficients should differ from zero!" << endl;
+         return -1;
+      }
+      for ( int k = 1; k < numPositions; k++ ){
+         if ( ham->getOrbitalIrrep( positionsParsed[ k ] ) != ham->getOrbitalIrrep( positionsParsed[ 0 ] ) ){
+            cerr << "All positions of a linear combination should have the same irrep!" << endl;
+            return -1;
+         }
+      }
    }
 
-   /*************************
-   *  Apply the Excitation  *
-   *************************/
+   // Either one state for the linear combination, or one state per position
+   const int numTargets = ( combination ) ? 1 : numPositions;
+   CheMPS2::Hamiltonian  ** hamIONs  = new CheMPS2::Hamiltonian *[ numTargets ];
+   CheMPS2::Problem      ** probIONs = new CheMPS2::Problem *[ numTargets ];
+   CheMPS2::SyBookkeeper ** bkOuts   = new CheMPS2::SyBookkeeper *[ numTargets ];
+   CheMPS2::CTensorT   *** mpsOuts   = new CheMPS2::CTensorT **[ numTargets ];
+
+   for ( int target = 0; target < numTargets; target++ ){
+      const int numTargetPositions = ( combination ) ? numPositions : 1;
+      hamIONs[ target ]  = CheMPS2::ionizationHamiltonian( ham, group, numTargetPositions, positionsParsed + target, coefsParsed + target );
+      probIONs[ target ] = CheMPS2::ionizationProblem( hamIONs[ target ], fcidump_two_s, fcidump_nelec, fcidump_irrep );
+      bkOuts[ target ]   = new CheMPS2::SyBookkeeper( probIONs[ target ], 1 );
+      mpsOuts[ target ]  = new CheMPS2::CTensorT *[ fcidump_norb + 1 ];
+      for ( int index = 0; index < fcidump_norb + 1; index++ ) {
+         mpsOuts[ target ][ index ] = new CheMPS2::CTensorT( index, bkOuts[ target ] );
+      }
+   }
 
-   applyAnnihilator( position, mpsIn, bkIn, mpsOut, bkOut, &probION );
+   /****************************************************************************************
+   *  Apply the Excitations: concurrent constructions which share the read-only mpsIn  *
+   ****************************************************************************************/
+
+#ifdef _OPENMP
+   const int numThreads = omp_get_max_threads();
+   const int maxLevels  = omp_get_max_active_levels();
+   omp_set_max_active_levels( std::max( maxLevels, 2 ) );
+#else
+   const int numThreads = 1;
+#endif
+   const int numConcurrent = std::max( 1, std::min( numTargets, numThreads ) );
+
+#pragma omp parallel for schedule( dynamic ) num_threads( numConcurrent )
+   for ( int target = 0; target < numTargets; target++ ){
+#ifdef _OPENMP
+      omp_set_num_threads( std::max( 1, numThreads / numConcurrent ) );
+#endif
+      CheMPS2::applyAnnihilator( mpsIn, bkIn, mpsOuts[ target ], bkOuts[ target ], probIONs[ target ], dimension );
+   }
 
-   /*************************************
-   *  Save the MPS and the new FCIDUMP  *
-   *************************************/
+#ifdef _OPENMP
+   omp_set_max_active_levels( maxLevels );
+#endif
+
+   /****************************************
+   *  Save the MPSs and the new FCIDUMPs  *
+   ****************************************/
+
+   for ( int target = 0; target < numTargets; target++ ){
+      string outputfile    = "CheMPS2_CMPS_ION.h5";
+      string fcioutputfile = "CheMPS2_FCI_ION.fcidump";
+      if ( numTargets > 1 ){
+         std::stringstream suffix;
+         suffix << "_" << positionsParsed[ target ];
+         outputfile    = "CheMPS2_CMPS_ION" + suffix.str() + ".h5";
+         fcioutputfile = "CheMPS2_FCI_ION" + suffix.str() + ".fcidump";
+      }
 
-   saveMPS( outputfile, mpsOut, bkOut );
-   cout << "The ionized state has been successfully stored to " << outputfile << " .\n";
+      CheMPS2::saveMPS( outputfile, mpsOuts[ target ], bkOuts[ target ], deflate );
+      cout << "The ionized state has been successfully stored to " << outputfile << " .\n";
 
-   hamION->setTmat( position, fcidump_norb, 0.0 );
-   for( int i = 0; i < fcidump_norb; i++ ){
-      for( int j = 0; j < fcidump_norb; j++ ){
-         if( std::abs( ham->getTmat( i, j ) ) > 0 ){
-            hamION->setTmat( i, j, ham->getTmat( i, j ) );
-         }
-         for( int k = 0; k < fcidump_norb; k++ ){
-            for( int l = 0; l < fcidump_norb; l++ ){
-               if( std::abs( ham->getVmat( i, j, k, l ) ) > 0 ){
-                  hamION->setVmat( i, j, k, l, ham->getVmat( i, j, k, l ) );
-               }
-            }
-         }
-      }
+      writeIonizedFCIDUMP( fcioutputfile, ham, hamIONs[ target ], fcidump_nelec, fcidump_two_s, fcidump_irrep );
    }
-   hamION->setEconst( ham->getEconst() );
-   hamION->writeFCIDUMP( fcioutputfile, fcidump_nelec, fcidump_two_s, CheMPS2::Irreps::directProd( fcidump_irrep, irrepsparsed[ position ] ) );
 
    /*******************************
    *  Delete the allocated stuff  *
@@ -508,15 +446,25 @@ int main( int argc, char ** argv ){
    for ( int site = 0; site < fcidump_norb; site++ ) {
       delete mpsIn[ site ];
    }
-   for ( int site = 0; site < fcidump_norb + 1; site++ ) {
-      delete mpsOut[ site ];
-   }
    delete[] mpsIn;
-   delete[] mpsOut;
    delete bkIn;
-   delete bkOut;
 
-   delete hamION;
+   for ( int target = 0; target < numTargets; target++ ){
+      for ( int site = 0; site < fcidump_norb + 1; site++ ) {
+         delete mpsOuts[ target ][ site ];
+      }
+      delete[] mpsOuts[ target ];
+      delete bkOuts[ target ];
+      delete probIONs[ target ];
+      delete hamIONs[ target ];
+   }
+   delete[] mpsOuts;
+   delete[] bkOuts;
+   delete[] probIONs;
+   delete[] hamIONs;
+   delete[] positionsParsed;
+   delete[] coefsParsed;
+
    delete ham;
    delete prob;
 